@@ -0,0 +1,15 @@
+# cmake -DINPUT=<file.spv> -DOUTPUT=<file.h> -DSYMBOL=<name> -P embed_spirv.cmake
+# يحوّل SPIR-V إلى مصفوفة constexpr من كلمات 32 بت (little-endian كما تكتبها glslc)
+file(READ "${INPUT}" SPIRV_HEX HEX)
+string(LENGTH "${SPIRV_HEX}" SPIRV_HEX_LENGTH)
+math(EXPR SPIRV_REMAINDER "${SPIRV_HEX_LENGTH} % 8")
+if (SPIRV_HEX_LENGTH EQUAL 0 OR NOT SPIRV_REMAINDER EQUAL 0)
+    message(FATAL_ERROR "Invalid SPIR-V size in ${INPUT}")
+endif ()
+string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1," SPIRV_WORDS "${SPIRV_HEX}")
+# ثمانية كلمات في كل سطر (تعابير CMake لا تدعم {n}، و string(REPEAT) يحتاج 3.15)
+set(SPIRV_WORD "0x[0-9a-f]+,")
+set(SPIRV_LINE "${SPIRV_WORD}${SPIRV_WORD}${SPIRV_WORD}${SPIRV_WORD}${SPIRV_WORD}${SPIRV_WORD}${SPIRV_WORD}${SPIRV_WORD}")
+string(REGEX REPLACE "(${SPIRV_LINE})" "\\1\n    " SPIRV_WORDS "${SPIRV_WORDS}")
+get_filename_component(SPIRV_NAME "${INPUT}" NAME)
+file(WRITE "${OUTPUT}" "// Generated from ${SPIRV_NAME}\n#pragma once\n\n#include <cstdint>\n\ninline constexpr uint32_t ${SYMBOL}[] = {\n    ${SPIRV_WORDS}\n};\n")
@@ -0,0 +1,18 @@
+// الكومة العامة للموارد؛ يجب أن تطابق BindlessBinding في src/bindless.h
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 0, binding = 0) uniform texture2D bindlessTextures[];
+layout(set = 0, binding = 1) uniform sampler bindlessSamplers[];
+
+#define BINDLESS_SAMPLER_LINEAR 0
+#define BINDLESS_SAMPLER_NEAREST 1
+#define BINDLESS_DEFAULT_TEXTURE 0
+
+vec4 sampleBindless(uint textureIndex, uint samplerIndex, vec2 uv) {
+    return texture(sampler2D(bindlessTextures[nonuniformEXT(textureIndex)],
+                             bindlessSamplers[nonuniformEXT(samplerIndex)]), uv);
+}
+
+// مخازن التخزين تُعلن لكل نوع بيانات لأن GLSL لا يسمح بمصفوفة واحدة بأنواع مختلفة
+#define BINDLESS_STORAGE_BUFFER(Type, name) \
+    layout(std430, set = 0, binding = 2) readonly buffer Bindless##name { Type items[]; } name[]
@@ -0,0 +1,17 @@
+// يجب أن يطابق BloomConstants في src/post.cpp
+layout(push_constant) uniform BloomConstants {
+    vec2 sourceUvScale;     // الجزء المرسوم من المشهد مع الدقة الديناميكية؛ 1 لمستويات الـ bloom
+    vec2 sourceUvMax;       // نصف texel قبل حافته
+    vec2 sourceTexel;
+    ivec2 targetSize;
+    float threshold;
+    float knee;
+    uint prefilter;         // أول تصغير فقط: العتبة ومتوسط Karis مدمجان فيه
+    float reserved;
+} pc;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+
+vec3 sampleSource(vec2 uv, vec2 offset) {
+    return textureLod(source, min(uv + offset * pc.sourceTexel, pc.sourceUvMax), 0.0).rgb;
+}
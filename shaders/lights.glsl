@@ -0,0 +1,38 @@
+// يجب أن يطابق Light و LIGHT_CLUSTERS_* في src/lights.h، و LightsView يطابق LightsViewUniforms في src/lights.cpp.
+// LIGHTS_SET يُعرّف قبل التضمين: 1 في scene.frag و 0 في light_cluster.comp
+const uint LIGHT_CLUSTERS_X = 16;
+const uint LIGHT_CLUSTERS_Y = 9;
+const uint LIGHT_CLUSTERS_Z = 24;
+
+const uint LIGHT_POINT = 0;
+const uint LIGHT_SPOT = 1;
+
+struct Light {
+    vec3 position;
+    float range;
+    vec3 color;
+    uint type;
+    vec3 direction;
+    float cosOuter;
+    float cosInner;
+    uint reserved0;
+    uint reserved1;
+    uint reserved2;
+};
+
+layout(std140, set = LIGHTS_SET, binding = 4) uniform LightsView {
+    mat4 view;
+    vec4 projection;        // P00، P11 موجب، near
+    vec4 grid;              // froxels لكل بكسل في x و y، ومقياس وإزاحة الشريحة على log(العمق)
+    uvec4 counts;           // عدد الأضواء، سعة مخزن الفهارس
+} lightsView;
+
+// العمق الموجب أمام الكاميرا؛ الشرائح أُسّية فحجمها يتناسب مع بعدها
+uint lightSlice(float viewDepth) {
+    float slice = log(max(viewDepth, lightsView.projection.z)) * lightsView.grid.z + lightsView.grid.w;
+    return min(uint(max(slice, 0.0)), LIGHT_CLUSTERS_Z - 1);
+}
+
+uint lightClusterIndex(uvec3 cluster) {
+    return cluster.x + LIGHT_CLUSTERS_X * (cluster.y + LIGHT_CLUSTERS_Y * cluster.z);
+}
@@ -0,0 +1,50 @@
+#version 450
+#define LIGHTS_SET 1
+#include "lights.glsl"
+
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec3 inWorld;
+
+layout(location = 0) out vec4 outColor;
+
+layout(std430, set = 1, binding = 0) readonly buffer Lights {
+    Light lights[];
+};
+
+layout(std430, set = 1, binding = 1) readonly buffer LightClusters {
+    uvec2 clusters[];
+};
+
+layout(std430, set = 1, binding = 2) readonly buffer LightIndices {
+    uint indices[];
+};
+
+vec3 shadeLight(Light light, vec3 normal) {
+    vec3 toLight = light.position - inWorld;
+    float distanceSquared = dot(toLight, toLight);
+    vec3 direction = toLight * inversesqrt(max(distanceSquared, 1e-8));
+    // تنعدم عند range تماماً، فلا يظهر حد الكرة التي صُنّف بها الضوء
+    float falloff = clamp(1.0 - distanceSquared / (light.range * light.range), 0.0, 1.0);
+    float attenuation = falloff * falloff / (1.0 + distanceSquared);
+    if (light.type == LIGHT_SPOT) {
+        attenuation *= smoothstep(light.cosOuter, light.cosInner, dot(-direction, light.direction));
+    }
+    return light.color * attenuation * max(dot(normal, direction), 0.0);
+}
+
+void main() {
+    const vec3 lightDirection = normalize(vec3(0.4, 1.0, 0.3));
+    vec3 normal = normalize(inNormal);
+    float diffuse = max(dot(normal, lightDirection), 0.0);
+    vec3 lighting = vec3(0.25 + 0.75 * diffuse);
+
+    // العمق معكوس بلا مستوى بعيد: z = near / العمق
+    float viewDepth = lightsView.projection.z / max(gl_FragCoord.z, 1e-7);
+    uvec2 tile = min(uvec2(gl_FragCoord.xy * lightsView.grid.xy), uvec2(LIGHT_CLUSTERS_X - 1, LIGHT_CLUSTERS_Y - 1));
+    uvec2 cluster = clusters[lightClusterIndex(uvec3(tile, lightSlice(viewDepth)))];
+    for (uint i = 0; i < cluster.y; i++) {
+        lighting += shadeLight(lights[indices[cluster.x + i]], normal);
+    }
+    outColor = vec4(inColor.rgb * lighting, inColor.a);
+}
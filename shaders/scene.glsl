@@ -0,0 +1,38 @@
+// يجب أن يطابق SceneMeshGpu و SceneInstance في src/scene.h، و SceneView يطابق SceneViewUniforms في src/scene.cpp
+struct SceneMesh {
+    uint firstIndex;
+    uint indexCount;
+    int vertexOffset;
+    float boundsRadius;
+    vec4 positionOffset;
+    vec4 positionScale;
+    vec4 boundsCenter;
+};
+
+struct SceneInstance {
+    vec4 rows[3];       // تحويل 3x4 بالصفوف
+    uint mesh;
+    uint color;
+    uint reserved0;
+    uint reserved1;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer SceneInstances {
+    SceneInstance instances[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer SceneMeshes {
+    SceneMesh meshes[];
+};
+
+layout(std140, set = 0, binding = 7) uniform SceneView {
+    mat4 view;
+    mat4 viewProjection;
+    vec4 planes[5];     // الداخل موجب؛ لا مستوى بعيد مع العمق المعكوس
+    vec4 projection;    // P00، P11 موجب، near
+    vec4 pyramid;       // العرض، الارتفاع، عدد المستويات
+} sceneView;
+
+vec3 sceneTransform(SceneInstance instance, vec4 position) {
+    return vec3(dot(instance.rows[0], position), dot(instance.rows[1], position), dot(instance.rows[2], position));
+}
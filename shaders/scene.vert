@@ -0,0 +1,26 @@
+#version 450
+#include "scene.glsl"
+
+// CookedVertex: موضع unorm16، عمودي snorm8، UV بنصف دقة؛ تُقرأ من المخزن المشترك بدل vertex buffer
+layout(std430, set = 0, binding = 2) readonly buffer SceneVertices {
+    uvec4 vertices[];
+};
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec4 outColor;
+layout(location = 2) out vec3 outWorld;
+
+void main() {
+    SceneInstance instance = instances[gl_InstanceIndex];
+    SceneMesh mesh = meshes[instance.mesh];
+    // gl_VertexIndex يتضمن vertexOffset من أمر الرسم
+    uvec4 packed = vertices[gl_VertexIndex];
+    vec3 unorm = vec3(unpackUnorm2x16(packed.x), unpackUnorm2x16(packed.y).x);
+    vec3 local = mesh.positionOffset.xyz + mesh.positionScale.xyz * unorm;
+    vec3 world = sceneTransform(instance, vec4(local, 1.0));
+
+    gl_Position = sceneView.viewProjection * vec4(world, 1.0);
+    outNormal = sceneTransform(instance, vec4(unpackSnorm4x8(packed.z).xyz, 0.0));
+    outColor = unpackUnorm4x8(instance.color);
+    outWorld = world;
+}
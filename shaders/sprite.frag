@@ -0,0 +1,15 @@
+#version 450
+#include "sprite_features.glsl"
+
+// مسار بدون bindless: مجموعة واصفات لكل دفعة بنفس النسيج
+layout(set = 0, binding = 0) uniform sampler2D spriteTexture;
+
+layout(location = 0) in vec2 inUv;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) flat in uint inTexture;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = applySpriteFeatures(texture(spriteTexture, inUv) * inColor);
+}
@@ -0,0 +1,32 @@
+#version 450
+
+// كل تيار SoA مربوط كـ vertex buffer منفصل بمعدل instance
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inSize;
+layout(location = 2) in float inRotation;
+layout(location = 3) in vec4 inUvRect;
+layout(location = 4) in vec4 inColor;
+layout(location = 5) in uint inTexture;
+
+layout(push_constant) uniform SpritePushConstants {
+    vec2 viewScale;     // 2 / حجم الشاشة بالبكسل
+    vec2 viewOrigin;    // موضع الكاميرا
+} pc;
+
+layout(location = 0) out vec2 outUv;
+layout(location = 1) out vec4 outColor;
+layout(location = 2) flat out uint outTexture;
+
+void main() {
+    // مربع من 4 رؤوس كشريط مثلثات، بدون vertex buffer للرؤوس
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+    vec2 local = (corner - 0.5) * inSize;
+    float s = sin(inRotation);
+    float c = cos(inRotation);
+    vec2 world = inPosition + vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+    gl_Position = vec4((world - pc.viewOrigin) * pc.viewScale - 1.0, 0.0, 1.0);
+    outUv = mix(inUvRect.xy, inUvRect.zw, corner);
+    outColor = inColor;
+    outTexture = inTexture;
+}
@@ -0,0 +1,13 @@
+#version 450
+#include "bindless.glsl"
+#include "sprite_features.glsl"
+
+layout(location = 0) in vec2 inUv;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) flat in uint inTexture;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = applySpriteFeatures(sampleBindless(inTexture, BINDLESS_SAMPLER_LINEAR, inUv) * inColor);
+}
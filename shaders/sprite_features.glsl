@@ -0,0 +1,14 @@
+// ثوابت التخصيص لمتغيرات الـ sprite: كل constant_id يطابق قيمة في SpriteFeature (sprite.h)،
+// والفروع عليها تُحذف عند بناء الـ pipeline فلا تفرّع في وقت التشغيل
+layout(constant_id = 0) const bool SPRITE_ALPHA_TEST = false;
+layout(constant_id = 1) const bool SPRITE_GRAYSCALE = false;
+
+vec4 applySpriteFeatures(vec4 color) {
+    if (SPRITE_ALPHA_TEST && color.a < 0.5) {
+        discard;
+    }
+    if (SPRITE_GRAYSCALE) {
+        color.rgb = vec3(dot(color.rgb, vec3(0.2126, 0.7152, 0.0722)));
+    }
+    return color;
+}
@@ -0,0 +1,16 @@
+#version 450
+
+layout(location = 0) in vec2 inUv;
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D sceneColor;
+
+layout(push_constant) uniform UpscaleConstants {
+    vec2 uvScale;       // الجزء المرسوم من الصورة
+    vec2 uvMax;         // نصف texel قبل حافته، فلا يخلط الترشيح ما بعدها من إطارات سابقة
+} pc;
+
+void main() {
+    outColor = texture(sceneColor, min(inUv * pc.uvScale, pc.uvMax));
+}
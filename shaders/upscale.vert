@@ -0,0 +1,10 @@
+#version 450
+
+layout(location = 0) out vec2 outUv;
+
+// مثلث واحد يغطي الشاشة بلا vertex buffer
+void main() {
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+    outUv = uv;
+}
@@ -0,0 +1,185 @@
+#include "archive.h"
+#include "jobs.h"
+#include "lz4.h"
+#include "state.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+bool openArchive(Archive *archive, const char *path) {
+    *archive = {};
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Failed to open archive " << path << std::endl;
+        return false;
+    }
+    struct stat info{};
+    if (fstat(file, &info) != 0 || (size_t) info.st_size < sizeof(ArchiveHeader)) {
+        std::cerr << "Invalid archive " << path << std::endl;
+        close(file);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map archive " << path << std::endl;
+        close(file);
+        return false;
+    }
+    archive->file = file;
+    archive->data = static_cast<const uint8_t *>(mapping);
+    archive->size = (size_t) info.st_size;
+    archive->header = reinterpret_cast<const ArchiveHeader *>(archive->data);
+
+    // التحقق من الحدود فقط؛ الجداول تُستخدم كما هي من الذاكرة المعيّنة
+    const ArchiveHeader &header = *archive->header;
+    bool valid = memcmp(header.magic, ARCHIVE_MAGIC, 4) == 0 && header.version == ARCHIVE_VERSION &&
+                 header.entriesOffset + (uint64_t) header.entryCount * sizeof(ArchiveEntry) <= archive->size &&
+                 header.blocksOffset + (uint64_t) header.blockCount * sizeof(ArchiveBlock) <= archive->size;
+    if (!valid) {
+        std::cerr << "Invalid archive header in " << path << std::endl;
+        closeArchive(archive);
+        return false;
+    }
+    archive->entries = reinterpret_cast<const ArchiveEntry *>(archive->data + header.entriesOffset);
+    archive->blocks = reinterpret_cast<const ArchiveBlock *>(archive->data + header.blocksOffset);
+    std::cout << "Archive " << path << ": " << header.entryCount << " entries, " << header.blockCount
+              << " blocks, " << archive->size / 1024 << " KB" << std::endl;
+    return true;
+}
+
+void closeArchive(Archive *archive) {
+    if (archive->data) {
+        munmap(const_cast<uint8_t *>(archive->data), archive->size);
+    }
+    if (archive->file >= 0) {
+        close(archive->file);
+    }
+    *archive = {};
+}
+
+const ArchiveEntry *archiveFind(const Archive &archive, uint64_t id) {
+    const ArchiveEntry *begin = archive.entries;
+    const ArchiveEntry *end = archive.entries + archive.header->entryCount;
+    const ArchiveEntry *entry = std::lower_bound(begin, end, id, [](const ArchiveEntry &entry, uint64_t id) {
+        return entry.id < id;
+    });
+    return entry != end && entry->id == id ? entry : nullptr;
+}
+
+const void *archiveView(const Archive &archive, const ArchiveEntry &entry) {
+    if (entry.flags & ARCHIVE_ENTRY_COMPRESSED || entry.offset + entry.size > archive.size) {
+        return nullptr;
+    }
+    return archive.data + entry.offset;
+}
+
+static bool readBlock(const Archive &archive, const ArchiveBlock &block, uint8_t *destination) {
+    if (block.offset + block.compressedSize > archive.size) {
+        return false;
+    }
+    const uint8_t *source = archive.data + block.offset;
+    if (block.compressedSize == block.size) {
+        memcpy(destination, source, block.size);
+        return true;
+    }
+    return lz4Decompress(source, block.compressedSize, destination, block.size) == (int64_t) block.size;
+}
+
+bool archiveRead(State *state, const Archive &archive, const ArchiveEntry &entry, void *destination) {
+    uint8_t *out = static_cast<uint8_t *>(destination);
+    if (!(entry.flags & ARCHIVE_ENTRY_COMPRESSED)) {
+        const void *view = archiveView(archive, entry);
+        if (view) {
+            memcpy(out, view, entry.size);
+        }
+        return view != nullptr;
+    }
+    if ((uint64_t) entry.firstBlock + entry.blockCount > archive.header->blockCount) {
+        return false;
+    }
+
+    // الكتل بحجم ثابت، فموضع كل كتلة في الناتج معروف بدون انتظار ما قبلها
+    std::atomic<bool> valid{true};
+    jobsParallelFor(state, entry.blockCount, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            const ArchiveBlock &block = archive.blocks[entry.firstBlock + i];
+            uint64_t offset = (uint64_t) i * ARCHIVE_BLOCK_SIZE;
+            if (offset + block.size > entry.size || !readBlock(archive, block, out + offset)) {
+                valid.store(false, std::memory_order_relaxed);
+            }
+        }
+    });
+    return valid.load();
+}
+
+bool archiveRead(const Archive &archive, const ArchiveEntry &entry, void *destination) {
+    uint8_t *out = static_cast<uint8_t *>(destination);
+    if (!(entry.flags & ARCHIVE_ENTRY_COMPRESSED)) {
+        const void *view = archiveView(archive, entry);
+        if (view) {
+            memcpy(out, view, entry.size);
+        }
+        return view != nullptr;
+    }
+    if ((uint64_t) entry.firstBlock + entry.blockCount > archive.header->blockCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < entry.blockCount; i++) {
+        const ArchiveBlock &block = archive.blocks[entry.firstBlock + i];
+        uint64_t offset = (uint64_t) i * ARCHIVE_BLOCK_SIZE;
+        if (offset + block.size > entry.size || !readBlock(archive, block, out + offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void runArchiveBenchmark(State *state) {
+    Archive &archive = state->archive;
+    if (!archive.data) {
+        std::cerr << "Archive benchmark needs --archive <path>" << std::endl;
+        return;
+    }
+
+    uint64_t totalSize = 0;
+    uint32_t zeroCopy = 0;
+    for (uint32_t i = 0; i < archive.header->entryCount; i++) {
+        totalSize += archive.entries[i].size;
+        zeroCopy += !(archive.entries[i].flags & ARCHIVE_ENTRY_COMPRESSED);
+    }
+    std::vector<uint8_t> buffer;
+
+    auto measure = [&](const char *name, bool parallel) {
+        auto start = std::chrono::steady_clock::now();
+        uint32_t failures = 0;
+        for (uint32_t i = 0; i < archive.header->entryCount; i++) {
+            const ArchiveEntry &entry = archive.entries[i];
+            buffer.resize(entry.size);
+            if (!(entry.flags & ARCHIVE_ENTRY_COMPRESSED)) {
+                // المسار بدون نسخ: مجرد مؤشر، والصفحات تُقرأ عند أول لمس
+                failures += archiveView(archive, entry) == nullptr;
+                continue;
+            }
+            if (parallel) {
+                failures += !archiveRead(state, archive, entry, buffer.data());
+            } else {
+                failures += !archiveRead(archive, entry, buffer.data());
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("Archive benchmark: %-9s %.1f MB in %.2f ms (%.0f MB/s), %u failures\n", name,
+               (double) totalSize / (1 << 20), seconds * 1000.0, (double) totalSize / (1 << 20) / seconds, failures);
+    };
+    printf("Archive benchmark: %u entries, %u zero-copy\n", archive.header->entryCount, zeroCopy);
+    measure("serial", false);
+    measure("parallel", true);
+}
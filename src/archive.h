@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct State;
+
+// تنسيق الأرشيف (كل الحقول little-endian ومحاذاة طبيعية ليُقرأ مباشرة من الذاكرة المعيّنة):
+// [ArchiveHeader][ArchiveEntry * entryCount مرتبة حسب id][ArchiveBlock * blockCount][البيانات]
+constexpr char ARCHIVE_MAGIC[4] = {'B', 'K', 'P', 'A'};
+constexpr uint32_t ARCHIVE_VERSION = 1;
+constexpr uint32_t ARCHIVE_BLOCK_SIZE = 64 * 1024;     // كل كتلة تُضغط وتُفك باستقلال
+constexpr uint32_t ARCHIVE_DATA_ALIGNMENT = 64;
+
+enum ArchiveEntryFlags : uint32_t {
+    ARCHIVE_ENTRY_COMPRESSED = 1,
+};
+
+struct ArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t blockCount;
+    uint64_t entriesOffset;
+    uint64_t blocksOffset;
+};
+
+struct ArchiveEntry {
+    uint64_t id;                // archiveHash للمسار
+    uint64_t offset;            // للمدخلات غير المضغوطة: موضع البيانات
+    uint64_t size;              // الحجم بعد فك الضغط
+    uint32_t firstBlock;        // للمدخلات المضغوطة
+    uint32_t blockCount;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+// كتلة لم يصغر حجمها بالضغط تُخزَّن كما هي وcompressedSize == size
+struct ArchiveBlock {
+    uint64_t offset;
+    uint32_t compressedSize;
+    uint32_t size;
+};
+
+static_assert(sizeof(ArchiveHeader) == 32, "ArchiveHeader layout");
+static_assert(sizeof(ArchiveEntry) == 40, "ArchiveEntry layout");
+static_assert(sizeof(ArchiveBlock) == 16, "ArchiveBlock layout");
+
+// FNV-1a 64 على المسار بفواصل '/'؛ يحسبه الـ packer والمحرك بنفس الطريقة
+constexpr uint64_t archiveHash(const char *path) {
+    uint64_t hash = 14695981039346656037ull;
+    for (; *path; path++) {
+        char c = *path == '\\' ? '/' : *path;
+        hash ^= (uint8_t) c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+struct Archive {
+    int file = -1;
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    const ArchiveHeader *header = nullptr;
+    const ArchiveEntry *entries = nullptr;
+    const ArchiveBlock *blocks = nullptr;
+};
+
+bool openArchive(Archive *archive, const char *path);
+void closeArchive(Archive *archive);
+
+// بحث ثنائي في الجدول المعيّن مباشرة، بدون أي تحليل عند الفتح
+const ArchiveEntry *archiveFind(const Archive &archive, uint64_t id);
+
+// مؤشر مباشر داخل الملف المعيّن للمدخلات غير المضغوطة، وإلا nullptr
+const void *archiveView(const Archive &archive, const ArchiveEntry &entry);
+
+// يفك الكتل على نظام المهام في destination بحجم entry.size
+bool archiveRead(State *state, const Archive &archive, const ArchiveEntry &entry, void *destination);
+// نفسها على الخيط المستدعي، لخيوط غير الخيط الرئيسي
+bool archiveRead(const Archive &archive, const ArchiveEntry &entry, void *destination);
+
+// --bench archive: قراءة كل المدخلات تسلسلياً ثم بالتوازي
+void runArchiveBenchmark(State *state);
@@ -0,0 +1,225 @@
+#include "bindless.h"
+#include "descriptors.h"
+#include "state.h"
+
+#include <algorithm>
+#include <iostream>
+
+static const VkDescriptorType bindlessTypes[BINDLESS_BINDING_COUNT] = {
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+    VK_DESCRIPTOR_TYPE_SAMPLER,
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+};
+
+static VkSampler defaultSampler(State *state, VkFilter filter) {
+    VkSamplerCreateInfo samplerInfo{
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = filter,
+        .minFilter = filter,
+        .mipmapMode = filter == VK_FILTER_LINEAR ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .maxLod = 1000.0f,
+    };
+    return getSampler(state, samplerInfo);
+}
+
+void createBindless(State *state) {
+    Bindless &bindless = state->bindless;
+    if (!state->descriptorIndexing) {
+        std::cout << "Bindless: descriptor indexing not supported" << std::endl;
+        return;
+    }
+
+    VkPhysicalDeviceVulkan12Properties properties12{};
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &properties12;
+    vkGetPhysicalDeviceProperties2(state->physicalDevice, &properties);
+
+    // مجموع الموارد لكل مرحلة محدود أيضاً، لذا نقسم الحد الكلي بين المصفوفات الثلاث
+    uint32_t perStageShare = properties12.maxPerStageUpdateAfterBindResources / BINDLESS_BINDING_COUNT;
+    bindless.arrays[BINDLESS_BINDING_SAMPLED_IMAGES].capacity = std::min({
+        BINDLESS_MAX_SAMPLED_IMAGES, perStageShare,
+        properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+        properties12.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    bindless.arrays[BINDLESS_BINDING_SAMPLERS].capacity = std::min({
+        BINDLESS_MAX_SAMPLERS, perStageShare,
+        properties12.maxDescriptorSetUpdateAfterBindSamplers,
+        properties12.maxPerStageDescriptorUpdateAfterBindSamplers});
+    bindless.arrays[BINDLESS_BINDING_STORAGE_BUFFERS].capacity = std::min({
+        BINDLESS_MAX_STORAGE_BUFFERS, perStageShare,
+        properties12.maxDescriptorSetUpdateAfterBindStorageBuffers,
+        properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+
+    VkDescriptorSetLayoutBinding bindings[BINDLESS_BINDING_COUNT];
+    VkDescriptorBindingFlags bindingFlags[BINDLESS_BINDING_COUNT];
+    VkDescriptorPoolSize poolSizes[BINDLESS_BINDING_COUNT];
+    for (uint32_t i = 0; i < BINDLESS_BINDING_COUNT; i++) {
+        bindings[i] = {
+            .binding = i,
+            .descriptorType = bindlessTypes[i],
+            .descriptorCount = bindless.arrays[i].capacity,
+            .stageFlags = VK_SHADER_STAGE_ALL,
+        };
+        bindingFlags[i] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                          VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+                          VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+        poolSizes[i] = {
+            .type = bindlessTypes[i],
+            .descriptorCount = bindless.arrays[i].capacity,
+        };
+    }
+
+    bindless.setLayout = getDescriptorSetLayout(state, bindings, BINDLESS_BINDING_COUNT,
+                                                VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+                                                bindingFlags);
+
+    VkDescriptorPoolCreateInfo poolInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets = 1,
+        .poolSizeCount = BINDLESS_BINDING_COUNT,
+        .pPoolSizes = poolSizes,
+    };
+    VkResult result = vkCreateDescriptorPool(state->device, &poolInfo, state->allocator, &bindless.pool);
+    EXPECT(result != VK_SUCCESS, "Failed to create bindless descriptor pool");
+
+    VkDescriptorSetAllocateInfo allocateInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = bindless.pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &bindless.setLayout,
+    };
+    result = vkAllocateDescriptorSets(state->device, &allocateInfo, &bindless.set);
+    EXPECT(result != VK_SUCCESS, "Failed to allocate bindless descriptor set");
+
+    VkPushConstantRange pushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_ALL,
+        .offset = 0,
+        .size = BINDLESS_PUSH_CONSTANT_SIZE,
+    };
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &bindless.setLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
+    };
+    result = vkCreatePipelineLayout(state->device, &pipelineLayoutInfo, state->allocator, &bindless.pipelineLayout);
+    EXPECT(result != VK_SUCCESS, "Failed to create bindless pipeline layout");
+
+    // الفهارس المحجوزة: أخذ العينات الخطي والأقرب، ونسيج أبيض للموارد المفقودة
+    bindless.samplers[0] = defaultSampler(state, VK_FILTER_LINEAR);
+    bindless.samplers[1] = defaultSampler(state, VK_FILTER_NEAREST);
+    BindlessHandle linearSampler = bindlessAddSampler(state, bindless.samplers[0]);
+    BindlessHandle nearestSampler = bindlessAddSampler(state, bindless.samplers[1]);
+    EXPECT(linearSampler != BINDLESS_SAMPLER_LINEAR || nearestSampler != BINDLESS_SAMPLER_NEAREST,
+           "Unexpected sampler indices");
+
+    const uint32_t white = 0xFFFFFFFF;
+    bindless.defaultTexture = createTexture(state, {.width = 1, .height = 1}, &white);
+    BindlessHandle defaultTexture = bindlessAddSampledImage(state, bindless.defaultTexture.image.view,
+                                                            bindless.defaultTexture.layout);
+    EXPECT(defaultTexture != BINDLESS_DEFAULT_TEXTURE, "Unexpected default texture index");
+
+    std::cout << "Bindless heap: " << bindless.arrays[BINDLESS_BINDING_SAMPLED_IMAGES].capacity << " images, "
+              << bindless.arrays[BINDLESS_BINDING_SAMPLERS].capacity << " samplers, "
+              << bindless.arrays[BINDLESS_BINDING_STORAGE_BUFFERS].capacity << " storage buffers" << std::endl;
+}
+
+void destroyBindless(State *state) {
+    Bindless &bindless = state->bindless;
+    destroyTexture(state, &bindless.defaultTexture);
+    deferDestroy(state, bindless.pipelineLayout);
+    deferDestroy(state, bindless.pool);
+    bindless = {};
+}
+
+static BindlessHandle allocateHandle(State *state, BindlessBinding binding) {
+    BindlessArray &array = state->bindless.arrays[binding];
+    if (!array.freeList.empty()) {
+        BindlessHandle handle = array.freeList.back();
+        array.freeList.pop_back();
+        return handle;
+    }
+    EXPECT(array.next >= array.capacity, "Bindless array %u is full (%u)", binding, array.capacity);
+    return array.next++;
+}
+
+static void writeDescriptor(State *state, BindlessBinding binding, BindlessHandle handle,
+                            const VkDescriptorImageInfo *imageInfo, const VkDescriptorBufferInfo *bufferInfo) {
+    VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = state->bindless.set,
+        .dstBinding = binding,
+        .dstArrayElement = handle,
+        .descriptorCount = 1,
+        .descriptorType = bindlessTypes[binding],
+        .pImageInfo = imageInfo,
+        .pBufferInfo = bufferInfo,
+    };
+    vkUpdateDescriptorSets(state->device, 1, &write, 0, nullptr);
+}
+
+BindlessHandle bindlessAddSampledImage(State *state, VkImageView imageView, VkImageLayout layout) {
+    BindlessHandle handle = allocateHandle(state, BINDLESS_BINDING_SAMPLED_IMAGES);
+    VkDescriptorImageInfo imageInfo{
+        .imageView = imageView,
+        .imageLayout = layout,
+    };
+    writeDescriptor(state, BINDLESS_BINDING_SAMPLED_IMAGES, handle, &imageInfo, nullptr);
+    return handle;
+}
+
+BindlessHandle bindlessAddSampler(State *state, VkSampler sampler) {
+    BindlessHandle handle = allocateHandle(state, BINDLESS_BINDING_SAMPLERS);
+    VkDescriptorImageInfo imageInfo{
+        .sampler = sampler,
+    };
+    writeDescriptor(state, BINDLESS_BINDING_SAMPLERS, handle, &imageInfo, nullptr);
+    return handle;
+}
+
+BindlessHandle bindlessAddStorageBuffer(State *state, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    BindlessHandle handle = allocateHandle(state, BINDLESS_BINDING_STORAGE_BUFFERS);
+    VkDescriptorBufferInfo bufferInfo{
+        .buffer = buffer,
+        .offset = offset,
+        .range = range,
+    };
+    writeDescriptor(state, BINDLESS_BINDING_STORAGE_BUFFERS, handle, nullptr, &bufferInfo);
+    return handle;
+}
+
+void bindlessRemove(State *state, BindlessBinding binding, BindlessHandle handle) {
+    if (handle == BINDLESS_INVALID_HANDLE) {
+        return;
+    }
+    state->bindless.arrays[binding].retired.push_back({
+        .retireValue = deletionRetireValue(state),
+        .handle = handle,
+    });
+}
+
+void bindlessCollect(State *state) {
+    uint64_t completed = state->graphicsTimeline.completedValue;
+    for (BindlessArray &array : state->bindless.arrays) {
+        while (!array.retired.empty() && array.retired.front().retireValue <= completed) {
+            array.freeList.push_back(array.retired.front().handle);
+            array.retired.pop_front();
+        }
+    }
+}
+
+void bindlessBind(State *state, VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) {
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, state->bindless.pipelineLayout, 0, 1, &state->bindless.set, 0,
+                            nullptr);
+}
+
+void bindlessPushConstants(State *state, VkCommandBuffer commandBuffer, const void *data, uint32_t size) {
+    EXPECT(size > BINDLESS_PUSH_CONSTANT_SIZE, "Push constants too large: %u", size);
+    vkCmdPushConstants(commandBuffer, state->bindless.pipelineLayout, VK_SHADER_STAGE_ALL, 0, size, data);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "texture.h"
+
+struct State;
+
+// الأحجام القصوى المطلوبة؛ تُقلَّص إلى حدود الجهاز عند الإنشاء
+constexpr uint32_t BINDLESS_MAX_SAMPLED_IMAGES = 16384;
+constexpr uint32_t BINDLESS_MAX_SAMPLERS = 64;
+constexpr uint32_t BINDLESS_MAX_STORAGE_BUFFERS = 16384;
+constexpr uint32_t BINDLESS_PUSH_CONSTANT_SIZE = 128;
+
+// يجب أن تطابق shaders/bindless.glsl
+enum BindlessBinding : uint32_t {
+    BINDLESS_BINDING_SAMPLED_IMAGES = 0,
+    BINDLESS_BINDING_SAMPLERS = 1,
+    BINDLESS_BINDING_STORAGE_BUFFERS = 2,
+    BINDLESS_BINDING_COUNT = 3,
+};
+
+typedef uint32_t BindlessHandle;
+constexpr BindlessHandle BINDLESS_INVALID_HANDLE = UINT32_MAX;
+
+// فهارس ثابتة محجوزة عند الإنشاء
+constexpr BindlessHandle BINDLESS_DEFAULT_TEXTURE = 0;     // بكسل أبيض واحد
+constexpr BindlessHandle BINDLESS_SAMPLER_LINEAR = 0;
+constexpr BindlessHandle BINDLESS_SAMPLER_NEAREST = 1;
+
+struct BindlessRetired {
+    uint64_t retireValue;
+    BindlessHandle handle;
+};
+
+struct BindlessArray {
+    uint32_t capacity = 0;
+    uint32_t next = 0;                      // أول فهرس لم يُستخدم من قبل
+    std::vector<BindlessHandle> freeList;
+    std::deque<BindlessRetired> retired;    // لا يُعاد استخدام الفهرس حتى ينتهي الـ GPU منه
+};
+
+struct Bindless {
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;          // يملكه كاش التخطيطات
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    BindlessArray arrays[BINDLESS_BINDING_COUNT];
+    VkSampler samplers[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};   // يملكها كاش الـ samplers
+    Texture defaultTexture;
+};
+
+void createBindless(State *state);
+void destroyBindless(State *state);
+
+BindlessHandle bindlessAddSampledImage(State *state, VkImageView imageView, VkImageLayout layout);
+BindlessHandle bindlessAddSampler(State *state, VkSampler sampler);
+BindlessHandle bindlessAddStorageBuffer(State *state, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+void bindlessRemove(State *state, BindlessBinding binding, BindlessHandle handle);
+
+// يُستدعى في بداية كل إطار لإعادة الفهارس التي انتهى الـ GPU منها إلى قائمة الفهارس الحرة
+void bindlessCollect(State *state);
+
+// مجموعة واحدة تُربط مرة لكل قائمة أوامر؛ الرسم يحدد موارده بالفهارس عبر push constants
+void bindlessBind(State *state, VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint);
+void bindlessPushConstants(State *state, VkCommandBuffer commandBuffer, const void *data, uint32_t size);
@@ -0,0 +1,111 @@
+#include "buffer.h"
+#include "state.h"
+
+uint32_t findMemoryType(State *state, uint32_t typeBits, VkMemoryPropertyFlags required,
+                        VkMemoryPropertyFlags preferred) {
+    const VkPhysicalDeviceMemoryProperties &properties = state->memoryProperties;
+    VkMemoryPropertyFlags wanted[2] = {required | preferred, required};
+    for (VkMemoryPropertyFlags flags : wanted) {
+        for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+            if ((typeBits & (1u << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags) {
+                return i;
+            }
+        }
+    }
+    EXPECT(true, "No memory type for bits 0x%x with flags 0x%x", typeBits, required);
+    return UINT32_MAX;
+}
+
+void applyQueueSharing(State *state, VkSharingMode *sharingMode, uint32_t *queueFamilyIndexCount,
+                       const uint32_t **queueFamilyIndices) {
+    if (state->transferTimeline.queue == VK_NULL_HANDLE ||
+        state->transferTimeline.familyIndex == state->graphicsTimeline.familyIndex) {
+        *sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        *queueFamilyIndexCount = 0;
+        *queueFamilyIndices = nullptr;
+        return;
+    }
+    *sharingMode = VK_SHARING_MODE_CONCURRENT;
+    *queueFamilyIndexCount = 2;
+    *queueFamilyIndices = state->sharedQueueFamilies;
+}
+
+Buffer createBuffer(State *state, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required,
+                    VkMemoryPropertyFlags preferred) {
+    Buffer buffer{.size = size};
+
+    VkBufferCreateInfo bufferInfo{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = usage,
+    };
+    applyQueueSharing(state, &bufferInfo.sharingMode, &bufferInfo.queueFamilyIndexCount,
+                      &bufferInfo.pQueueFamilyIndices);
+    VkResult result = vkCreateBuffer(state->device, &bufferInfo, state->allocator, &buffer.buffer);
+    EXPECT(result != VK_SUCCESS, "Failed to create buffer of %llu bytes", (unsigned long long) size);
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(state->device, buffer.buffer, &requirements);
+    uint32_t memoryType = findMemoryType(state, requirements.memoryTypeBits, required, preferred);
+    buffer.memoryFlags = state->memoryProperties.memoryTypes[memoryType].propertyFlags;
+
+    VkMemoryAllocateFlagsInfo flagsInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+        .flags = (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) ? (VkMemoryAllocateFlags)
+                     VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT : 0u,
+    };
+    VkMemoryAllocateInfo allocateInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = &flagsInfo,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = memoryType,
+    };
+    result = vkAllocateMemory(state->device, &allocateInfo, state->allocator, &buffer.memory);
+    EXPECT(result != VK_SUCCESS, "Failed to allocate %llu bytes of buffer memory",
+           (unsigned long long) requirements.size);
+    result = vkBindBufferMemory(state->device, buffer.buffer, buffer.memory, 0);
+    EXPECT(result != VK_SUCCESS, "Failed to bind buffer memory");
+
+    if (buffer.memoryFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        result = vkMapMemory(state->device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.mapped);
+        EXPECT(result != VK_SUCCESS, "Failed to map buffer memory");
+    }
+    return buffer;
+}
+
+void destroyBuffer(State *state, Buffer *buffer) {
+    // الـ unmap ضمني عند تحرير الذاكرة
+    deferDestroy(state, buffer->buffer);
+    deferDestroy(state, buffer->memory);
+    *buffer = {};
+}
+
+static VkMappedMemoryRange alignedRange(State *state, const Buffer &buffer, VkDeviceSize offset,
+                                        VkDeviceSize size) {
+    VkDeviceSize atom = state->physicalDeviceProperties.limits.nonCoherentAtomSize;
+    VkDeviceSize begin = offset / atom * atom;
+    VkDeviceSize end = alignUp(offset + size, atom);
+    return {
+        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+        .memory = buffer.memory,
+        .offset = begin,
+        .size = end >= buffer.size ? VK_WHOLE_SIZE : end - begin,
+    };
+}
+
+void flushBuffer(State *state, const Buffer &buffer, VkDeviceSize offset, VkDeviceSize size) {
+    if (buffer.memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT || size == 0) {
+        return;
+    }
+    VkMappedMemoryRange range = alignedRange(state, buffer, offset, size);
+    EXPECT(vkFlushMappedMemoryRanges(state->device, 1, &range) != VK_SUCCESS, "Failed to flush mapped memory");
+}
+
+void invalidateBuffer(State *state, const Buffer &buffer, VkDeviceSize offset, VkDeviceSize size) {
+    if (buffer.memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT || size == 0) {
+        return;
+    }
+    VkMappedMemoryRange range = alignedRange(state, buffer, offset, size);
+    EXPECT(vkInvalidateMappedMemoryRanges(state->device, 1, &range) != VK_SUCCESS,
+           "Failed to invalidate mapped memory");
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+
+struct State;
+
+struct Buffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    VkMemoryPropertyFlags memoryFlags = 0;
+    void *mapped = nullptr;     // مُعيَّن بشكل دائم إذا كانت الذاكرة مرئية للمضيف
+};
+
+// تبحث أولاً عن نوع يحقق required و preferred معاً، ثم required وحدها
+uint32_t findMemoryType(State *state, uint32_t typeBits, VkMemoryPropertyFlags required,
+                        VkMemoryPropertyFlags preferred = 0);
+
+Buffer createBuffer(State *state, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required,
+                    VkMemoryPropertyFlags preferred = 0);
+void destroyBuffer(State *state, Buffer *buffer);
+
+// مطلوب فقط للذاكرة غير المتماسكة (non-coherent)
+void flushBuffer(State *state, const Buffer &buffer, VkDeviceSize offset, VkDeviceSize size);
+void invalidateBuffer(State *state, const Buffer &buffer, VkDeviceSize offset, VkDeviceSize size);
+
+// الموارد التي يكتبها طابور النقل ويقرأها طابور الرسم تُنشأ بمشاركة متزامنة بدل نقل الملكية
+void applyQueueSharing(State *state, VkSharingMode *sharingMode, uint32_t *queueFamilyIndexCount,
+                       const uint32_t **queueFamilyIndices);
+
+inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+// صيغ الأصول المطبوخة مسبقاً بواسطة أداة cooker؛ المحرك يرفعها كما هي دون أي تحويل.
+// لا تعتمد على Vulkan حتى تُبنى الأداة بدون الـ SDK
+
+constexpr char COOKED_TEXTURE_MAGIC[4] = {'B', 'K', 'T', 'X'};
+constexpr char COOKED_MESH_MAGIC[4] = {'B', 'K', 'M', 'S'};
+constexpr uint32_t COOKED_VERSION = 1;
+
+enum class CookedFormat : uint32_t {
+    RGBA8Srgb,
+    RGBA8Unorm,
+    BC1Srgb,
+    BC1Unorm,
+    BC7Srgb,
+    BC7Unorm,
+};
+
+// يليه كل مستويات الـ mip مرصوصة بالتتابع، بنفس ترتيب createTexture
+struct CookedTextureHeader {
+    char magic[4];
+    uint32_t version;
+    CookedFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipLevels;
+    uint32_t bytesPerBlock;
+    uint32_t blockSize;         // 1 للصيغ غير المضغوطة، 4 لـ BC
+    uint64_t dataSize;
+    uint64_t reserved;
+};
+
+// 16 بايت لكل رأس: الموضع مُكمّم إلى unorm16 داخل الصندوق المحيط، والعمودي snorm8، والـ UV بنصف دقة
+struct CookedVertex {
+    uint16_t position[4];
+    int8_t normal[4];
+    uint16_t uv[2];
+};
+
+// يليه vertexCount * CookedVertex ثم indexCount فهرس بحجم indexSize
+struct CookedMeshHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;         // 2 أو 4
+    uint32_t reserved;
+    float positionOffset[3];    // الموضع = offset + scale * unorm
+    float positionScale[3];
+    float boundsCenter[3];
+    float boundsRadius;
+};
+
+static_assert(sizeof(CookedTextureHeader) == 48, "CookedTextureHeader layout");
+static_assert(sizeof(CookedVertex) == 16, "CookedVertex layout");
+static_assert(sizeof(CookedMeshHeader) == 64, "CookedMeshHeader layout");
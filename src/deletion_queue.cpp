@@ -0,0 +1,98 @@
+#include "deletion_queue.h"
+#include "state.h"
+
+uint64_t deletionRetireValue(const State *state) {
+    // الكائن قد يكون مستخدماً في أوامر لم تُرسل بعد، فأول قيمة آمنة هي الإرسال التالي
+    return state->graphicsTimeline.submittedValue + 1;
+}
+
+void deletionQueuePush(State *state, VkObjectType type, uint64_t handle, uint64_t retireValue) {
+    DeletionQueue &queue = state->deletionQueue;
+    if (queue.buckets.empty() || queue.buckets.back().retireValue < retireValue) {
+        DeletionBucket bucket{.retireValue = retireValue};
+        if (!queue.spareEntries.empty()) {
+            bucket.entries = std::move(queue.spareEntries.back());
+            queue.spareEntries.pop_back();
+        }
+        queue.buckets.push_back(std::move(bucket));
+    }
+    EXPECT(queue.buckets.back().retireValue > retireValue, "Deletion retire value went backwards: %llu",
+           (unsigned long long) retireValue);
+    queue.buckets.back().entries.push_back({.type = type, .handle = handle});
+    queue.pendingCount++;
+}
+
+static void destroyEntry(State *state, const DeletionEntry &entry) {
+    switch (entry.type) {
+        case VK_OBJECT_TYPE_IMAGE_VIEW:
+            vkDestroyImageView(state->device, (VkImageView) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+            vkDestroySwapchainKHR(state->device, (VkSwapchainKHR) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_IMAGE:
+            vkDestroyImage(state->device, (VkImage) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_BUFFER:
+            vkDestroyBuffer(state->device, (VkBuffer) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_DEVICE_MEMORY:
+            vkFreeMemory(state->device, (VkDeviceMemory) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_SAMPLER:
+            vkDestroySampler(state->device, (VkSampler) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_PIPELINE:
+            vkDestroyPipeline(state->device, (VkPipeline) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+            vkDestroyPipelineLayout(state->device, (VkPipelineLayout) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+            vkDestroyDescriptorSetLayout(state->device, (VkDescriptorSetLayout) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+            vkDestroyDescriptorPool(state->device, (VkDescriptorPool) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_SHADER_MODULE:
+            vkDestroyShaderModule(state->device, (VkShaderModule) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_SEMAPHORE:
+            vkDestroySemaphore(state->device, (VkSemaphore) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_FENCE:
+            vkDestroyFence(state->device, (VkFence) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_COMMAND_POOL:
+            vkDestroyCommandPool(state->device, (VkCommandPool) entry.handle, state->allocator);
+            break;
+        case VK_OBJECT_TYPE_QUERY_POOL:
+            vkDestroyQueryPool(state->device, (VkQueryPool) entry.handle, state->allocator);
+            break;
+        default:
+            EXPECT(true, "Unsupported deferred object type %i", entry.type);
+    }
+}
+
+void deletionQueueFlush(State *state, uint64_t completedValue) {
+    DeletionQueue &queue = state->deletionQueue;
+    // المسار السريع: لا شيء جاهز للتحرير في معظم الإطارات
+    if (queue.buckets.empty() || queue.buckets.front().retireValue > completedValue) {
+        return;
+    }
+
+    while (!queue.buckets.empty() && queue.buckets.front().retireValue <= completedValue) {
+        DeletionBucket &bucket = queue.buckets.front();
+        for (const DeletionEntry &entry : bucket.entries) {
+            destroyEntry(state, entry);
+        }
+        queue.pendingCount -= bucket.entries.size();
+        bucket.entries.clear();
+        queue.spareEntries.push_back(std::move(bucket.entries));
+        queue.buckets.pop_front();
+    }
+}
+
+void deletionQueueFlushAll(State *state) {
+    deletionQueueFlush(state, UINT64_MAX);
+}
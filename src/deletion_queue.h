@@ -0,0 +1,102 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+struct State;
+
+// كائن Vulkan ينتظر التدمير؛ نخزّن النوع والمقبض فقط بدل std::function لتجنّب التخصيص لكل طلب
+struct DeletionEntry {
+    VkObjectType type;
+    uint64_t handle;
+};
+
+// كل الكائنات التي تقاعدت عند نفس قيمة الـ graphics timeline تُحرَّر دفعة واحدة
+struct DeletionBucket {
+    uint64_t retireValue;
+    std::vector<DeletionEntry> entries;
+};
+
+struct DeletionQueue {
+    std::deque<DeletionBucket> buckets;                     // مرتبة تصاعدياً حسب retireValue
+    std::vector<std::vector<DeletionEntry>> spareEntries;   // مصفوفات مُعاد تدويرها
+    uint64_t pendingCount = 0;
+};
+
+void deletionQueuePush(State *state, VkObjectType type, uint64_t handle, uint64_t retireValue);
+void deletionQueueFlush(State *state, uint64_t completedValue);
+void deletionQueueFlushAll(State *state);
+
+// القيمة التي يجب أن يتجاوزها الـ GPU قبل أن يصبح التدمير آمناً
+uint64_t deletionRetireValue(const State *state);
+
+template<typename T>
+void deferDestroy(State *state, VkObjectType type, T handle) {
+    if (handle == VK_NULL_HANDLE) {
+        return;
+    }
+    deletionQueuePush(state, type, (uint64_t) handle, deletionRetireValue(state));
+}
+
+inline void deferDestroy(State *state, VkImageView imageView) {
+    deferDestroy(state, VK_OBJECT_TYPE_IMAGE_VIEW, imageView);
+}
+
+inline void deferDestroy(State *state, VkSwapchainKHR swapchain) {
+    deferDestroy(state, VK_OBJECT_TYPE_SWAPCHAIN_KHR, swapchain);
+}
+
+inline void deferDestroy(State *state, VkImage image) {
+    deferDestroy(state, VK_OBJECT_TYPE_IMAGE, image);
+}
+
+inline void deferDestroy(State *state, VkBuffer buffer) {
+    deferDestroy(state, VK_OBJECT_TYPE_BUFFER, buffer);
+}
+
+inline void deferDestroy(State *state, VkDeviceMemory memory) {
+    deferDestroy(state, VK_OBJECT_TYPE_DEVICE_MEMORY, memory);
+}
+
+inline void deferDestroy(State *state, VkSampler sampler) {
+    deferDestroy(state, VK_OBJECT_TYPE_SAMPLER, sampler);
+}
+
+inline void deferDestroy(State *state, VkPipeline pipeline) {
+    deferDestroy(state, VK_OBJECT_TYPE_PIPELINE, pipeline);
+}
+
+inline void deferDestroy(State *state, VkPipelineLayout pipelineLayout) {
+    deferDestroy(state, VK_OBJECT_TYPE_PIPELINE_LAYOUT, pipelineLayout);
+}
+
+inline void deferDestroy(State *state, VkDescriptorSetLayout descriptorSetLayout) {
+    deferDestroy(state, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, descriptorSetLayout);
+}
+
+inline void deferDestroy(State *state, VkDescriptorPool descriptorPool) {
+    deferDestroy(state, VK_OBJECT_TYPE_DESCRIPTOR_POOL, descriptorPool);
+}
+
+inline void deferDestroy(State *state, VkShaderModule shaderModule) {
+    deferDestroy(state, VK_OBJECT_TYPE_SHADER_MODULE, shaderModule);
+}
+
+inline void deferDestroy(State *state, VkSemaphore semaphore) {
+    deferDestroy(state, VK_OBJECT_TYPE_SEMAPHORE, semaphore);
+}
+
+inline void deferDestroy(State *state, VkFence fence) {
+    deferDestroy(state, VK_OBJECT_TYPE_FENCE, fence);
+}
+
+inline void deferDestroy(State *state, VkCommandPool commandPool) {
+    deferDestroy(state, VK_OBJECT_TYPE_COMMAND_POOL, commandPool);
+}
+
+inline void deferDestroy(State *state, VkQueryPool queryPool) {
+    deferDestroy(state, VK_OBJECT_TYPE_QUERY_POOL, queryPool);
+}
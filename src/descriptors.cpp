@@ -0,0 +1,208 @@
+#include "descriptors.h"
+#include "state.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+// عدد الواصفات لكل مجموعة في المجمع حسب النوع
+static const struct {
+    VkDescriptorType type;
+    float perSet;
+} poolRatios[] = {
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+    {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2.0f},
+    {VK_DESCRIPTOR_TYPE_SAMPLER, 1.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2.0f},
+    {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1.0f},
+};
+
+size_t DescriptorCacheKeyHash::operator()(const DescriptorCacheKey &key) const {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (uint64_t word : key) {
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    return (size_t) hash;
+}
+
+static uint64_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+void createDescriptorAllocator(State *state) {
+    state->descriptors = {};
+}
+
+void destroyDescriptorAllocator(State *state) {
+    DescriptorAllocator &allocator = state->descriptors;
+    for (FrameDescriptorPools &frame : allocator.frames) {
+        for (VkDescriptorPool &pool : frame.pools) {
+            deferDestroy(state, pool);
+        }
+    }
+    for (auto &[key, layout] : allocator.layouts) {
+        deferDestroy(state, layout);
+    }
+    for (auto &[key, sampler] : allocator.samplers) {
+        deferDestroy(state, sampler);
+    }
+    allocator = {};
+}
+
+void resetFrameDescriptors(State *state, uint32_t frameSlot) {
+    FrameDescriptorPools &frame = state->descriptors.frames[frameSlot];
+    // vkResetDescriptorPool يحرر كل المجموعات دفعة واحدة بدلاً من vkFreeDescriptorSets لكل مجموعة
+    for (uint32_t i = 0; i < frame.pools.size() && i <= frame.current; i++) {
+        VkResult result = vkResetDescriptorPool(state->device, frame.pools[i], 0);
+        EXPECT(result != VK_SUCCESS, "Failed to reset descriptor pool");
+    }
+    frame.current = 0;
+    frame.allocatedSets = 0;
+}
+
+static VkDescriptorPool createPool(State *state, uint32_t maxSets) {
+    VkDescriptorPoolSize poolSizes[std::size(poolRatios)];
+    for (uint32_t i = 0; i < std::size(poolRatios); i++) {
+        poolSizes[i] = {
+            .type = poolRatios[i].type,
+            .descriptorCount = std::max(1u, (uint32_t) (poolRatios[i].perSet * (float) maxSets)),
+        };
+    }
+    VkDescriptorPoolCreateInfo poolInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets = maxSets,
+        .poolSizeCount = (uint32_t) std::size(poolRatios),
+        .pPoolSizes = poolSizes,
+    };
+    VkDescriptorPool pool;
+    VkResult result = vkCreateDescriptorPool(state->device, &poolInfo, state->allocator, &pool);
+    EXPECT(result != VK_SUCCESS, "Failed to create descriptor pool");
+    return pool;
+}
+
+VkDescriptorSet allocateFrameDescriptorSet(State *state, VkDescriptorSetLayout layout) {
+    DescriptorAllocator &allocator = state->descriptors;
+    FrameDescriptorPools &frame = allocator.frames[state->frameNumber % FRAMES_IN_FLIGHT];
+
+    VkDescriptorSetAllocateInfo allocateInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &layout,
+    };
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    while (true) {
+        if (frame.current == frame.pools.size()) {
+            frame.pools.push_back(createPool(state, allocator.setsPerPool));
+            std::cout << "Descriptor pools: slot " << state->frameNumber % FRAMES_IN_FLIGHT << " grew to "
+                      << frame.pools.size() << " (" << allocator.setsPerPool << " sets)" << std::endl;
+            allocator.setsPerPool = std::min(allocator.setsPerPool * 2, MAX_SETS_PER_POOL);
+        }
+        allocateInfo.descriptorPool = frame.pools[frame.current];
+        VkResult result = vkAllocateDescriptorSets(state->device, &allocateInfo, &set);
+        if (result == VK_SUCCESS) {
+            break;
+        }
+        // المجمع الحالي ممتلئ: ننتقل للتالي ولا نعود إليه حتى التصفير
+        EXPECT(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL,
+               "Failed to allocate frame descriptor set");
+        frame.current++;
+    }
+    frame.allocatedSets++;
+    return set;
+}
+
+VkDescriptorSetLayout getDescriptorSetLayout(State *state, const VkDescriptorSetLayoutBinding *bindings,
+                                             uint32_t bindingCount, VkDescriptorSetLayoutCreateFlags flags,
+                                             const VkDescriptorBindingFlags *bindingFlags) {
+    // ترتيب الروابط لا يغير التخطيط، لذا يُرتَّب المفتاح حسب رقم الربط
+    std::vector<uint32_t> order(bindingCount);
+    for (uint32_t i = 0; i < bindingCount; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return bindings[a].binding < bindings[b].binding;
+    });
+
+    DescriptorCacheKey key;
+    key.push_back(flags);
+    for (uint32_t i : order) {
+        const VkDescriptorSetLayoutBinding &binding = bindings[i];
+        key.push_back(binding.binding);
+        key.push_back(binding.descriptorType);
+        key.push_back(binding.descriptorCount);
+        key.push_back(binding.stageFlags);
+        key.push_back(bindingFlags ? bindingFlags[i] : 0);
+        key.push_back(binding.pImmutableSamplers != nullptr);
+        if (binding.pImmutableSamplers) {
+            for (uint32_t j = 0; j < binding.descriptorCount; j++) {
+                key.push_back((uint64_t) binding.pImmutableSamplers[j]);
+            }
+        }
+    }
+
+    auto it = state->descriptors.layouts.find(key);
+    if (it != state->descriptors.layouts.end()) {
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount = bindingCount,
+        .pBindingFlags = bindingFlags,
+    };
+    VkDescriptorSetLayoutCreateInfo layoutInfo{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = bindingFlags ? &bindingFlagsInfo : nullptr,
+        .flags = flags,
+        .bindingCount = bindingCount,
+        .pBindings = bindings,
+    };
+    VkDescriptorSetLayout layout;
+    VkResult result = vkCreateDescriptorSetLayout(state->device, &layoutInfo, state->allocator, &layout);
+    EXPECT(result != VK_SUCCESS, "Failed to create descriptor set layout");
+    state->descriptors.layouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+VkSampler getSampler(State *state, const VkSamplerCreateInfo &samplerInfo) {
+    EXPECT(samplerInfo.pNext != nullptr, "Cached samplers do not support pNext chains");
+    DescriptorCacheKey key = {
+        samplerInfo.flags,
+        samplerInfo.magFilter,
+        samplerInfo.minFilter,
+        samplerInfo.mipmapMode,
+        samplerInfo.addressModeU,
+        samplerInfo.addressModeV,
+        samplerInfo.addressModeW,
+        floatBits(samplerInfo.mipLodBias),
+        samplerInfo.anisotropyEnable,
+        floatBits(samplerInfo.maxAnisotropy),
+        samplerInfo.compareEnable,
+        samplerInfo.compareOp,
+        floatBits(samplerInfo.minLod),
+        floatBits(samplerInfo.maxLod),
+        samplerInfo.borderColor,
+        samplerInfo.unnormalizedCoordinates,
+    };
+
+    auto it = state->descriptors.samplers.find(key);
+    if (it != state->descriptors.samplers.end()) {
+        return it->second;
+    }
+
+    VkSampler sampler;
+    VkResult result = vkCreateSampler(state->device, &samplerInfo, state->allocator, &sampler);
+    EXPECT(result != VK_SUCCESS, "Failed to create sampler");
+    state->descriptors.samplers.emplace(std::move(key), sampler);
+    return sampler;
+}
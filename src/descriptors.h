@@ -0,0 +1,47 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "frame.h"
+
+struct State;
+
+// مفتاح التخزين المؤقت: كل حقول الوصف مرصوصة ككلمات 64 بت
+typedef std::vector<uint64_t> DescriptorCacheKey;
+
+struct DescriptorCacheKeyHash {
+    size_t operator()(const DescriptorCacheKey &key) const;
+};
+
+// مجمعات فتحة إطار واحدة؛ تُصفَّر كلها معاً بعد أن ينتهي الـ GPU من الإطار
+struct FrameDescriptorPools {
+    std::vector<VkDescriptorPool> pools;
+    uint32_t current = 0;
+    uint32_t allocatedSets = 0;
+};
+
+struct DescriptorAllocator {
+    FrameDescriptorPools frames[FRAMES_IN_FLIGHT];
+    uint32_t setsPerPool = 64;      // يتضاعف كلما امتلأت كل المجمعات
+    std::unordered_map<DescriptorCacheKey, VkDescriptorSetLayout, DescriptorCacheKeyHash> layouts;
+    std::unordered_map<DescriptorCacheKey, VkSampler, DescriptorCacheKeyHash> samplers;
+};
+
+void createDescriptorAllocator(State *state);
+void destroyDescriptorAllocator(State *state);
+
+// يُستدعى من beginFrame بعد انتظار الفتحة
+void resetFrameDescriptors(State *state, uint32_t frameSlot);
+
+// مجموعة صالحة حتى نهاية الإطار الجاري فقط؛ لا تُحرَّر يدوياً
+VkDescriptorSet allocateFrameDescriptorSet(State *state, VkDescriptorSetLayout layout);
+
+// كائنات مشتركة يملكها الكاش: التخطيطات المتطابقة والـ samplers المتطابقة تُنشأ مرة واحدة
+VkDescriptorSetLayout getDescriptorSetLayout(State *state, const VkDescriptorSetLayoutBinding *bindings,
+                                             uint32_t bindingCount, VkDescriptorSetLayoutCreateFlags flags = 0,
+                                             const VkDescriptorBindingFlags *bindingFlags = nullptr);
+VkSampler getSampler(State *state, const VkSamplerCreateInfo &samplerInfo);
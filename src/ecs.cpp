@@ -0,0 +1,398 @@
+#include "ecs.h"
+#include "jobs.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <new>
+
+static size_t alignOffset(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+ComponentId ecsRegisterComponent(State *state, const std::type_index &type, const char *name, uint32_t size,
+                                 uint32_t alignment) {
+    World &world = state->world;
+    auto it = world.componentIds.find(type);
+    if (it != world.componentIds.end()) {
+        return it->second;
+    }
+    EXPECT(world.components.size() >= ECS_MAX_COMPONENTS, "Too many ECS components (max %u)", ECS_MAX_COMPONENTS);
+    EXPECT(alignment > ECS_CHUNK_ALIGNMENT, "Component %s alignment %u is too large", name, alignment);
+    ComponentId id = (ComponentId) world.components.size();
+    world.components.push_back({.name = name, .size = size, .alignment = alignment});
+    world.componentIds.emplace(type, id);
+    return id;
+}
+
+// يحسب أكبر عدد صفوف تتسع أعمدته كلها في قطعة واحدة مع الحشو
+static uint32_t layoutArchetype(World &world, Archetype &archetype, uint32_t capacity) {
+    size_t offset = alignOffset((size_t) capacity * sizeof(Entity), ECS_CHUNK_ALIGNMENT);
+    for (ComponentId component = 0; component < world.components.size(); component++) {
+        if (!((archetype.mask >> component) & 1)) {
+            continue;
+        }
+        const ComponentInfo &info = world.components[component];
+        offset = alignOffset(offset, std::max<size_t>(info.alignment, 16));
+        archetype.columnOffsets[component] = (uint32_t) offset;
+        offset += (size_t) capacity * info.size;
+    }
+    return (uint32_t) offset;
+}
+
+static uint32_t findArchetype(State *state, ComponentMask mask) {
+    World &world = state->world;
+    auto it = world.archetypeIndex.find(mask);
+    if (it != world.archetypeIndex.end()) {
+        return it->second;
+    }
+
+    Archetype archetype{};
+    archetype.mask = mask;
+    size_t rowSize = sizeof(Entity);
+    for (ComponentId component = 0; component < world.components.size(); component++) {
+        if ((mask >> component) & 1) {
+            rowSize += world.components[component].size;
+        }
+    }
+    uint32_t capacity = (uint32_t) (ECS_CHUNK_SIZE / rowSize);
+    while (capacity > 1 && layoutArchetype(world, archetype, capacity) > ECS_CHUNK_SIZE) {
+        capacity--;
+    }
+    EXPECT(layoutArchetype(world, archetype, capacity) > ECS_CHUNK_SIZE, "Archetype row does not fit in a chunk");
+    archetype.capacity = capacity;
+
+    uint32_t index = (uint32_t) world.archetypes.size();
+    world.archetypes.push_back(std::move(archetype));
+    world.archetypeIndex.emplace(mask, index);
+    return index;
+}
+
+static uint8_t *columnAt(const World &world, const Archetype &archetype, const Chunk &chunk, ComponentId component,
+                         uint32_t row) {
+    return chunk.data + archetype.columnOffsets[component] + (size_t) row * world.components[component].size;
+}
+
+static Entity *entityAt(const Chunk &chunk, uint32_t row) {
+    return reinterpret_cast<Entity *>(chunk.data) + row;
+}
+
+// كل القطع ممتلئة ما عدا الأخيرة، لذا الصف الجديد دائماً في آخر قطعة
+static void allocateRow(World &world, uint32_t archetypeIndex, Entity entity) {
+    Archetype &archetype = world.archetypes[archetypeIndex];
+    if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity) {
+        Chunk chunk;
+        chunk.data = static_cast<uint8_t *>(::operator new(ECS_CHUNK_SIZE, std::align_val_t(ECS_CHUNK_ALIGNMENT)));
+        archetype.chunks.push_back(chunk);
+    }
+    Chunk &chunk = archetype.chunks.back();
+    uint32_t row = chunk.count++;
+    *entityAt(chunk, row) = entity;
+    for (ComponentId component = 0; component < world.components.size(); component++) {
+        if ((archetype.mask >> component) & 1) {
+            memset(columnAt(world, archetype, chunk, component, row), 0, world.components[component].size);
+        }
+    }
+    archetype.entityCount++;
+
+    EntityRecord &record = world.entities[entity.index];
+    record.archetype = archetypeIndex;
+    record.chunk = (uint32_t) archetype.chunks.size() - 1;
+    record.row = row;
+}
+
+// الحذف بالتبديل مع آخر صف في النمط فتبقى الأعمدة متجاورة بدون فراغات
+static void removeRow(World &world, uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row) {
+    Archetype &archetype = world.archetypes[archetypeIndex];
+    Chunk &chunk = archetype.chunks[chunkIndex];
+    Chunk &last = archetype.chunks.back();
+    uint32_t lastRow = last.count - 1;
+
+    if (&chunk != &last || row != lastRow) {
+        Entity moved = *entityAt(last, lastRow);
+        *entityAt(chunk, row) = moved;
+        for (ComponentId component = 0; component < world.components.size(); component++) {
+            if ((archetype.mask >> component) & 1) {
+                memcpy(columnAt(world, archetype, chunk, component, row),
+                       columnAt(world, archetype, last, component, lastRow), world.components[component].size);
+            }
+        }
+        EntityRecord &record = world.entities[moved.index];
+        record.chunk = chunkIndex;
+        record.row = row;
+    }
+
+    last.count--;
+    archetype.entityCount--;
+    if (last.count == 0) {
+        ::operator delete(last.data, std::align_val_t(ECS_CHUNK_ALIGNMENT));
+        archetype.chunks.pop_back();
+    }
+}
+
+void destroyWorld(State *state) {
+    World &world = state->world;
+    for (Archetype &archetype : world.archetypes) {
+        for (Chunk &chunk : archetype.chunks) {
+            ::operator delete(chunk.data, std::align_val_t(ECS_CHUNK_ALIGNMENT));
+        }
+    }
+    world = {};
+}
+
+Entity ecsCreateEntity(State *state, ComponentMask mask) {
+    World &world = state->world;
+    Entity entity;
+    if (!world.freeEntities.empty()) {
+        entity.index = world.freeEntities.back();
+        world.freeEntities.pop_back();
+    } else {
+        entity.index = (uint32_t) world.entities.size();
+        world.entities.emplace_back();
+    }
+    EntityRecord &record = world.entities[entity.index];
+    record.alive = true;
+    entity.generation = record.generation;
+
+    allocateRow(world, findArchetype(state, mask), entity);
+    world.aliveCount++;
+    return entity;
+}
+
+bool ecsAlive(State *state, Entity entity) {
+    World &world = state->world;
+    return entity.index < world.entities.size() && world.entities[entity.index].alive &&
+           world.entities[entity.index].generation == entity.generation;
+}
+
+void ecsDestroyEntity(State *state, Entity entity) {
+    if (!ecsAlive(state, entity)) {
+        return;
+    }
+    World &world = state->world;
+    EntityRecord &record = world.entities[entity.index];
+    removeRow(world, record.archetype, record.chunk, record.row);
+    record.alive = false;
+    record.generation++;
+    world.freeEntities.push_back(entity.index);
+    world.aliveCount--;
+}
+
+static void moveEntity(State *state, Entity entity, ComponentMask newMask) {
+    World &world = state->world;
+    EntityRecord record = world.entities[entity.index];
+    if (world.archetypes[record.archetype].mask == newMask) {
+        return;
+    }
+    uint32_t target = findArchetype(state, newMask);
+    allocateRow(world, target, entity);
+
+    // findArchetype قد يعيد تخصيص المصفوفة، لذا تؤخذ المراجع بعده
+    const Archetype &source = world.archetypes[record.archetype];
+    const Archetype &destination = world.archetypes[target];
+    const EntityRecord &moved = world.entities[entity.index];
+    const Chunk &sourceChunk = source.chunks[record.chunk];
+    const Chunk &destinationChunk = destination.chunks[moved.chunk];
+    ComponentMask shared = source.mask & destination.mask;
+    for (ComponentId component = 0; component < world.components.size(); component++) {
+        if ((shared >> component) & 1) {
+            memcpy(columnAt(world, destination, destinationChunk, component, moved.row),
+                   columnAt(world, source, sourceChunk, component, record.row), world.components[component].size);
+        }
+    }
+    removeRow(world, record.archetype, record.chunk, record.row);
+}
+
+void ecsAddComponent(State *state, Entity entity, ComponentId component) {
+    EXPECT(!ecsAlive(state, entity), "Entity %u is not alive", entity.index);
+    const EntityRecord &record = state->world.entities[entity.index];
+    moveEntity(state, entity, state->world.archetypes[record.archetype].mask | 1ull << component);
+}
+
+void ecsRemoveComponent(State *state, Entity entity, ComponentId component) {
+    EXPECT(!ecsAlive(state, entity), "Entity %u is not alive", entity.index);
+    const EntityRecord &record = state->world.entities[entity.index];
+    moveEntity(state, entity, state->world.archetypes[record.archetype].mask & ~(1ull << component));
+}
+
+void *ecsGet(State *state, Entity entity, ComponentId component) {
+    if (!ecsAlive(state, entity)) {
+        return nullptr;
+    }
+    World &world = state->world;
+    const EntityRecord &record = world.entities[entity.index];
+    const Archetype &archetype = world.archetypes[record.archetype];
+    if (!((archetype.mask >> component) & 1)) {
+        return nullptr;
+    }
+    return columnAt(world, archetype, archetype.chunks[record.chunk], component, record.row);
+}
+
+QueryId ecsQuery(State *state, ComponentMask include, ComponentMask exclude) {
+    World &world = state->world;
+    for (QueryId id = 0; id < world.queries.size(); id++) {
+        if (world.queries[id].include == include && world.queries[id].exclude == exclude) {
+            return id;
+        }
+    }
+    world.queries.push_back({.include = include, .exclude = exclude});
+    return (QueryId) world.queries.size() - 1;
+}
+
+static Query &updateQuery(World &world, QueryId id) {
+    Query &query = world.queries[id];
+    for (; query.archetypesSeen < world.archetypes.size(); query.archetypesSeen++) {
+        ComponentMask mask = world.archetypes[query.archetypesSeen].mask;
+        if ((mask & query.include) == query.include && (mask & query.exclude) == 0) {
+            query.archetypes.push_back(query.archetypesSeen);
+        }
+    }
+    return query;
+}
+
+uint32_t ecsQueryCount(State *state, QueryId id) {
+    World &world = state->world;
+    uint32_t count = 0;
+    for (uint32_t archetype : updateQuery(world, id).archetypes) {
+        count += world.archetypes[archetype].entityCount;
+    }
+    return count;
+}
+
+void ecsForEachChunk(State *state, QueryId id, const ChunkFunction &function) {
+    World &world = state->world;
+    for (uint32_t archetypeIndex : updateQuery(world, id).archetypes) {
+        const Archetype &archetype = world.archetypes[archetypeIndex];
+        for (const Chunk &chunk : archetype.chunks) {
+            function({.archetype = &archetype, .data = chunk.data, .count = chunk.count});
+        }
+    }
+}
+
+void ecsParallelForEachChunk(State *state, QueryId id, const ChunkFunction &function) {
+    World &world = state->world;
+    std::vector<ChunkView> views;
+    for (uint32_t archetypeIndex : updateQuery(world, id).archetypes) {
+        const Archetype &archetype = world.archetypes[archetypeIndex];
+        for (const Chunk &chunk : archetype.chunks) {
+            views.push_back({.archetype = &archetype, .data = chunk.data, .count = chunk.count});
+        }
+    }
+    // قطع صغيرة (16KB) فنعطي كل مهمة عدة قطع لتقليل كلفة التوزيع
+    jobsParallelFor(state, (uint32_t) views.size(), 8, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            function(views[i]);
+        }
+    });
+}
+
+struct BenchPosition {
+    float x, y, z;
+};
+
+struct BenchVelocity {
+    float x, y, z;
+};
+
+struct BenchHealth {
+    float value, regeneration;
+};
+
+// كائن لعبة تقليدي: كل شيء في هيكل واحد والتحديث يلمس جزءاً صغيراً منه
+struct BenchGameObject {
+    float transform[16];
+    BenchPosition position;
+    BenchVelocity velocity;
+    BenchHealth health;
+    uint32_t flags;
+    char name[32];
+    void *userData;
+};
+
+constexpr uint32_t BENCH_HAS_HEALTH = 1;
+
+void runEcsBenchmark(State *state) {
+    constexpr uint32_t entityCount = 1000000;
+    constexpr uint32_t iterations = 20;
+    constexpr float dt = 1.0f / 60.0f;
+
+    std::vector<BenchGameObject> objects(entityCount);
+    for (uint32_t i = 0; i < entityCount; i++) {
+        objects[i].velocity = {(float) (i % 7), 1.0f, 0.5f};
+        objects[i].flags = (i % 2) ? BENCH_HAS_HEALTH : 0;
+        objects[i].health = {100.0f, 0.1f};
+    }
+
+    ComponentId position = ecsComponent<BenchPosition>(state, "Position");
+    ComponentId velocity = ecsComponent<BenchVelocity>(state, "Velocity");
+    ComponentId health = ecsComponent<BenchHealth>(state, "Health");
+    ComponentMask moving = ecsMask({position, velocity});
+    for (uint32_t i = 0; i < entityCount; i++) {
+        Entity entity = ecsCreateEntity(state, (i % 2) ? moving | ecsMask({health}) : moving);
+        *ecsGet<BenchVelocity>(state, entity, velocity) = objects[i].velocity;
+        if (i % 2) {
+            *ecsGet<BenchHealth>(state, entity, health) = objects[i].health;
+        }
+    }
+    QueryId movementQuery = ecsQuery(state, moving);
+    QueryId healthQuery = ecsQuery(state, ecsMask({health}));
+
+    auto movement = [&](const ChunkView &chunk) {
+        BenchPosition *positions = chunk.column<BenchPosition>(position);
+        const BenchVelocity *velocities = chunk.column<BenchVelocity>(velocity);
+        for (uint32_t i = 0; i < chunk.count; i++) {
+            positions[i].x += velocities[i].x * dt;
+            positions[i].y += velocities[i].y * dt;
+            positions[i].z += velocities[i].z * dt;
+        }
+    };
+    auto regeneration = [&](const ChunkView &chunk) {
+        BenchHealth *healths = chunk.column<BenchHealth>(health);
+        for (uint32_t i = 0; i < chunk.count; i++) {
+            healths[i].value = std::min(100.0f, healths[i].value + healths[i].regeneration * dt);
+        }
+    };
+
+    auto measure = [&](const char *name, const std::function<void()> &update) {
+        update();
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            update();
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printf("ECS benchmark: %-14s %8.3f ms per update\n", name, ms / iterations);
+        return ms;
+    };
+
+    double aos = measure("AoS", [&] {
+        for (BenchGameObject &object : objects) {
+            object.position.x += object.velocity.x * dt;
+            object.position.y += object.velocity.y * dt;
+            object.position.z += object.velocity.z * dt;
+            if (object.flags & BENCH_HAS_HEALTH) {
+                object.health.value = std::min(100.0f, object.health.value + object.health.regeneration * dt);
+            }
+        }
+    });
+    double serial = measure("ECS", [&] {
+        ecsForEachChunk(state, movementQuery, movement);
+        ecsForEachChunk(state, healthQuery, regeneration);
+    });
+    double parallel = measure("ECS parallel", [&] {
+        ecsParallelForEachChunk(state, movementQuery, movement);
+        ecsParallelForEachChunk(state, healthQuery, regeneration);
+    });
+
+    double checksum = 0;
+    ecsForEachChunk(state, movementQuery, [&](const ChunkView &chunk) {
+        checksum += chunk.column<BenchPosition>(position)[0].x;
+    });
+    for (const BenchGameObject &object : objects) {
+        checksum += object.position.x * 1e-9;
+    }
+    printf("ECS benchmark: %u entities, %zu archetypes, %u workers, speedup %.2fx serial, %.2fx parallel "
+           "(checksum %.3f)\n", state->world.aliveCount, state->world.archetypes.size(), jobWorkerCount(state),
+           aos / serial, aos / parallel, checksum);
+    destroyWorld(state);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+struct State;
+
+constexpr uint32_t ECS_MAX_COMPONENTS = 64;
+constexpr size_t ECS_CHUNK_SIZE = 16 * 1024;       // يتسع في L1/L2 بسهولة
+constexpr size_t ECS_CHUNK_ALIGNMENT = 64;
+
+typedef uint32_t ComponentId;
+typedef uint64_t ComponentMask;
+
+// مقبض بجيل: المقبض القديم لكيان محذوف لا يطابق الكيان الجديد في نفس الفهرس
+struct Entity {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+struct ComponentInfo {
+    const char *name;
+    uint32_t size;
+    uint32_t alignment;
+};
+
+// المكونات في أعمدة متجاورة داخل القطعة، والكيانات في عمود أول
+struct Chunk {
+    uint8_t *data = nullptr;
+    uint32_t count = 0;
+};
+
+struct Archetype {
+    ComponentMask mask = 0;
+    uint32_t capacity = 0;                          // صفوف في كل قطعة
+    uint32_t columnOffsets[ECS_MAX_COMPONENTS];     // بالبايت داخل القطعة، صالحة فقط للمكونات في mask
+    std::vector<Chunk> chunks;
+    uint32_t entityCount = 0;
+};
+
+struct EntityRecord {
+    uint32_t generation = 0;
+    uint32_t archetype = 0;
+    uint32_t chunk = 0;
+    uint32_t row = 0;
+    bool alive = false;
+};
+
+// استعلام مخزن: قائمة الأنماط المطابقة تُحدَّث فقط بالأنماط الجديدة منذ آخر استخدام
+struct Query {
+    ComponentMask include = 0;
+    ComponentMask exclude = 0;
+    std::vector<uint32_t> archetypes;
+    uint32_t archetypesSeen = 0;
+};
+
+typedef uint32_t QueryId;
+
+struct World {
+    std::vector<ComponentInfo> components;
+    std::unordered_map<std::type_index, ComponentId> componentIds;
+    std::vector<Archetype> archetypes;
+    std::unordered_map<ComponentMask, uint32_t> archetypeIndex;
+    std::vector<EntityRecord> entities;
+    std::vector<uint32_t> freeEntities;
+    std::vector<Query> queries;
+    uint32_t aliveCount = 0;
+};
+
+// ما تراه دالة التكرار: قطعة واحدة بكل أعمدتها
+struct ChunkView {
+    const Archetype *archetype;
+    uint8_t *data;
+    uint32_t count;
+
+    const Entity *entities() const {
+        return reinterpret_cast<const Entity *>(data);
+    }
+    template<typename T>
+    T *column(ComponentId component) const {
+        return reinterpret_cast<T *>(data + archetype->columnOffsets[component]);
+    }
+    bool has(ComponentId component) const {
+        return (archetype->mask >> component) & 1;
+    }
+};
+
+typedef std::function<void(const ChunkView &chunk)> ChunkFunction;
+
+void destroyWorld(State *state);
+
+ComponentId ecsRegisterComponent(State *state, const std::type_index &type, const char *name, uint32_t size,
+                                 uint32_t alignment);
+
+// المكونات تُنقل بين القطع بـ memcpy، لذا يجب أن تكون قابلة للنسخ البسيط
+template<typename T>
+ComponentId ecsComponent(State *state, const char *name = nullptr) {
+    static_assert(std::is_trivially_copyable<T>::value, "ECS components must be trivially copyable");
+    return ecsRegisterComponent(state, std::type_index(typeid(T)), name ? name : typeid(T).name(), sizeof(T),
+                                alignof(T));
+}
+
+inline ComponentMask ecsMask(std::initializer_list<ComponentId> components) {
+    ComponentMask mask = 0;
+    for (ComponentId component : components) {
+        mask |= 1ull << component;
+    }
+    return mask;
+}
+
+// المكونات الجديدة تبدأ بأصفار
+Entity ecsCreateEntity(State *state, ComponentMask mask);
+void ecsDestroyEntity(State *state, Entity entity);
+bool ecsAlive(State *state, Entity entity);
+void ecsAddComponent(State *state, Entity entity, ComponentId component);
+void ecsRemoveComponent(State *state, Entity entity, ComponentId component);
+void *ecsGet(State *state, Entity entity, ComponentId component);
+
+template<typename T>
+T *ecsGet(State *state, Entity entity, ComponentId component) {
+    return static_cast<T *>(ecsGet(state, entity, component));
+}
+
+QueryId ecsQuery(State *state, ComponentMask include, ComponentMask exclude = 0);
+uint32_t ecsQueryCount(State *state, QueryId query);
+
+// لا يُسمح بتغيير البنية (إنشاء، حذف، إضافة أو إزالة مكون) أثناء التكرار
+void ecsForEachChunk(State *state, QueryId query, const ChunkFunction &function);
+// كل قطعة مهمة مستقلة على نظام المهام
+void ecsParallelForEachChunk(State *state, QueryId query, const ChunkFunction &function);
+
+// --bench ecs: مقارنة مع مصفوفة هياكل عند مليون كيان
+void runEcsBenchmark(State *state);
@@ -0,0 +1,164 @@
+#include "frame.h"
+#include "state.h"
+
+#include <algorithm>
+
+void createFrameResources(State *state) {
+    for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; i++) {
+        FrameResources &frame = state->frames[i];
+
+        VkCommandPoolCreateInfo poolInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = state->graphicsTimeline.familyIndex,
+        };
+        VkResult result = vkCreateCommandPool(state->device, &poolInfo, state->allocator, &frame.commandPool);
+        EXPECT(result != VK_SUCCESS, "Failed to create frame command pool %u", i);
+
+        VkCommandBufferAllocateInfo allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = frame.commandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        result = vkAllocateCommandBuffers(state->device, &allocateInfo, &frame.commandBuffer);
+        EXPECT(result != VK_SUCCESS, "Failed to allocate frame command buffer %u", i);
+
+        VkSemaphoreCreateInfo semaphoreInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        };
+        result = vkCreateSemaphore(state->device, &semaphoreInfo, state->allocator, &frame.imageAcquired);
+        EXPECT(result != VK_SUCCESS, "Failed to create image acquired semaphore %u", i);
+    }
+}
+
+void destroyFrameResources(State *state) {
+    for (FrameResources &frame : state->frames) {
+        deferDestroy(state, frame.commandPool);
+        deferDestroy(state, frame.imageAcquired);
+        frame = {};
+    }
+    for (VkSemaphore semaphore : state->presentSemaphores) {
+        deferDestroy(state, semaphore);
+    }
+    state->presentSemaphores.clear();
+}
+
+void createPresentSemaphores(State *state) {
+    // semaphore لكل صورة بدل كل إطار: لا يُعاد استخدامه إلا بعد أن يُعيد العرض نفس الصورة
+    for (VkSemaphore semaphore : state->presentSemaphores) {
+        deferDestroy(state, semaphore);
+    }
+    state->presentSemaphores.resize(state->swapchainImageCount);
+    for (uint32_t i = 0; i < state->swapchainImageCount; i++) {
+        VkSemaphoreCreateInfo semaphoreInfo{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        };
+        VkResult result = vkCreateSemaphore(state->device, &semaphoreInfo, state->allocator,
+                                            &state->presentSemaphores[i]);
+        EXPECT(result != VK_SUCCESS, "Failed to create present semaphore %u", i);
+    }
+}
+
+void frameWaitFor(State *state, const TimelineQueue *timeline, uint64_t value, VkPipelineStageFlags2 stageMask) {
+    for (uint32_t i = 0; i < state->frameWaitCount; i++) {
+        TimelineWait &wait = state->frameWaits[i];
+        if (wait.timeline == timeline) {
+            wait.value = std::max(wait.value, value);
+            wait.stageMask |= stageMask;
+            return;
+        }
+    }
+    EXPECT(state->frameWaitCount == MAX_TIMELINE_WAITS - 1, "Too many frame waits");
+    state->frameWaits[state->frameWaitCount++] = {
+        .timeline = timeline,
+        .value = value,
+        .stageMask = stageMask,
+    };
+}
+
+FrameResources &currentFrame(State *state) {
+    return state->frames[state->frameNumber % FRAMES_IN_FLIGHT];
+}
+
+bool beginFrame(State *state) {
+    uint64_t frameNumber = state->frameNumber + 1;
+    FrameResources &frame = state->frames[frameNumber % FRAMES_IN_FLIGHT];
+
+    // الانتظار على الـ CPU فقط للإطار الذي استخدم هذه الفتحة قبل FRAMES_IN_FLIGHT إطار
+    timelineWait(state, &state->graphicsTimeline, frame.timelineValue);
+    deletionQueueFlush(state, state->graphicsTimeline.completedValue);
+    bindlessCollect(state);
+    resetFrameDescriptors(state, frameNumber % FRAMES_IN_FLIGHT);
+
+    VkResult result = vkAcquireNextImageKHR(state->device, state->swapchain, UINT64_MAX, frame.imageAcquired,
+                                            VK_NULL_HANDLE, &state->imageIndex);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        state->recreateSwapChain = true;
+        return false;
+    }
+    EXPECT(result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR, "Failed to acquire swapchain image");
+
+    state->frameNumber = frameNumber;
+    frame.frameNumber = frameNumber;
+    resetUniformRing(state, frameNumber % FRAMES_IN_FLIGHT);
+    frame.timelineValue = 0;
+
+    result = vkResetCommandPool(state->device, frame.commandPool, 0);
+    EXPECT(result != VK_SUCCESS, "Failed to reset frame command pool");
+    VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    result = vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
+    EXPECT(result != VK_SUCCESS, "Failed to begin frame command buffer");
+    state->commandBuffer = frame.commandBuffer;
+    return true;
+}
+
+void endFrame(State *state) {
+    FrameResources &frame = currentFrame(state);
+    VkResult result = vkEndCommandBuffer(frame.commandBuffer);
+    EXPECT(result != VK_SUCCESS, "Failed to end frame command buffer");
+
+    VkSemaphore presentSemaphore = state->presentSemaphores[state->imageIndex];
+    TimelineSubmit submit{
+        .commandBuffers = &frame.commandBuffer,
+        .commandBufferCount = 1,
+        .waits = state->frameWaits,
+        .waitCount = state->frameWaitCount,
+        .binaryWait = frame.imageAcquired,
+        .binaryWaitStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+        .binarySignal = presentSemaphore,
+    };
+    frame.timelineValue = timelineSubmit(&state->graphicsTimeline, submit);
+    state->frameWaitCount = 0;
+    state->commandBuffer = VK_NULL_HANDLE;
+
+    VkPresentInfoKHR presentInfo{
+        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &presentSemaphore,
+        .swapchainCount = 1,
+        .pSwapchains = &state->swapchain,
+        .pImageIndices = &state->imageIndex,
+    };
+    result = vkQueuePresentKHR(state->graphicsTimeline.queue, &presentInfo);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+        state->recreateSwapChain = true;
+    } else {
+        EXPECT(result != VK_SUCCESS, "Failed to present swapchain image");
+    }
+}
+
+bool isFrameComplete(State *state, uint64_t frameNumber) {
+    // كل إطار أقدم من FRAMES_IN_FLIGHT انتُظر بالفعل في beginFrame
+    if (frameNumber + FRAMES_IN_FLIGHT <= state->frameNumber) {
+        return true;
+    }
+    FrameResources &frame = state->frames[frameNumber % FRAMES_IN_FLIGHT];
+    if (frame.frameNumber != frameNumber || frame.timelineValue == 0) {
+        return false;
+    }
+    return timelineReached(state, &state->graphicsTimeline, frame.timelineValue);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+
+struct State;
+struct TimelineQueue;
+
+// عدد الإطارات التي قد يعمل عليها الـ GPU في نفس الوقت
+constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
+// موارد فتحة واحدة من الإطارات الجارية على الـ GPU
+struct FrameResources {
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkSemaphore imageAcquired = VK_NULL_HANDLE;     // ثنائي لأن vkAcquireNextImageKHR لا يقبل timeline
+    uint64_t frameNumber = 0;
+    uint64_t timelineValue = 0;                     // 0 يعني أن الإطار لم يُرسل بعد
+};
+
+void createFrameResources(State *state);
+void destroyFrameResources(State *state);
+void createPresentSemaphores(State *state);
+
+// تعيد false إذا يجب إعادة إنشاء الـ Swapchain قبل الرسم
+bool beginFrame(State *state);
+void endFrame(State *state);
+
+// اعتماد إضافي لإرسال الإطار الجاري، مثل انتظار طابور النقل
+void frameWaitFor(State *state, const TimelineQueue *timeline, uint64_t value, VkPipelineStageFlags2 stageMask);
+
+FrameResources &currentFrame(State *state);
+bool isFrameComplete(State *state, uint64_t frameNumber);
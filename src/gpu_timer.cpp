@@ -0,0 +1,84 @@
+#include "gpu_timer.h"
+#include "state.h"
+
+#include <iostream>
+#include <vector>
+
+void createGpuTimers(State *state) {
+    GpuTimers &timers = state->gpuTimers;
+    uint32_t count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(state->physicalDevice, &count, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(count);
+    vkGetPhysicalDeviceQueueFamilyProperties(state->physicalDevice, &count, queueFamilies.data());
+    uint32_t validBits = queueFamilies[state->queueFamilyIndex].timestampValidBits;
+    if (validBits == 0) {
+        std::cout << "GPU timers: graphics queue has no timestamps" << std::endl;
+        return;
+    }
+    timers.enabled = true;
+    timers.nanosecondsPerTick = state->physicalDeviceProperties.limits.timestampPeriod;
+    timers.validMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+
+    VkQueryPoolCreateInfo poolInfo{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = GPU_TIMER_COUNT * 2,
+    };
+    for (VkQueryPool &pool : timers.pools) {
+        VkResult result = vkCreateQueryPool(state->device, &poolInfo, state->allocator, &pool);
+        EXPECT(result != VK_SUCCESS, "Failed to create timestamp query pool");
+    }
+}
+
+void destroyGpuTimers(State *state) {
+    GpuTimers &timers = state->gpuTimers;
+    for (VkQueryPool pool : timers.pools) {
+        if (pool != VK_NULL_HANDLE) {
+            deferDestroy(state, pool);
+        }
+    }
+    timers = {};
+}
+
+void gpuTimersBeginFrame(State *state, VkCommandBuffer commandBuffer) {
+    GpuTimers &timers = state->gpuTimers;
+    if (!timers.enabled) {
+        return;
+    }
+    uint32_t slot = state->frameNumber % FRAMES_IN_FLIGHT;
+    if (timers.written[slot] != 0) {
+        // قيمة ثم توفر لكل استعلام؛ المقاييس التي لم تُسجَّل تحتفظ بقيمتها السابقة
+        uint64_t results[GPU_TIMER_COUNT * 2][2] = {};
+        vkGetQueryPoolResults(state->device, timers.pools[slot], 0, GPU_TIMER_COUNT * 2, sizeof(results), results,
+                              sizeof(results[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        for (uint32_t scope = 0; scope < GPU_TIMER_COUNT; scope++) {
+            const uint64_t *begin = results[scope * 2];
+            const uint64_t *end = results[scope * 2 + 1];
+            if ((timers.written[slot] >> scope & 1) && begin[1] && end[1]) {
+                uint64_t ticks = (end[0] - begin[0]) & timers.validMask;
+                timers.ms[scope] = (double) ticks * timers.nanosecondsPerTick / 1e6;
+            }
+        }
+    }
+    vkCmdResetQueryPool(commandBuffer, timers.pools[slot], 0, GPU_TIMER_COUNT * 2);
+    timers.written[slot] = 0;
+}
+
+void gpuTimerBegin(State *state, VkCommandBuffer commandBuffer, GpuTimerScope scope) {
+    GpuTimers &timers = state->gpuTimers;
+    if (!timers.enabled) {
+        return;
+    }
+    uint32_t slot = state->frameNumber % FRAMES_IN_FLIGHT;
+    vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, timers.pools[slot], scope * 2);
+}
+
+void gpuTimerEnd(State *state, VkCommandBuffer commandBuffer, GpuTimerScope scope) {
+    GpuTimers &timers = state->gpuTimers;
+    if (!timers.enabled) {
+        return;
+    }
+    uint32_t slot = state->frameNumber % FRAMES_IN_FLIGHT;
+    vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, timers.pools[slot], scope * 2 + 1);
+    timers.written[slot] |= 1u << scope;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+
+#include "frame.h"
+
+struct State;
+
+// كل مقياس زوج من الطوابع الزمنية في مجمع استعلامات الفتحة
+enum GpuTimerScope : uint32_t {
+    GPU_TIMER_FRAME,            // كل أوامر recordFrame
+    GPU_TIMER_DEPTH_PYRAMID,
+    GPU_TIMER_LIGHT_CLUSTER,
+    GPU_TIMER_POST,
+    GPU_TIMER_COUNT,
+};
+
+struct GpuTimers {
+    bool enabled = false;       // timestampValidBits == 0 في عائلة طابور الرسم يعني لا قياس
+    double nanosecondsPerTick = 0;
+    uint64_t validMask = 0;
+    VkQueryPool pools[FRAMES_IN_FLIGHT] = {};
+    uint32_t written[FRAMES_IN_FLIGHT] = {};     // بت لكل مقياس سُجّل في الفتحة
+    double ms[GPU_TIMER_COUNT] = {};            // آخر قيمة مكتملة، متأخرة بعدد الإطارات الجارية
+};
+
+void createGpuTimers(State *state);
+void destroyGpuTimers(State *state);
+
+// أول أمر في recordFrame: يقرأ نتائج آخر إطار استخدم الفتحة (انتظره beginFrame) ثم يصفّر المجمع
+void gpuTimersBeginFrame(State *state, VkCommandBuffer commandBuffer);
+void gpuTimerBegin(State *state, VkCommandBuffer commandBuffer, GpuTimerScope scope);
+void gpuTimerEnd(State *state, VkCommandBuffer commandBuffer, GpuTimerScope scope);
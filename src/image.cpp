@@ -0,0 +1,72 @@
+#include "image.h"
+#include "state.h"
+
+VkImageView createImageView(State *state, VkImage image, VkFormat format, VkImageAspectFlags aspectMask,
+                            uint32_t baseMipLevel, uint32_t levelCount) {
+    VkImageViewCreateInfo viewInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .components = {
+            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+        },
+        .subresourceRange = {
+            .aspectMask = aspectMask,
+            .baseMipLevel = baseMipLevel,
+            .levelCount = levelCount,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+    VkImageView view;
+    VkResult result = vkCreateImageView(state->device, &viewInfo, state->allocator, &view);
+    EXPECT(result != VK_SUCCESS, "Failed to create image view");
+    return view;
+}
+
+Image createImage(State *state, const VkImageCreateInfo &imageInfo, VkImageAspectFlags aspectMask,
+                  VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) {
+    Image image{
+        .format = imageInfo.format,
+        .extent = {imageInfo.extent.width, imageInfo.extent.height},
+        .mipLevels = imageInfo.mipLevels,
+    };
+
+    VkImageCreateInfo createInfo = imageInfo;
+    if (createInfo.queueFamilyIndexCount == 0) {
+        applyQueueSharing(state, &createInfo.sharingMode, &createInfo.queueFamilyIndexCount,
+                          &createInfo.pQueueFamilyIndices);
+    }
+    VkResult result = vkCreateImage(state->device, &createInfo, state->allocator, &image.image);
+    EXPECT(result != VK_SUCCESS, "Failed to create %ux%u image", imageInfo.extent.width, imageInfo.extent.height);
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(state->device, image.image, &requirements);
+    uint32_t memoryType = findMemoryType(state, requirements.memoryTypeBits, required, preferred);
+    image.memoryFlags = state->memoryProperties.memoryTypes[memoryType].propertyFlags;
+    VkMemoryAllocateInfo allocateInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = memoryType,
+    };
+    result = vkAllocateMemory(state->device, &allocateInfo, state->allocator, &image.memory);
+    EXPECT(result != VK_SUCCESS, "Failed to allocate %llu bytes of image memory",
+           (unsigned long long) requirements.size);
+    result = vkBindImageMemory(state->device, image.image, image.memory, 0);
+    EXPECT(result != VK_SUCCESS, "Failed to bind image memory");
+    image.memorySize = requirements.size;
+
+    image.view = createImageView(state, image.image, image.format, aspectMask, 0, image.mipLevels);
+    return image;
+}
+
+void destroyImage(State *state, Image *image) {
+    deferDestroy(state, image->view);
+    deferDestroy(state, image->image);
+    deferDestroy(state, image->memory);
+    *image = {};
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+
+struct State;
+
+struct Image {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent{};
+    uint32_t mipLevels = 1;
+    VkDeviceSize memorySize = 0;
+    VkMemoryPropertyFlags memoryFlags = 0;
+};
+
+Image createImage(State *state, const VkImageCreateInfo &imageInfo, VkImageAspectFlags aspectMask,
+                  VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0);
+void destroyImage(State *state, Image *image);
+
+VkImageView createImageView(State *state, VkImage image, VkFormat format, VkImageAspectFlags aspectMask,
+                            uint32_t baseMipLevel, uint32_t levelCount);
@@ -0,0 +1,91 @@
+#include "jobs.h"
+#include "state.h"
+
+#include <algorithm>
+#include <iostream>
+
+static void runBatch(JobBatch &batch) {
+    while (true) {
+        uint32_t begin = batch.next.fetch_add(batch.grain, std::memory_order_relaxed);
+        if (begin >= batch.count) {
+            return;
+        }
+        (*batch.function)(begin, std::min(begin + batch.grain, batch.count));
+    }
+}
+
+static void workerMain(JobSystem *jobs) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(jobs->mutex);
+            jobs->wake.wait(lock, [&] { return jobs->stopping || jobs->generation != seenGeneration; });
+            if (jobs->stopping) {
+                return;
+            }
+            seenGeneration = jobs->generation;
+        }
+        runBatch(jobs->batch);
+        if (jobs->batch.activeWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(jobs->mutex);
+            jobs->finished.notify_one();
+        }
+    }
+}
+
+void createJobSystem(State *state) {
+    JobSystem &jobs = state->jobs;
+    // الخيط الرئيسي يعمل أيضاً، ونترك نواة لخيوط الكتابة والنظام؛ عامل واحد على الأقل
+    uint32_t hardwareThreads = std::max(3u, std::thread::hardware_concurrency());
+    uint32_t workerCount = hardwareThreads - 2;
+    for (uint32_t i = 0; i < workerCount; i++) {
+        jobs.workers.emplace_back(workerMain, &jobs);
+    }
+    std::cout << "Job system: " << workerCount << " workers" << std::endl;
+}
+
+void destroyJobSystem(State *state) {
+    JobSystem &jobs = state->jobs;
+    {
+        std::lock_guard<std::mutex> lock(jobs.mutex);
+        jobs.stopping = true;
+    }
+    jobs.wake.notify_all();
+    for (std::thread &worker : jobs.workers) {
+        worker.join();
+    }
+    jobs.workers.clear();
+}
+
+uint32_t jobWorkerCount(State *state) {
+    return (uint32_t) state->jobs.workers.size();
+}
+
+void jobsParallelFor(State *state, uint32_t count, uint32_t grain, const JobRange &function) {
+    JobSystem &jobs = state->jobs;
+    grain = std::max(grain, 1u);
+    // عمل صغير أو بدون عمال: لا فائدة من إيقاظ الخيوط
+    if (jobs.workers.empty() || count <= grain) {
+        if (count > 0) {
+            function(0, count);
+        }
+        return;
+    }
+
+    JobBatch &batch = jobs.batch;
+    {
+        std::lock_guard<std::mutex> lock(jobs.mutex);
+        batch.function = &function;
+        batch.count = count;
+        batch.grain = grain;
+        batch.next.store(0, std::memory_order_relaxed);
+        batch.activeWorkers.store((uint32_t) jobs.workers.size(), std::memory_order_relaxed);
+        jobs.generation++;
+    }
+    jobs.wake.notify_all();
+
+    runBatch(batch);
+
+    std::unique_lock<std::mutex> lock(jobs.mutex);
+    jobs.finished.wait(lock, [&] { return batch.activeWorkers.load(std::memory_order_acquire) == 0; });
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct State;
+
+typedef std::function<void(uint32_t begin, uint32_t end)> JobRange;
+
+// دفعة واحدة في كل مرة: يوزَّع المدى على العمال بعداد ذري ويشارك المستدعي في العمل
+struct JobBatch {
+    const JobRange *function = nullptr;
+    uint32_t count = 0;
+    uint32_t grain = 1;
+    std::atomic<uint32_t> next{0};
+    std::atomic<uint32_t> activeWorkers{0};
+};
+
+struct JobSystem {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    JobBatch batch;
+    uint64_t generation = 0;        // يزيد مع كل دفعة ليعرف العامل أن هناك عملاً جديداً
+    bool stopping = false;
+};
+
+void createJobSystem(State *state);
+void destroyJobSystem(State *state);
+
+uint32_t jobWorkerCount(State *state);
+
+// ينفّذ function على [0, count) بقطع حجمها grain ويعود بعد انتهاء كل القطع؛ من الخيط الرئيسي فقط
+void jobsParallelFor(State *state, uint32_t count, uint32_t grain, const JobRange &function);
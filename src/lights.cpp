@@ -0,0 +1,327 @@
+#include "lights.h"
+#include "descriptors.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// يجب أن تطابق shaders/lights.glsl و light_cluster.comp و scene.frag
+enum LightsBinding : uint32_t {
+    LIGHTS_BINDING_LIGHTS,
+    LIGHTS_BINDING_CLUSTERS,
+    LIGHTS_BINDING_INDICES,
+    LIGHTS_BINDING_COUNTERS,
+    LIGHTS_BINDING_VIEW,
+    LIGHTS_BINDING_BOUNDS,
+    LIGHTS_BINDING_TOTAL,
+};
+
+// يطابق LightsView (std140) في shaders/lights.glsl
+struct LightsViewUniforms {
+    float view[16];
+    float projection[4];        // P00، P11 موجب، near
+    float grid[4];              // froxels لكل بكسل، ومقياس وإزاحة الشريحة على log(العمق)
+    uint32_t counts[4];         // عدد الأضواء، سعة مخزن الفهارس
+};
+
+void createLights(State *state) {
+    Lights &lights = state->lights;
+    lights.clusters = createBuffer(state, (VkDeviceSize) LIGHT_CLUSTER_COUNT * 2 * sizeof(uint32_t),
+                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    lights.indices = createBuffer(state, (VkDeviceSize) LIGHT_MAX_INDICES * sizeof(uint32_t),
+                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    for (LightsFrame &frame : lights.frames) {
+        // تُكتب كاملة كل إطار وتُقرأ مرة في الـ GPU، فلا فائدة من نسخها إلى ذاكرة الجهاز
+        frame.lights = createBuffer(state, (VkDeviceSize) LIGHT_MAX_LIGHTS * sizeof(Light),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        frame.bounds = createBuffer(state, (VkDeviceSize) LIGHT_MAX_LIGHTS * 4 * sizeof(float),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        frame.counters = createBuffer(state, sizeof(LightCounters),
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        memset(frame.counters.mapped, 0, sizeof(LightCounters));
+        flushBuffer(state, frame.counters, 0, sizeof(LightCounters));
+    }
+
+    VkDescriptorSetLayoutBinding bindings[LIGHTS_BINDING_TOTAL];
+    for (uint32_t i = 0; i < LIGHTS_BINDING_TOTAL; i++) {
+        bindings[i] = {
+            .binding = i,
+            .descriptorType = i == LIGHTS_BINDING_VIEW ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+                                                       : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        };
+    }
+    lights.setLayout = getDescriptorSetLayout(state, bindings, LIGHTS_BINDING_TOTAL);
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &lights.setLayout,
+    };
+    VkResult result = vkCreatePipelineLayout(state->device, &pipelineLayoutInfo, state->allocator,
+                                             &lights.pipelineLayout);
+    EXPECT(result != VK_SUCCESS, "Failed to create light cluster pipeline layout");
+    VkComputePipelineCreateInfo computeInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = getShaderModule(state, "light_cluster.comp"),
+            .pName = "main",
+        },
+        .layout = lights.pipelineLayout,
+    };
+    result = vkCreateComputePipelines(state->device, state->pipelines.cache, 1, &computeInfo, state->allocator,
+                                      &lights.clusterPipeline);
+    EXPECT(result != VK_SUCCESS, "Failed to create light cluster pipeline");
+    lights.enabled = true;
+    std::cout << "Clustered lights: " << LIGHT_CLUSTERS_X << "x" << LIGHT_CLUSTERS_Y << "x" << LIGHT_CLUSTERS_Z
+              << " froxels, " << LIGHT_MAX_LIGHTS << " lights max" << std::endl;
+}
+
+void destroyLights(State *state) {
+    Lights &lights = state->lights;
+    destroyBuffer(state, &lights.clusters);
+    destroyBuffer(state, &lights.indices);
+    for (LightsFrame &frame : lights.frames) {
+        destroyBuffer(state, &frame.lights);
+        destroyBuffer(state, &frame.bounds);
+        destroyBuffer(state, &frame.counters);
+    }
+    if (lights.clusterPipeline != VK_NULL_HANDLE) {
+        deferDestroy(state, lights.clusterPipeline);
+    }
+    if (lights.pipelineLayout != VK_NULL_HANDLE) {
+        deferDestroy(state, lights.pipelineLayout);
+    }
+    lights = {};
+}
+
+LightId lightAdd(State *state, const Light &light) {
+    Lights &lights = state->lights;
+    EXPECT(lights.lightData.size() >= LIGHT_MAX_LIGHTS, "Light buffer is full");
+    lights.lightData.push_back(light);
+    return (LightId) lights.lightData.size() - 1;
+}
+
+void lightUpdate(State *state, LightId id, const Light &light) {
+    Lights &lights = state->lights;
+    EXPECT(id >= lights.lightData.size(), "Unknown light %u", id);
+    lights.lightData[id] = light;
+}
+
+void lightClear(State *state) {
+    state->lights.lightData.clear();
+}
+
+// كرة تحيط بمدى الضوء؛ للـ spot الضيق كرة المخروط أصغر بكثير من كرة range
+static void lightBounds(const Light &light, float *center, float *radius) {
+    memcpy(center, light.position, sizeof(light.position));
+    *radius = light.range;
+    if (light.type != LIGHT_SPOT || light.cosOuter <= 0) {
+        return;
+    }
+    float distance;
+    if (light.cosOuter >= 0.70710678f) {
+        // أقل من 45 درجة: الكرة المارة بالرأس وحافة القاعدة
+        distance = light.range / (2.0f * light.cosOuter);
+        *radius = distance;
+    } else {
+        distance = light.range * light.cosOuter;
+        *radius = light.range * sqrtf(1.0f - light.cosOuter * light.cosOuter);
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+        center[i] += light.direction[i] * distance;
+    }
+}
+
+void lightsCluster(State *state, VkCommandBuffer commandBuffer) {
+    Lights &lights = state->lights;
+    Scene &scene = state->scene;
+    lights.set = VK_NULL_HANDLE;
+    if (!lights.enabled || scene.set == VK_NULL_HANDLE) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    LightsFrame &frame = lights.frames[state->frameNumber % FRAMES_IN_FLIGHT];
+
+    // beginFrame انتظر هذه الفتحة، فالعدادات من آخر إطار استخدمها جاهزة للقراءة
+    invalidateBuffer(state, frame.counters, 0, sizeof(LightCounters));
+    memcpy(&lights.stats.counters, frame.counters.mapped, sizeof(LightCounters));
+    uint32_t count = (uint32_t) lights.lightData.size();
+    lights.stats.lights = count;
+
+    // الكرات إلى فضاء الكاميرا هنا مرة لكل ضوء، بدل مرة لكل froxel في الـ shader
+    float *bounds = static_cast<float *>(frame.bounds.mapped);
+    const float *view = scene.view;
+    for (uint32_t i = 0; i < count; i++) {
+        float center[3];
+        float radius;
+        lightBounds(lights.lightData[i], center, &radius);
+        for (uint32_t row = 0; row < 3; row++) {
+            bounds[i * 4 + row] = view[row] * center[0] + view[4 + row] * center[1] + view[8 + row] * center[2] +
+                                  view[12 + row];
+        }
+        bounds[i * 4 + 3] = radius;
+    }
+    if (count > 0) {
+        memcpy(frame.lights.mapped, lights.lightData.data(), count * sizeof(Light));
+        flushBuffer(state, frame.lights, 0, count * sizeof(Light));
+        flushBuffer(state, frame.bounds, 0, count * 4 * sizeof(float));
+    }
+
+    gpuTimerBegin(state, commandBuffer, GPU_TIMER_LIGHT_CLUSTER);
+    vkCmdFillBuffer(commandBuffer, frame.counters.buffer, 0, sizeof(LightCounters), 0);
+    // القوائم مشتركة بين الإطارات: الإطار السابق ما زال قد يقرؤها في الـ fragment shader
+    VkMemoryBarrier2 before{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+    };
+    VkDependencyInfo dependency{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &before,
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &dependency);
+
+    VkExtent2D extent = state->renderTargets.renderExtent;
+    float nearPlane = scene.camera.nearPlane;
+    float sliceScale = (float) LIGHT_CLUSTERS_Z / logf(LIGHT_CLUSTER_FAR / nearPlane);
+    LightsViewUniforms uniforms{
+        .projection = {scene.projection[0], -scene.projection[5], nearPlane, 0},
+        .grid = {(float) LIGHT_CLUSTERS_X / (float) extent.width, (float) LIGHT_CLUSTERS_Y / (float) extent.height,
+                 sliceScale, -logf(nearPlane) * sliceScale},
+        .counts = {count, LIGHT_MAX_INDICES, 0, 0},
+    };
+    memcpy(uniforms.view, view, sizeof(uniforms.view));
+    UniformAllocation allocation = uniformRingPush(state, state->uniformRing, uniforms);
+
+    lights.set = allocateFrameDescriptorSet(state, lights.setLayout);
+    VkDescriptorBufferInfo bufferInfos[LIGHTS_BINDING_TOTAL] = {
+        {frame.lights.buffer, 0, VK_WHOLE_SIZE},
+        {lights.clusters.buffer, 0, VK_WHOLE_SIZE},
+        {lights.indices.buffer, 0, VK_WHOLE_SIZE},
+        {frame.counters.buffer, 0, VK_WHOLE_SIZE},
+        {allocation.buffer, allocation.offset, sizeof(LightsViewUniforms)},
+        {frame.bounds.buffer, 0, VK_WHOLE_SIZE},
+    };
+    VkWriteDescriptorSet writes[LIGHTS_BINDING_TOTAL];
+    for (uint32_t i = 0; i < LIGHTS_BINDING_TOTAL; i++) {
+        writes[i] = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = lights.set,
+            .dstBinding = i,
+            .descriptorCount = 1,
+            .descriptorType = i == LIGHTS_BINDING_VIEW ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+                                                       : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &bufferInfos[i],
+        };
+    }
+    vkUpdateDescriptorSets(state->device, LIGHTS_BINDING_TOTAL, writes, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lights.clusterPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lights.pipelineLayout, 0, 1, &lights.set,
+                            0, nullptr);
+    vkCmdDispatch(commandBuffer, LIGHT_CLUSTERS_X, LIGHT_CLUSTERS_Y, LIGHT_CLUSTERS_Z);
+
+    VkMemoryBarrier2 after{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+    };
+    dependency.pMemoryBarriers = &after;
+    vkCmdPipelineBarrier2(commandBuffer, &dependency);
+    gpuTimerEnd(state, commandBuffer, GPU_TIMER_LIGHT_CLUSTER);
+    lights.stats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// نصفها نقطية ونصفها spot للأسفل، تدور حول مواضع ثابتة فوق الشبكة
+static Light benchmarkLight(uint32_t index, float time) {
+    uint32_t seed = index * 2654435761u + 1;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float) (seed >> 8) / 16777216.0f;
+    };
+    float baseX = (next() - 0.5f) * 240.0f;
+    float baseZ = (next() - 0.5f) * 240.0f;
+    float phase = next() * 6.2831853f;
+    Light light{
+        .position = {baseX + 3.0f * cosf(time + phase), 2.0f + 4.0f * next(), baseZ + 3.0f * sinf(time + phase)},
+        .range = 6.0f + 8.0f * next(),
+        .color = {20.0f * next(), 20.0f * next(), 20.0f * next()},
+        .type = index % 2 ? LIGHT_SPOT : LIGHT_POINT,
+        .direction = {0, -1, 0},
+        .cosOuter = 0.819f,     // 35 درجة
+        .cosInner = 0.906f,     // 25 درجة
+    };
+    return light;
+}
+
+void lightBenchmarkFrame(State *state) {
+    constexpr uint32_t lightCounts[] = {64, 256, 1024, 4096, LIGHT_MAX_LIGHTS};
+    constexpr uint32_t stepCount = sizeof(lightCounts) / sizeof(lightCounts[0]);
+    Lights &lights = state->lights;
+    Scene &scene = state->scene;
+    if (!lights.enabled || !scene.enabled) {
+        return;
+    }
+    if (scene.instanceData.empty()) {
+        sceneBenchmarkGrid(state, 3.0f);
+        lights.benchmarkStart = std::chrono::steady_clock::now();
+    }
+    scene.camera.position[0] = 0;
+    scene.camera.position[1] = 40.0f;
+    scene.camera.position[2] = 130.0f;
+    scene.camera.target[0] = 0;
+    scene.camera.target[1] = 0;
+    scene.camera.target[2] = 0;
+
+    uint32_t count = lightCounts[lights.benchmarkStep];
+    lights.benchmarkTime += 1.0f / 60.0f;
+    if (lights.lightData.size() != count) {
+        lightClear(state);
+        for (uint32_t i = 0; i < count; i++) {
+            lightAdd(state, benchmarkLight(i, lights.benchmarkTime));
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        lightUpdate(state, i, benchmarkLight(i, lights.benchmarkTime));
+    }
+
+    // القياسات متأخرة بعدد الإطارات الجارية، فأول إطارات بعد تغيير العدد تخص العدد السابق
+    if (lights.benchmarkFrames > FRAMES_IN_FLIGHT) {
+        lights.benchmarkGpuMs += state->gpuTimers.ms[GPU_TIMER_FRAME];
+        lights.benchmarkClusterMs += state->gpuTimers.ms[GPU_TIMER_LIGHT_CLUSTER];
+        lights.benchmarkSamples++;
+    }
+    lights.benchmarkFrames++;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - lights.benchmarkStart).count();
+    if (elapsed < 2.0 || lights.benchmarkSamples == 0) {
+        return;
+    }
+    const LightCounters &counters = lights.stats.counters;
+    printf("Lights: %u, binning %.3f ms GPU, frame %.3f ms GPU, %.1f lights per active froxel (max %u), "
+           "%u of %u froxels lit, %u overflowed, %.3f ms CPU\n",
+           count, lights.benchmarkClusterMs / lights.benchmarkSamples, lights.benchmarkGpuMs / lights.benchmarkSamples,
+           counters.activeClusters ? (double) counters.indexCount / counters.activeClusters : 0.0,
+           counters.maxPerCluster, counters.activeClusters, LIGHT_CLUSTER_COUNT, counters.overflow,
+           lights.stats.cpuMs);
+    lights.benchmarkStep = (lights.benchmarkStep + 1) % stepCount;
+    lights.benchmarkStart = std::chrono::steady_clock::now();
+    lights.benchmarkFrames = 0;
+    lights.benchmarkGpuMs = 0;
+    lights.benchmarkClusterMs = 0;
+    lights.benchmarkSamples = 0;
+}
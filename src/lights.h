@@ -0,0 +1,101 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "buffer.h"
+#include "frame.h"
+
+struct State;
+
+// شبكة froxels ثابتة العدد: 16x9 مربعاً على الشاشة مهما كان حجمها، و 24 شريحة عمق أُسّية
+constexpr uint32_t LIGHT_CLUSTERS_X = 16;               // يطابق shaders/lights.glsl
+constexpr uint32_t LIGHT_CLUSTERS_Y = 9;
+constexpr uint32_t LIGHT_CLUSTERS_Z = 24;
+constexpr uint32_t LIGHT_CLUSTER_COUNT = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z;
+constexpr float LIGHT_CLUSTER_FAR = 1000.0f;            // ما بعده في آخر شريحة
+constexpr uint32_t LIGHT_MAX_LIGHTS = 1u << 14;
+constexpr uint32_t LIGHT_MAX_PER_CLUSTER = 256;         // يطابق light_cluster.comp
+constexpr uint32_t LIGHT_MAX_INDICES = LIGHT_CLUSTER_COUNT * 128;
+
+typedef uint32_t LightId;
+
+enum LightType : uint32_t {
+    LIGHT_POINT,
+    LIGHT_SPOT,
+};
+
+// يطابق Light في shaders/lights.glsl
+struct Light {
+    float position[3];
+    float range;                // الإضاءة تنعدم عنده تماماً، فهو نصف قطر الكرة في التصنيف
+    float color[3];             // خطي، مضروب في الشدة
+    uint32_t type;
+    float direction[3];         // للـ spot فقط، مطبّع
+    float cosOuter;
+    float cosInner;
+    uint32_t reserved[3];
+};
+
+static_assert(sizeof(Light) == 64, "Light layout");
+
+// يطابق LightCounters في light_cluster.comp
+struct LightCounters {
+    uint32_t indexCount;
+    uint32_t activeClusters;
+    uint32_t overflow;          // froxels تجاوزت LIGHT_MAX_PER_CLUSTER أو لم يتسع لها مخزن الفهارس
+    uint32_t maxPerCluster;
+};
+
+struct LightsFrame {
+    Buffer lights;              // نسخة كاملة كل إطار؛ الأضواء ديناميكية
+    Buffer bounds;              // كرة محيطة بفضاء الكاميرا لكل ضوء، يحسبها المعالج
+    Buffer counters;            // LightCounters؛ مرئي للمضيف ليُقرأ حين تعود الفتحة
+};
+
+struct LightsStats {
+    uint32_t lights = 0;
+    LightCounters counters{};   // من آخر إطار اكتمل في هذه الفتحة
+    double cpuMs = 0;
+};
+
+struct Lights {
+    bool enabled = false;
+    std::vector<Light> lightData;
+
+    // قائمة مضغوطة: لكل froxel إزاحة وعدد في مخزن فهارس واحد
+    Buffer clusters;
+    Buffer indices;
+    LightsFrame frames[FRAMES_IN_FLIGHT];
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;       // يملكه كاش التخطيطات
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline clusterPipeline = VK_NULL_HANDLE;
+    VkDescriptorSet set = VK_NULL_HANDLE;                   // للإطار الجاري فقط؛ set 1 في scene.frag
+    LightsStats stats;
+
+    // --bench lights
+    std::chrono::steady_clock::time_point benchmarkStart;
+    uint32_t benchmarkFrames = 0;
+    uint32_t benchmarkStep = 0;
+    float benchmarkTime = 0;
+    double benchmarkGpuMs = 0;
+    double benchmarkClusterMs = 0;
+    uint32_t benchmarkSamples = 0;
+};
+
+void createLights(State *state);
+void destroyLights(State *state);
+
+LightId lightAdd(State *state, const Light &light);
+void lightUpdate(State *state, LightId id, const Light &light);
+void lightClear(State *state);
+
+// بعد sceneCull (الذي يحسب مصفوفة العرض) وقبل أول ممر يرسم المشهد
+void lightsCluster(State *state, VkCommandBuffer commandBuffer);
+
+// --bench lights: شبكة المشهد مع عدد أضواء يتضاعف كل ثانيتين
+void lightBenchmarkFrame(State *state);
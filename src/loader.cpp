@@ -0,0 +1,346 @@
+#include "loader.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// PPM ثنائي (P6) بعمق 8 بت يُحوَّل إلى RGBA
+static bool decodePpm(const std::vector<uint8_t> &bytes, TextureDesc *desc, std::vector<uint8_t> *pixels) {
+    size_t position = 0;
+    auto token = [&](uint32_t *value) {
+        while (position < bytes.size() && (isspace(bytes[position]) || bytes[position] == '#')) {
+            if (bytes[position] == '#') {
+                while (position < bytes.size() && bytes[position] != '\n') {
+                    position++;
+                }
+            } else {
+                position++;
+            }
+        }
+        if (position >= bytes.size() || !isdigit(bytes[position])) {
+            return false;
+        }
+        *value = 0;
+        while (position < bytes.size() && isdigit(bytes[position]) && *value < 65536) {
+            *value = *value * 10 + (bytes[position++] - '0');
+        }
+        return true;
+    };
+    if (bytes.size() < 2 || bytes[0] != 'P' || bytes[1] != '6') {
+        return false;
+    }
+    position = 2;
+    uint32_t width, height, maxValue;
+    if (!token(&width) || !token(&height) || !token(&maxValue) || maxValue != 255 || width == 0 || height == 0) {
+        return false;
+    }
+    position++;     // مسافة واحدة بعد الرأس
+    size_t pixelCount = (size_t) width * height;
+    if (bytes.size() < position + pixelCount * 3) {
+        return false;
+    }
+
+    *desc = {.width = width, .height = height, .format = VK_FORMAT_R8G8B8A8_SRGB};
+    pixels->resize(pixelCount * 4);
+    const uint8_t *src = bytes.data() + position;
+    uint8_t *dst = pixels->data();
+    for (size_t i = 0; i < pixelCount; i++, src += 3, dst += 4) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+    }
+    return true;
+}
+
+static bool isBlockCompressed(VkFormat format) {
+    return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+static bool loadOnLoaderThread(State *state, AssetRequest *request) {
+    const Archive &archive = state->archive;
+    const ArchiveEntry *entry = archive.data ? archiveFind(archive, request->id) : nullptr;
+    if (!entry) {
+        return false;
+    }
+    // المدخلات غير المضغوطة تُقرأ من الذاكرة المعيّنة مباشرة بدون نسخ وسيطة
+    const uint8_t *data = static_cast<const uint8_t *>(archiveView(archive, *entry));
+    if (!data || request->type == AssetType::Blob) {
+        request->bytes.resize(entry->size);
+        if (!archiveRead(archive, *entry, request->bytes.data())) {
+            return false;
+        }
+        data = request->bytes.data();
+    }
+
+    switch (request->type) {
+        case AssetType::Blob:
+            request->blob.data = std::move(request->bytes);
+            return true;
+        case AssetType::Texture: {
+            request->payload = cookedTextureDesc(data, entry->size, &request->textureDesc);
+            if (request->payload) {
+                if (isBlockCompressed(request->textureDesc.format) && !state->textureCompressionBC) {
+                    std::cerr << "BC textures are not supported by this device" << std::endl;
+                    return false;
+                }
+                return true;
+            }
+            // الصور غير المطبوخة (PPM) تُفك هنا، وهو المسار البطيء أثناء التطوير فقط
+            if (request->bytes.empty()) {
+                request->bytes.assign(data, data + entry->size);
+            }
+            std::vector<uint8_t> pixels;
+            if (!decodePpm(request->bytes, &request->textureDesc, &pixels)) {
+                return false;
+            }
+            request->bytes = std::move(pixels);
+            request->payload = request->bytes.data();
+            return true;
+        }
+        case AssetType::Mesh: {
+            const CookedMeshHeader *header = cookedMeshHeader(data, entry->size);
+            if (!header) {
+                return false;
+            }
+            request->meshHeader = *header;
+            request->payload = data + sizeof(CookedMeshHeader);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void loaderMain(State *state) {
+    AssetLoader &loader = state->loader;
+    while (true) {
+        AssetRequest *request;
+        {
+            std::unique_lock<std::mutex> lock(loader.mutex);
+            loader.wake.wait(lock, [&] { return loader.stopping || !loader.queued.empty(); });
+            if (loader.stopping) {
+                return;
+            }
+            request = loader.queued.front();
+            loader.queued.pop_front();
+        }
+        bool decoded = !request->cancelled.load(std::memory_order_relaxed) && loadOnLoaderThread(state, request);
+        std::lock_guard<std::mutex> lock(loader.mutex);
+        request->decoded = decoded;
+        loader.decoded.push_back(request);
+    }
+}
+
+void createAssetLoader(State *state) {
+    state->loader.thread = std::thread(loaderMain, state);
+}
+
+static bool uploaded(State *state, const AssetRequest &request) {
+    return request.type == AssetType::Mesh ? meshReady(state, request.mesh) : textureReady(state, request.texture);
+}
+
+static void releaseAsset(State *state, AssetRequest *request) {
+    destroyTexture(state, &request->texture);
+    destroyMesh(state, &request->mesh);
+}
+
+static void finishRequest(AssetLoader &loader, AssetRequest *request, AssetStage stage,
+                          std::vector<std::coroutine_handle<>> *resume) {
+    request->stage = stage;
+    request->bytes = {};
+    loader.inFlight--;
+    loader.completed += stage == AssetStage::Ready;
+    resume->insert(resume->end(), request->waiters.begin(), request->waiters.end());
+    request->waiters.clear();
+}
+
+void destroyAssetLoader(State *state) {
+    AssetLoader &loader = state->loader;
+    if (loader.thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(loader.mutex);
+            loader.stopping = true;
+        }
+        loader.wake.notify_all();
+        loader.thread.join();
+    }
+
+    // المنتظرون يُستأنفون بنتيجة فارغة حتى تتحرر إطارات الكوروتينات
+    std::vector<std::coroutine_handle<>> resume;
+    resume.swap(loader.cancelledWaiters);
+    for (auto &[id, request] : loader.requests) {
+        if (request->stage < AssetStage::Ready) {
+            request->cancelled.store(true, std::memory_order_relaxed);
+            finishRequest(loader, request.get(), AssetStage::Cancelled, &resume);
+        }
+    }
+    for (std::coroutine_handle<> handle : resume) {
+        handle.resume();
+    }
+    for (auto &[id, request] : loader.requests) {
+        releaseAsset(state, request.get());
+    }
+    for (auto &request : loader.retired) {
+        releaseAsset(state, request.get());
+    }
+    loader.requests.clear();
+    loader.retired.clear();
+    loader.queued.clear();
+    loader.decoded.clear();
+}
+
+AssetRequest *loaderRequest(State *state, AssetId id, AssetType type) {
+    AssetLoader &loader = state->loader;
+    auto found = loader.requests.find(id);
+    if (found != loader.requests.end()) {
+        // الطلب الموجود بنوع آخر كان سيعيد nullptr بصمت عند الانتظار
+        EXPECT(found->second->type != type, "Asset %016llx requested as type %u, already loading as type %u",
+               (unsigned long long) id, (uint32_t) type, (uint32_t) found->second->type);
+        loader.deduplicated++;
+        return found->second.get();
+    }
+
+    auto request = std::make_unique<AssetRequest>();
+    request->id = id;
+    request->type = type;
+    request->onLoaderThread = true;
+    AssetRequest *pointer = request.get();
+    loader.requests.emplace(id, std::move(request));
+    loader.inFlight++;
+    {
+        std::lock_guard<std::mutex> lock(loader.mutex);
+        loader.queued.push_back(pointer);
+    }
+    loader.wake.notify_one();
+    return pointer;
+}
+
+void loaderPump(State *state) {
+    AssetLoader &loader = state->loader;
+    if (loader.benchmarkPending > 0) {
+        auto now = std::chrono::steady_clock::now();
+        double frameMs = std::chrono::duration<double, std::milli>(now - loader.benchmarkLastPump).count();
+        loader.benchmarkWorstFrameMs = std::max(loader.benchmarkWorstFrameMs, frameMs);
+        loader.benchmarkLastPump = now;
+        loader.benchmarkFrames++;
+    }
+    std::vector<std::coroutine_handle<>> resume;
+    resume.swap(loader.cancelledWaiters);
+    std::deque<AssetRequest *> decoded;
+    {
+        std::lock_guard<std::mutex> lock(loader.mutex);
+        decoded.swap(loader.decoded);
+    }
+    for (AssetRequest *request : decoded) {
+        request->onLoaderThread = false;
+        if (request->cancelled.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if (!request->decoded) {
+            std::cerr << "Failed to load asset " << std::hex << request->id << std::dec << std::endl;
+            finishRequest(loader, request, AssetStage::Failed, &resume);
+        } else if (request->type == AssetType::Blob) {
+            finishRequest(loader, request, AssetStage::Ready, &resume);
+        } else {
+            // الرفع من الخيط الرئيسي لأن حلقة الرفع غير آمنة بين الخيوط؛ الرفع ينسخ البيانات فوراً
+            if (request->type == AssetType::Texture) {
+                request->texture = createTexture(state, request->textureDesc, request->payload);
+            } else {
+                request->mesh = createMesh(state, request->meshHeader, request->payload);
+            }
+            request->bytes = {};
+            request->payload = nullptr;
+            request->stage = AssetStage::Uploading;
+        }
+    }
+
+    for (auto &[id, request] : loader.requests) {
+        if (request->stage == AssetStage::Uploading && uploaded(state, *request)) {
+            finishRequest(loader, request.get(), AssetStage::Ready, &resume);
+        }
+    }
+
+    // الاستئناف في النهاية: الكوروتين قد يطلب أصولاً جديدة أثناء تنفيذه
+    for (std::coroutine_handle<> handle : resume) {
+        handle.resume();
+    }
+
+    auto released = std::remove_if(loader.retired.begin(), loader.retired.end(), [&](auto &request) {
+        if (request->onLoaderThread || (request->stage == AssetStage::Uploading && !uploaded(state, *request))) {
+            return false;
+        }
+        releaseAsset(state, request.get());
+        return true;
+    });
+    loader.retired.erase(released, loader.retired.end());
+}
+
+void cancelLoad(State *state, AssetId id) {
+    AssetLoader &loader = state->loader;
+    auto found = loader.requests.find(id);
+    if (found == loader.requests.end() || found->second->stage >= AssetStage::Ready) {
+        return;
+    }
+    // يُستأنف المنتظرون بنتيجة فارغة في loaderPump التالية، لا داخل هذا الاستدعاء.
+    // الرفع الجاري لا يمكن إيقافه، فتبقى مرحلته Uploading حتى تكتمل تذكرته ثم تُدمَّر الصورة
+    AssetRequest *request = found->second.get();
+    request->cancelled.store(true, std::memory_order_relaxed);
+    loader.inFlight--;
+    loader.cancelledWaiters.insert(loader.cancelledWaiters.end(), request->waiters.begin(), request->waiters.end());
+    request->waiters.clear();
+    loader.retired.push_back(std::move(found->second));
+    loader.requests.erase(found);
+}
+
+void unloadAsset(State *state, AssetId id) {
+    AssetLoader &loader = state->loader;
+    auto found = loader.requests.find(id);
+    if (found == loader.requests.end()) {
+        return;
+    }
+    if (found->second->stage < AssetStage::Ready) {
+        cancelLoad(state, id);
+        return;
+    }
+    releaseAsset(state, found->second.get());
+    loader.requests.erase(found);
+}
+
+uint32_t loadsInFlight(State *state) {
+    return state->loader.inFlight;
+}
+
+// كل مدخل يُطلب مرتين من كوروتينين مختلفين ليظهر إلغاء التكرار
+static AssetTask benchmarkLoad(State *state, AssetId id) {
+    Blob *blob = co_await load<Blob>(state, id);
+    AssetLoader &loader = state->loader;
+    loader.benchmarkBytes += blob ? blob->data.size() : 0;
+    if (--loader.benchmarkPending == 0) {
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - loader.benchmarkStart).count();
+        printf("Loader benchmark: %llu loaded, %llu deduplicated, %.1f MB in %.2f ms over %u frames, "
+               "worst frame %.2f ms\n",
+               (unsigned long long) loader.completed, (unsigned long long) loader.deduplicated,
+               (double) loader.benchmarkBytes / (1 << 20), seconds * 1000.0, loader.benchmarkFrames,
+               loader.benchmarkWorstFrameMs);
+    }
+}
+
+void runLoaderBenchmark(State *state) {
+    const Archive &archive = state->archive;
+    if (!archive.data) {
+        std::cerr << "Loader benchmark needs --archive <path>" << std::endl;
+        return;
+    }
+    AssetLoader &loader = state->loader;
+    loader.benchmarkStart = std::chrono::steady_clock::now();
+    loader.benchmarkLastPump = loader.benchmarkStart;
+    loader.benchmarkPending = archive.header->entryCount * 2;
+    for (uint32_t copy = 0; copy < 2; copy++) {
+        for (uint32_t i = 0; i < archive.header->entryCount; i++) {
+            benchmarkLoad(state, archive.entries[i].id);
+        }
+    }
+}
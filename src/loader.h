@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "archive.h"
+#include "mesh.h"
+#include "texture.h"
+
+struct State;
+
+typedef uint64_t AssetId;
+
+// بيانات خام كما هي في الأرشيف
+struct Blob {
+    std::vector<uint8_t> data;
+};
+
+enum class AssetType : uint8_t {
+    Blob,
+    Texture,
+    Mesh,
+};
+
+template<typename T>
+struct AssetTypeOf;
+template<>
+struct AssetTypeOf<Blob> {
+    static constexpr AssetType value = AssetType::Blob;
+};
+template<>
+struct AssetTypeOf<Texture> {
+    static constexpr AssetType value = AssetType::Texture;
+};
+template<>
+struct AssetTypeOf<Mesh> {
+    static constexpr AssetType value = AssetType::Mesh;
+};
+
+// المراحل بالترتيب: القراءة وفك الترميز على خيط التحميل، ثم الرفع على الخيط الرئيسي
+enum class AssetStage : uint8_t {
+    Queued,
+    Uploading,      // الرفع أُرسل وننتظر تذكرته
+    Ready,
+    Failed,
+    Cancelled,
+};
+
+struct AssetRequest {
+    AssetId id = 0;
+    AssetType type = AssetType::Blob;
+    AssetStage stage = AssetStage::Queued;
+    std::atomic<bool> cancelled{false};     // يقرؤه خيط التحميل ليتخطى العمل
+    bool onLoaderThread = false;            // لا يُحرَّر قبل أن يعود من خيط التحميل
+
+    // ناتج خيط التحميل: payload جاهز للرفع كما هو، إما داخل bytes أو مباشرة في الأرشيف المعيّن
+    bool decoded = false;
+    std::vector<uint8_t> bytes;
+    const uint8_t *payload = nullptr;
+    TextureDesc textureDesc;
+    CookedMeshHeader meshHeader;
+
+    Blob blob;
+    Texture texture;
+    Mesh mesh;
+    std::vector<std::coroutine_handle<>> waiters;
+};
+
+struct AssetLoader {
+    std::unordered_map<AssetId, std::unique_ptr<AssetRequest>> requests;
+    // الطلبات الملغاة تُنقل هنا حتى يعود خيط التحميل منها وتكتمل رفعاتها
+    std::vector<std::unique_ptr<AssetRequest>> retired;
+    std::vector<std::coroutine_handle<>> cancelledWaiters;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<AssetRequest *> queued;      // الخيط الرئيسي -> خيط التحميل
+    std::deque<AssetRequest *> decoded;     // خيط التحميل -> الخيط الرئيسي
+    bool stopping = false;
+
+    uint32_t inFlight = 0;
+    uint64_t completed = 0;
+    uint64_t deduplicated = 0;
+
+    // --bench loader
+    uint32_t benchmarkPending = 0;
+    uint64_t benchmarkBytes = 0;
+    uint32_t benchmarkFrames = 0;
+    double benchmarkWorstFrameMs = 0.0;
+    std::chrono::steady_clock::time_point benchmarkStart;
+    std::chrono::steady_clock::time_point benchmarkLastPump;
+};
+
+void createAssetLoader(State *state);
+void destroyAssetLoader(State *state);
+
+// نقطة الاستئناف الآمنة: مرة في كل إطار بعد beginFrame وقبل تسجيل الأوامر
+void loaderPump(State *state);
+
+AssetRequest *loaderRequest(State *state, AssetId id, AssetType type);
+void cancelLoad(State *state, AssetId id);
+void unloadAsset(State *state, AssetId id);
+uint32_t loadsInFlight(State *state);
+
+template<typename T>
+T *assetResult(AssetRequest *request);
+template<>
+inline Blob *assetResult<Blob>(AssetRequest *request) {
+    return &request->blob;
+}
+template<>
+inline Texture *assetResult<Texture>(AssetRequest *request) {
+    return &request->texture;
+}
+template<>
+inline Mesh *assetResult<Mesh>(AssetRequest *request) {
+    return &request->mesh;
+}
+
+// co_await load<Texture>(state, id): يعيد nullptr إذا فشل التحميل أو أُلغي
+template<typename T>
+struct AssetLoad {
+    AssetRequest *request;
+
+    bool await_ready() const {
+        return request->stage >= AssetStage::Ready;
+    }
+    void await_suspend(std::coroutine_handle<> handle) {
+        request->waiters.push_back(handle);
+    }
+    T *await_resume() const {
+        bool ready = request->stage == AssetStage::Ready && request->type == AssetTypeOf<T>::value;
+        return ready ? assetResult<T>(request) : nullptr;
+    }
+};
+
+template<typename T>
+AssetLoad<T> load(State *state, AssetId id) {
+    return {loaderRequest(state, id, AssetTypeOf<T>::value)};
+}
+
+template<typename T>
+AssetLoad<T> load(State *state, const char *path) {
+    return load<T>(state, archiveHash(path));
+}
+
+// كوروتين يبدأ فوراً ويحرر نفسه عند الانتهاء؛ كل استئناف يحدث داخل loaderPump
+struct AssetTask {
+    struct promise_type {
+        AssetTask get_return_object() {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+// --bench loader
+void runLoaderBenchmark(State *state);
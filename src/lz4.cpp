@@ -0,0 +1,169 @@
+#include "lz4.h"
+
+#include <cstring>
+
+constexpr uint32_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;         // آخر 5 بايتات حرفية دائماً حسب المواصفة
+constexpr size_t MATCH_SAFE_DISTANCE = 12;  // لا يبدأ تطابق في آخر 12 بايت
+constexpr uint32_t HASH_BITS = 16;
+constexpr uint32_t MAX_OFFSET = 65535;
+
+static uint32_t read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static uint32_t hash4(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint8_t *writeLength(uint8_t *out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (uint8_t) length;
+    return out;
+}
+
+size_t lz4Compress(const uint8_t *source, size_t size, uint8_t *destination, size_t capacity) {
+    if (capacity < lz4CompressBound(size)) {
+        return 0;
+    }
+    uint32_t table[1 << HASH_BITS];
+    memset(table, 0xFF, sizeof(table));
+
+    const uint8_t *anchor = source;
+    const uint8_t *end = source + size;
+    uint8_t *out = destination;
+
+    if (size > MATCH_SAFE_DISTANCE) {
+        const uint8_t *matchLimit = end - LAST_LITERALS;
+        const uint8_t *position = source;
+        while (position < end - MATCH_SAFE_DISTANCE) {
+            uint32_t sequence = read32(position);
+            uint32_t hash = hash4(sequence);
+            uint32_t candidate = table[hash];
+            table[hash] = (uint32_t) (position - source);
+
+            if (candidate == UINT32_MAX || position - (source + candidate) > MAX_OFFSET ||
+                read32(source + candidate) != sequence) {
+                position++;
+                continue;
+            }
+
+            // تمديد التطابق للأمام حتى حد البايتات الحرفية الأخيرة
+            const uint8_t *match = source + candidate;
+            const uint8_t *matchEnd = position + MIN_MATCH;
+            const uint8_t *reference = match + MIN_MATCH;
+            while (matchEnd < matchLimit && *matchEnd == *reference) {
+                matchEnd++;
+                reference++;
+            }
+
+            size_t literalLength = position - anchor;
+            size_t matchLength = (matchEnd - position) - MIN_MATCH;
+            uint8_t *token = out++;
+            *token = (uint8_t) ((literalLength >= 15 ? 15 : literalLength) << 4 |
+                                (matchLength >= 15 ? 15 : matchLength));
+            if (literalLength >= 15) {
+                out = writeLength(out, literalLength - 15);
+            }
+            memcpy(out, anchor, literalLength);
+            out += literalLength;
+
+            uint16_t offset = (uint16_t) (position - match);
+            *out++ = (uint8_t) offset;
+            *out++ = (uint8_t) (offset >> 8);
+            if (matchLength >= 15) {
+                out = writeLength(out, matchLength - 15);
+            }
+
+            position = matchEnd;
+            anchor = position;
+        }
+    }
+
+    size_t literalLength = end - anchor;
+    *out++ = (uint8_t) ((literalLength >= 15 ? 15 : literalLength) << 4);
+    if (literalLength >= 15) {
+        out = writeLength(out, literalLength - 15);
+    }
+    if (literalLength > 0) {
+        memcpy(out, anchor, literalLength);
+        out += literalLength;
+    }
+    return out - destination;
+}
+
+int64_t lz4Decompress(const uint8_t *source, size_t size, uint8_t *destination, size_t capacity) {
+    const uint8_t *in = source;
+    const uint8_t *inEnd = source + size;
+    uint8_t *out = destination;
+    uint8_t *outEnd = destination + capacity;
+
+    while (in < inEnd) {
+        uint8_t token = *in++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            uint8_t extra;
+            do {
+                if (in >= inEnd) {
+                    return -1;
+                }
+                extra = *in++;
+                literalLength += extra;
+            } while (extra == 255);
+        }
+        if (literalLength > (size_t) (inEnd - in) || literalLength > (size_t) (outEnd - out)) {
+            return -1;
+        }
+        memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        // التسلسل الأخير بلا تطابق
+        if (in == inEnd) {
+            break;
+        }
+
+        if (inEnd - in < 2) {
+            return -1;
+        }
+        size_t offset = in[0] | (size_t) in[1] << 8;
+        in += 2;
+        if (offset == 0 || offset > (size_t) (out - destination)) {
+            return -1;
+        }
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            uint8_t extra;
+            do {
+                if (in >= inEnd) {
+                    return -1;
+                }
+                extra = *in++;
+                matchLength += extra;
+            } while (extra == 255);
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > (size_t) (outEnd - out)) {
+            return -1;
+        }
+
+        // النسخ بايت ببايت حين يتداخل المصدر مع الوجهة (offset أصغر من الطول)
+        const uint8_t *match = out - offset;
+        if (offset >= matchLength) {
+            memcpy(out, match, matchLength);
+            out += matchLength;
+        } else {
+            for (size_t i = 0; i < matchLength; i++) {
+                *out++ = *match++;
+            }
+        }
+    }
+    return out - destination;
+}
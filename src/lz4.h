@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ترميز كتل LZ4 (block format فقط، بدون إطار)، متوافق مع lz4 المرجعي
+
+inline size_t lz4CompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+// تعيد حجم الناتج، أو 0 إذا لم يتسع في capacity
+size_t lz4Compress(const uint8_t *source, size_t size, uint8_t *destination, size_t capacity);
+
+// تعيد عدد البايتات المكتوبة، أو -1 إذا كانت البيانات تالفة أو لا تتسع
+int64_t lz4Decompress(const uint8_t *source, size_t size, uint8_t *destination, size_t capacity);
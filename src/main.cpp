@@ -1,16 +1,11 @@
 #include <iostream>
-#include <csignal>
-#define GLFW_INCLUDE_VULKAN
-#include "GLFW/glfw3.h"
 #include <cstdlib>
-#include <vector>
+#include <cstring>
+#include <algorithm>
 
-#define EXPECT(ERROR, FORMAT, ...) \
-if (ERROR) { \
-    fprintf(stderr, "%s -> %s -> %d -> Error(%i):\n\t" FORMAT "\n", \
-    __FILE__, __FUNCTION__, __LINE__, ERROR, ##__VA_ARGS__); \
-    raise(SIGSEGV); \
-}
+#include "state.h"
+#include "sprite.h"
+#include "texture.h"
 
 void glfwErorrCallback(int error_code, const char *error_message) {
     EXPECT(error_code, "GLFW error: %s", error_message);
@@ -25,42 +20,6 @@ void setupErrorHandling() {
     atexit(exitCallback);
 }
 
-struct State {
-    const char *windowTitle;
-    const char *applicationName;
-    const char *engineName;
-    int windowWidth, windowHeight;
-    bool windowResizable;
-    bool windowFullscreen;
-    uint32_t frameBufferWidth, frameBufferHeight;
-    bool recreateSwapChain;
-
-    GLFWwindow *window = nullptr;                   // تم تعديل هذا السطر
-    GLFWmonitor *windowMonitor = nullptr;           // تم تعديل هذا السطر
-    VkAllocationCallbacks *allocator = nullptr;     // تم تعديل هذا السطر
-    const std::vector<const char *> validationLayers{
-        "VK_LAYER_KHRONOS_validation"
-    };
-
-    const std::vector<const char *> enabledExtensionNames{
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-        "VK_KHR_portability_subset"
-    };
-
-    VkInstance instance = VK_NULL_HANDLE;           // تم تعديل هذا السطر
-    uint32_t app_version;
-    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;  // تم تعديل هذا السطر
-    VkSurfaceKHR surface = VK_NULL_HANDLE;             // تم تعديل هذا السطر
-    uint32_t queueFamilyIndex;
-    VkDevice device = VK_NULL_HANDLE;                  // تم تعديل هذا السطر
-    VkQueue queue = VK_NULL_HANDLE;                    // تم تعديل هذا السطر
-    uint32_t swapchainImageCount;
-    VkSwapchainKHR swapchain = VK_NULL_HANDLE;         // تم تعديل هذا السطر
-    std::vector<VkImage> swapchainImages;
-    VkExtent2D swapchainExtent;
-    std::vector<VkImageView> swapchainImageViews;
-};
-
 void glfwFramebufferSizeCallback(GLFWwindow *window, int width, int height) {
     State *state = static_cast<State*>(glfwGetWindowUserPointer(window));
     state->windowWidth = width;
@@ -164,6 +123,10 @@ void selectPhysicalDevice(State *state) {
 
     result = vkEnumeratePhysicalDevices(state->instance, &count, &state->physicalDevice);
     EXPECT(result != VK_SUCCESS, "Couldn't enumerate physical devices");
+
+    vkGetPhysicalDeviceProperties(state->physicalDevice, &state->physicalDeviceProperties);
+    vkGetPhysicalDeviceMemoryProperties(state->physicalDevice, &state->memoryProperties);
+    std::cout << "Physical device: " << state->physicalDeviceProperties.deviceName << std::endl;
 }
 
 void createSurface(State *state) {
@@ -189,28 +152,175 @@ void selectQueueFamily(State *state) {
         }
     }
     std::cout << "Queue Family Index: " << state->queueFamilyIndex << std::endl;
+
+    // عائلة نقل مخصصة تعمل بالتوازي مع الرسم (محرك DMA على معظم البطاقات المنفصلة)
+    for (uint32_t i = 0; i < count; i++) {
+        VkQueueFlags flags = queueFamilies[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+            state->transferQueueFamilyIndex = i;
+            std::cout << "Transfer Queue Family Index: " << i << std::endl;
+            break;
+        }
+    }
+    state->sharedQueueFamilies[0] = state->queueFamilyIndex;
+    state->sharedQueueFamilies[1] = state->transferQueueFamilyIndex;
+}
+
+bool deviceExtensionSupported(State *state, const char *name) {
+    for (const VkExtensionProperties &extension : state->availableDeviceExtensions) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void selectHostImageCopyLayout(State *state) {
+    VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties{};
+    hostImageCopyProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &hostImageCopyProperties;
+    vkGetPhysicalDeviceProperties2(state->physicalDevice, &properties);
+
+    std::vector<VkImageLayout> dstLayouts(hostImageCopyProperties.copyDstLayoutCount);
+    hostImageCopyProperties.pCopyDstLayouts = dstLayouts.data();
+    hostImageCopyProperties.copySrcLayoutCount = 0;
+    vkGetPhysicalDeviceProperties2(state->physicalDevice, &properties);
+
+    // نفضّل الكتابة مباشرة في التخطيط الذي ستُقرأ منه الصورة لتجنب أي انتقال لاحق
+    state->hostImageCopy = false;
+    for (VkImageLayout layout : {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL}) {
+        if (std::find(dstLayouts.begin(), dstLayouts.end(), layout) != dstLayouts.end()) {
+            state->hostCopyDstLayout = layout;
+            state->hostImageCopy = true;
+            break;
+        }
+    }
+    std::cout << "Host image copy: " << (state->hostImageCopy ? "enabled" : "no usable layout")
+              << ", identical memory requirements: " << hostImageCopyProperties.identicalMemoryTypeRequirements
+              << std::endl;
 }
 
 void createDevice(State *state) {
     float priorities = 1.0f;
     VkPhysicalDeviceFeatures deviceFeatures{};
 
-    VkDeviceQueueCreateInfo queueCreateInfo{};
-    queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueCreateInfo.pNext = nullptr;
-    queueCreateInfo.flags = 0;
-    queueCreateInfo.queueFamilyIndex = state->queueFamilyIndex;
-    queueCreateInfo.queueCount = 1;
-    queueCreateInfo.pQueuePriorities = &priorities;
+    uint32_t extensionCount = 0;
+    EXPECT(vkEnumerateDeviceExtensionProperties(state->physicalDevice, nullptr, &extensionCount, nullptr),
+           "Couldn't enumerate device extensions");
+    state->availableDeviceExtensions.resize(extensionCount);
+    EXPECT(vkEnumerateDeviceExtensionProperties(state->physicalDevice, nullptr, &extensionCount,
+                                                state->availableDeviceExtensions.data()),
+           "Couldn't enumerate device extensions");
+
+    // VK_KHR_portability_subset يُفعَّل فقط حيث يعلنه التطبيق (MoltenVK)
+    std::vector<const char *> extensions;
+    for (const char *name : state->enabledExtensionNames) {
+        if (strcmp(name, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0 || deviceExtensionSupported(state, name)) {
+            extensions.push_back(name);
+        }
+    }
+
+    // الميزات الاختيارية تُختار هنا مرة واحدة حسب ما يدعمه الجهاز
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures{};
+    hostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+    VkPhysicalDeviceVulkan12Features supported12Features{};
+    supported12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &supported12Features;
+    if (deviceExtensionSupported(state, VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME)) {
+        supported12Features.pNext = &hostImageCopyFeatures;
+    }
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures{};
+    pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    if (deviceExtensionSupported(state, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+        deviceExtensionSupported(state, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+        pipelineLibraryFeatures.pNext = supported12Features.pNext;
+        supported12Features.pNext = &pipelineLibraryFeatures;
+    }
+    vkGetPhysicalDeviceFeatures2(state->physicalDevice, &supportedFeatures);
+    if (hostImageCopyFeatures.hostImageCopy) {
+        selectHostImageCopyLayout(state);
+    }
+    state->descriptorIndexing = supported12Features.descriptorIndexing &&
+                                supported12Features.runtimeDescriptorArray &&
+                                supported12Features.descriptorBindingPartiallyBound &&
+                                supported12Features.descriptorBindingSampledImageUpdateAfterBind &&
+                                supported12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+                                supported12Features.descriptorBindingUpdateUnusedWhilePending &&
+                                supported12Features.shaderSampledImageArrayNonUniformIndexing &&
+                                supported12Features.shaderStorageBufferArrayNonUniformIndexing;
+    state->bufferDeviceAddress = supported12Features.bufferDeviceAddress;
+    state->textureCompressionBC = supportedFeatures.features.textureCompressionBC;
+    state->graphicsPipelineLibrary = pipelineLibraryFeatures.graphicsPipelineLibrary;
+    state->multiDrawIndirect = supportedFeatures.features.multiDrawIndirect &&
+                               supportedFeatures.features.drawIndirectFirstInstance;
+    state->drawIndirectCount = supported12Features.drawIndirectCount;
+    state->storageImageWriteWithoutFormat = supportedFeatures.features.shaderStorageImageWriteWithoutFormat;
+    deviceFeatures.textureCompressionBC = state->textureCompressionBC;
+    deviceFeatures.multiDrawIndirect = state->multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = state->multiDrawIndirect;
+    deviceFeatures.shaderStorageImageWriteWithoutFormat = state->storageImageWriteWithoutFormat;
+
+    VkPhysicalDeviceVulkan13Features vulkan13Features{};
+    vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    vulkan13Features.synchronization2 = VK_TRUE;
+    vulkan13Features.dynamicRendering = VK_TRUE;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.pNext = &vulkan13Features;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    if (state->descriptorIndexing) {
+        vulkan12Features.descriptorIndexing = VK_TRUE;
+        vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+        vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+    }
+    vulkan12Features.bufferDeviceAddress = state->bufferDeviceAddress;
+    vulkan12Features.drawIndirectCount = state->drawIndirectCount;
+
+    hostImageCopyFeatures.pNext = nullptr;
+    if (state->hostImageCopy) {
+        vulkan13Features.pNext = &hostImageCopyFeatures;
+        extensions.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+    }
+    pipelineLibraryFeatures.pNext = nullptr;
+    if (state->graphicsPipelineLibrary) {
+        pipelineLibraryFeatures.pNext = vulkan13Features.pNext;
+        vulkan13Features.pNext = &pipelineLibraryFeatures;
+        extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    }
+
+    VkDeviceQueueCreateInfo queueCreateInfos[2]{};
+    uint32_t queueCreateInfoCount = 1;
+    queueCreateInfos[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueCreateInfos[0].pNext = nullptr;
+    queueCreateInfos[0].flags = 0;
+    queueCreateInfos[0].queueFamilyIndex = state->queueFamilyIndex;
+    queueCreateInfos[0].queueCount = 1;
+    queueCreateInfos[0].pQueuePriorities = &priorities;
+    if (state->transferQueueFamilyIndex != UINT32_MAX) {
+        queueCreateInfos[1] = queueCreateInfos[0];
+        queueCreateInfos[1].queueFamilyIndex = state->transferQueueFamilyIndex;
+        queueCreateInfoCount = 2;
+    }
 
     VkDeviceCreateInfo deviceCreateInfo{};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceCreateInfo.pNext = nullptr;
+    deviceCreateInfo.pNext = &vulkan12Features;
     deviceCreateInfo.flags = 0;
-    deviceCreateInfo.queueCreateInfoCount = 1;
-    deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
-    deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(state->enabledExtensionNames.size());
-    deviceCreateInfo.ppEnabledExtensionNames = state->enabledExtensionNames.data();
+    deviceCreateInfo.queueCreateInfoCount = queueCreateInfoCount;
+    deviceCreateInfo.pQueueCreateInfos = queueCreateInfos;
+    deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    deviceCreateInfo.ppEnabledExtensionNames = extensions.data();
     deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
     deviceCreateInfo.enabledLayerCount = static_cast<uint32_t>(state->validationLayers.size());
     deviceCreateInfo.ppEnabledLayerNames = state->validationLayers.data();
@@ -218,10 +328,21 @@ void createDevice(State *state) {
     VkResult result = vkCreateDevice(state->physicalDevice, &deviceCreateInfo, state->allocator, &state->device);
     EXPECT(result != VK_SUCCESS, "فشل في إنشاء الجهاز المنطقي");
     std::cout << "Device created: " << reinterpret_cast<uintptr_t>(state->device) << std::endl;
+
+    if (state->hostImageCopy) {
+        state->vkCopyMemoryToImageEXT = reinterpret_cast<PFN_vkCopyMemoryToImageEXT>(
+            vkGetDeviceProcAddr(state->device, "vkCopyMemoryToImageEXT"));
+        state->vkTransitionImageLayoutEXT = reinterpret_cast<PFN_vkTransitionImageLayoutEXT>(
+            vkGetDeviceProcAddr(state->device, "vkTransitionImageLayoutEXT"));
+    }
 }
 
 void getQueue(State *state) {
-    vkGetDeviceQueue(state->device, state->queueFamilyIndex, 0, &state->queue);
+    createTimelineQueue(state, &state->graphicsTimeline, "graphics", state->queueFamilyIndex, 0);
+    state->queue = state->graphicsTimeline.queue;
+    if (state->transferQueueFamilyIndex != UINT32_MAX) {
+        createTimelineQueue(state, &state->transferTimeline, "transfer", state->transferQueueFamilyIndex, 0);
+    }
     std::cout << "Queue retrieved: " << reinterpret_cast<uintptr_t>(state->queue) << std::endl;
 }
 
@@ -261,6 +382,26 @@ void createSwapchain(State *state) {
             break;
         }
     }
+    // المعالجة اللاحقة تكتب آخر ممر من compute في صورة الـ swapchain نفسها. صيغ sRGB لا تقبل التخزين،
+    // فتُختار صيغة UNORM بفضاء الألوان نفسه ويُرمَّز sRGB في الـ shader
+    VkImageUsageFlags storageUsage = 0;
+    if (state->post.requested && state->storageImageWriteWithoutFormat &&
+        (surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT)) {
+        for (uint32_t i = 0; i < formatCount; i++) {
+            VkSurfaceFormatKHR format = formats[i];
+            if (format.colorSpace != VK_COLORSPACE_SRGB_NONLINEAR_KHR ||
+                (format.format != VK_FORMAT_B8G8R8A8_UNORM && format.format != VK_FORMAT_R8G8B8A8_UNORM)) {
+                continue;
+            }
+            VkFormatProperties properties;
+            vkGetPhysicalDeviceFormatProperties(state->physicalDevice, format.format, &properties);
+            if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) {
+                formatIndex = i;
+                storageUsage = VK_IMAGE_USAGE_STORAGE_BIT;
+                break;
+            }
+        }
+    }
     VkSurfaceFormatKHR format = formats[formatIndex];
 
     VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
@@ -291,21 +432,18 @@ void createSwapchain(State *state) {
 
     std::cout << "Selected Present Mode: " << presentMode << std::endl;
 
-    // تدمير الـ Swapchain والـ Image Views القديمة إذا كانت موجودة
-    if (state->swapchain != VK_NULL_HANDLE) {          // تم تعديل هذا السطر
-        // تدمير الـ Image Views القديمة
-        for (auto &imageView : state->swapchainImageViews) {   // تم تعديل هذا السطر
-            if (imageView != VK_NULL_HANDLE) {                 // تم تعديل هذا السطر
-                vkDestroyImageView(state->device, imageView, state->allocator);
-                imageView = VK_NULL_HANDLE;                    // تم تعديل هذا السطر
-            }
-        }
-        state->swapchainImageViews.clear();                    // تم تعديل هذا السطر
+    // الالتقاط ينسخ من صورة الـ swapchain نفسها؛ بدون TRANSFER_SRC يُعطَّل بدلاً من swapchain غير صالحة
+    if (state->readback.directory && !(surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)) {
+        std::cout << "Capture: disabled, swapchain images cannot be a transfer source" << std::endl;
+        state->readback.directory = nullptr;
+    }
 
-        // تدمير الـ Swapchain القديمة
-        vkDestroySwapchainKHR(state->device, state->swapchain, state->allocator);  // تم تعديل هذا السطر
-        state->swapchain = VK_NULL_HANDLE;                                         // تم تعديل هذا السطر
+    // الـ Swapchain القديمة تُمرَّر للجديدة ثم تُؤجَّل هي والـ Image Views إلى أن ينتهي الـ GPU منها
+    VkSwapchainKHR oldSwapchain = state->swapchain;
+    for (auto &imageView : state->swapchainImageViews) {
+        deferDestroy(state, imageView);
     }
+    state->swapchainImageViews.clear();
 
     VkSwapchainCreateInfoKHR createInfo = {
         .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -315,8 +453,11 @@ void createSwapchain(State *state) {
         .clipped = VK_TRUE,
         .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
         .imageArrayLayers = 1,
-        .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-        .oldSwapchain = VK_NULL_HANDLE,          // تم تعديل هذا السطر
+        .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                      (surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) | storageUsage |
+                      (state->readback.directory ? surfaceCapabilities.supportedUsageFlags &
+                                                   VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0),
+        .oldSwapchain = oldSwapchain,
         .preTransform = surfaceCapabilities.currentTransform,
         .imageExtent = surfaceCapabilities.currentExtent,
         .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
@@ -329,6 +470,7 @@ void createSwapchain(State *state) {
 
     result = vkCreateSwapchainKHR(state->device, &createInfo, state->allocator, &state->swapchain);
     EXPECT(result != VK_SUCCESS, "Failed to create swapchain");
+    deferDestroy(state, oldSwapchain);
 
     // الحصول على الصور من الـ Swapchain
     result = vkGetSwapchainImagesKHR(state->device, state->swapchain, &state->swapchainImageCount, nullptr);
@@ -365,11 +507,19 @@ void createSwapchain(State *state) {
         result = vkCreateImageView(state->device, &viewInfo, state->allocator, &state->swapchainImageViews[i]);
         EXPECT(result != VK_SUCCESS, "Failed to create image view %u", i);
     }
+    state->swapchainExtent = createInfo.imageExtent;
+    state->swapchainFormat = createInfo.imageFormat;
+    state->swapchainUsage = createInfo.imageUsage;
+    createPresentSemaphores(state);
 }
 
 void init(State *state) {
     logInfo();
     setupErrorHandling();
+    createJobSystem(state);
+    if (state->archivePath) {
+        openArchive(&state->archive, state->archivePath);
+    }
     createWindow(state);
     createInstance(state);
     selectPhysicalDevice(state);
@@ -378,33 +528,197 @@ void init(State *state) {
     createDevice(state);
     getQueue(state);
     createSwapchain(state);          // تم إضافة هذا السطر للتأكد من إنشاء الـ Swapchain عند التهيئة
+    createFrameResources(state);
+    createGpuTimers(state);
+    createRenderTargets(state);
+    createUploadManager(state);
+    createReadback(state);
+    createDescriptorAllocator(state);
+    createBindless(state);
+    createUniformRing(state);
+    createPipelineManager(state);
+    createPost(state);
+    createDynamicResolution(state);
+    createSpriteRenderer(state);
+    createLights(state);
+    createScene(state);
+    createAssetLoader(state);
+    pipelinePrecompile(state);
+}
+
+void recordFrame(State *state) {
+    VkCommandBuffer commandBuffer = state->commandBuffer;
+    gpuTimersBeginFrame(state, commandBuffer);
+    dynamicResolutionUpdate(state);
+    updateRenderTargets(state);
+    RenderTargets &targets = state->renderTargets;
+    gpuTimerBegin(state, commandBuffer, GPU_TIMER_FRAME);
+
+    // الصورة عائدة من محرك العرض: أول حاجز ينتظر المرحلة التي تنتظر فيها إشارة الاستحواذ
+    PassImage target{
+        .image = state->swapchainImages[state->imageIndex],
+        .view = state->swapchainImageViews[state->imageIndex],
+        .state = {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR},
+        .format = state->swapchainFormat,
+        .extent = state->swapchainExtent,
+    };
+    // العمق والعينات لا يغادران ذاكرة البلاطات؛ صورة الـ Swapchain هي الوحيدة التي تُكتب،
+    // أو صورة المشهد مع الدقة الديناميكية أو المعالجة اللاحقة ثم تُنقل إليها
+    bool multisampled = targets.samples != VK_SAMPLE_COUNT_1_BIT;
+    PassImage *output = targets.offscreen ? &targets.sceneTarget : &target;
+    PassDesc mainPass{
+        .name = "main",
+        .extent = targets.renderExtent,
+        .colors = {{
+            .image = multisampled ? &targets.colorTarget : output,
+            .resolve = multisampled ? output : nullptr,
+            .readAfter = !multisampled,
+            .clearValue = {.color = {{0.05f, 0.05f, 0.08f, 1.0f}}},
+        }},
+        .colorCount = 1,
+        .depth = {
+            .image = &targets.depthTarget,
+            .clearValue = {.depthStencil = {0.0f, 0}},
+        },
+    };
+    // التصفية خارج الممر: أوامر الرسم تُكتب قبل أن يبدأ
+    bool twoPhase = sceneCull(state, commandBuffer);
+    lightsCluster(state, commandBuffer);
+    if (twoPhase) {
+        // تصفية الحجب: ما كان مرئياً يُرسم أولاً، ومن عمقه يُبنى الهرم، ثم يكمل الممر الرئيسي فوقه
+        PassDesc earlyPass = mainPass;
+        earlyPass.name = "scene.early";
+        earlyPass.colors[0].readAfter = true;
+        earlyPass.depth.readAfter = true;
+        beginPass(state, commandBuffer, earlyPass);
+        sceneRender(state, commandBuffer);
+        endPass(commandBuffer);
+        sceneCullLate(state, commandBuffer);
+        mainPass.colors[0].readsPrevious = true;
+        mainPass.depth.readsPrevious = true;
+    }
+    beginPass(state, commandBuffer, mainPass);
+    sceneRender(state, commandBuffer);
+    spriteRender(state, commandBuffer);
+    endPass(commandBuffer);
+    if (state->post.enabled) {
+        postRender(state, commandBuffer, &target);
+    } else if (targets.offscreen) {
+        dynamicResolutionUpscale(state, commandBuffer, &target);
+    }
+
+    BarrierBatch barriers;
+    transitionImage(&barriers, &target, IMAGE_STATE_PRESENT);
+    flushBarriers(commandBuffer, &barriers);
+    gpuTimerEnd(state, commandBuffer, GPU_TIMER_FRAME);
 }
 
 void loop(State *state) {
+    if (state->benchmark && strcmp(state->benchmark, "texture") == 0) {
+        runTextureBenchmark(state);
+    }
+    if (state->benchmark && strcmp(state->benchmark, "ecs") == 0) {
+        runEcsBenchmark(state);
+    }
+    if (state->benchmark && strcmp(state->benchmark, "archive") == 0) {
+        runArchiveBenchmark(state);
+    }
+    if (state->benchmark && strcmp(state->benchmark, "loader") == 0) {
+        runLoaderBenchmark(state);
+    }
+    startSimulation(state);
     while (!glfwWindowShouldClose(state->window)) {
         glfwPollEvents();
+        // النافذة مصغّرة: لا يمكن إنشاء Swapchain بحجم صفر
+        if (state->windowWidth == 0 || state->windowHeight == 0) {
+            glfwWaitEvents();
+            continue;
+        }
         if (state->recreateSwapChain) {
             state->recreateSwapChain = false;
             createSwapchain(state);
         }
+        if (!beginFrame(state)) {
+            continue;
+        }
+        readbackPoll(state);
+        loaderPump(state);
+        pipelinePump(state);
+        if (state->benchmark && strcmp(state->benchmark, "upload") == 0) {
+            uploadBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "uniforms") == 0) {
+            uniformRingBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "sprites") == 0) {
+            spriteBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "pipeline") == 0) {
+            pipelineBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "attachments") == 0) {
+            attachmentBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "scene") == 0) {
+            sceneBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "occlusion") == 0) {
+            sceneOcclusionBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "lights") == 0) {
+            lightBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "resolution") == 0) {
+            dynamicResolutionBenchmarkFrame(state);
+        }
+        if (state->benchmark && strcmp(state->benchmark, "post") == 0) {
+            postBenchmarkFrame(state);
+        }
+        simulationDrawSprites(state);
+        recordFrame(state);
+        if (state->readback.directory) {
+            readbackCaptureSwapchain(state);
+        }
+        uploadFlush(state);
+        uniformRingFlush(state);
+        endFrame(state);
     }
 }
 
 void cleanup(State *state) {
-    // تدمير الـ Image Views
-    for (auto &imageView : state->swapchainImageViews) {    // تم تعديل هذا السطر
-        if (imageView != VK_NULL_HANDLE) {                  // تم تعديل هذا السطر
-            vkDestroyImageView(state->device, imageView, state->allocator);
-            imageView = VK_NULL_HANDLE;                     // تم تعديل هذا السطر
-        }
+    stopSimulation(state);
+
+    // الانتظار مرة واحدة عند الإغلاق فقط ثم تحرير كل ما في طابور التدمير
+    if (state->device != VK_NULL_HANDLE) {
+        vkDeviceWaitIdle(state->device);
     }
-    state->swapchainImageViews.clear();                     // تم تعديل هذا السطر
+    destroyAssetLoader(state);
+    destroyPipelineManager(state);
 
-    // تدمير الـ Swapchain
-    if (state->swapchain != VK_NULL_HANDLE) {               // تم تعديل هذا السطر
-        vkDestroySwapchainKHR(state->device, state->swapchain, state->allocator);
-        state->swapchain = VK_NULL_HANDLE;                  // تم تعديل هذا السطر
+    // تدمير الـ Image Views والـ Swapchain
+    for (auto &imageView : state->swapchainImageViews) {
+        deferDestroy(state, imageView);
     }
+    state->swapchainImageViews.clear();
+    deferDestroy(state, state->swapchain);
+    state->swapchain = VK_NULL_HANDLE;
+    destroyScene(state);
+    destroyLights(state);
+    destroySpriteRenderer(state);
+    destroyDynamicResolution(state);
+    destroyPost(state);
+    destroyShaderCache(state);
+    destroyUniformRing(state);
+    destroyBindless(state);
+    destroyDescriptorAllocator(state);
+    destroyReadback(state);
+    destroyUploadManager(state);
+    destroyRenderTargets(state);
+    destroyGpuTimers(state);
+    destroyFrameResources(state);
+    destroyTimelineQueue(state, &state->transferTimeline);
+    destroyTimelineQueue(state, &state->graphicsTimeline);
+    deletionQueueFlushAll(state);
 
     // تدمير الـ Surface
     if (state->surface != VK_NULL_HANDLE) {                 // تم تعديل هذا السطر
@@ -432,9 +746,13 @@ void cleanup(State *state) {
 
     // إنهاء GLFW
     glfwTerminate();
+
+    closeArchive(&state->archive);
+    destroyWorld(state);
+    destroyJobSystem(state);
 }
 
-int main() {
+int main(int argc, char **argv) {
     std::cout << "Hello, World!" << std::endl;
     State state = {
         .windowTitle = "بسم الله الرحمن الرحيم",
@@ -446,6 +764,31 @@ int main() {
         .windowFullscreen = false,
         .app_version = VK_API_VERSION_1_3,
     };
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            state.benchmark = argv[++i];
+        } else if (strcmp(argv[i], "--shader-dir") == 0) {
+            state.shaders.overrideDirectory = argv[++i];
+        } else if (strcmp(argv[i], "--archive") == 0) {
+            state.archivePath = argv[++i];
+        } else if (strcmp(argv[i], "--msaa") == 0) {
+            state.renderTargets.requestedSamples = (uint32_t) atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pipeline-cache") == 0) {
+            state.pipelines.cacheDirectory = argv[++i];
+        } else if (strcmp(argv[i], "--capture") == 0) {
+            state.readback.directory = argv[++i];
+        } else if (strcmp(argv[i], "--capture-format") == 0) {
+            state.readback.format = strcmp(argv[++i], "raw") == 0 ? CaptureFormat::Raw : CaptureFormat::Png;
+        } else if (strcmp(argv[i], "--dynamic-resolution") == 0) {
+            state.resolution.targetMs = (float) atof(argv[++i]);
+        } else if (strcmp(argv[i], "--post") == 0) {
+            state.post.requested = strcmp(argv[++i], "off") != 0;
+        }
+    }
+    // مقياس الدقة الديناميكية يحتاج ميزانية؛ 8 ms تضمن أن تتجاوزها شبكة المشهد على معظم الأجهزة
+    if (state.benchmark && strcmp(state.benchmark, "resolution") == 0 && state.resolution.targetMs <= 0) {
+        state.resolution.targetMs = 8.0f;
+    }
     init(&state);
     loop(&state);
     cleanup(&state);
@@ -0,0 +1,54 @@
+#include "mesh.h"
+#include "state.h"
+
+#include <cstring>
+
+Mesh createMesh(State *state, const CookedMeshHeader &header, const void *data) {
+    Mesh mesh{
+        .vertexCount = header.vertexCount,
+        .indexCount = header.indexCount,
+        .indexType = header.indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32,
+        .boundsRadius = header.boundsRadius,
+    };
+    memcpy(mesh.positionOffset, header.positionOffset, sizeof(mesh.positionOffset));
+    memcpy(mesh.positionScale, header.positionScale, sizeof(mesh.positionScale));
+    memcpy(mesh.boundsCenter, header.boundsCenter, sizeof(mesh.boundsCenter));
+
+    // storage أيضاً حتى تقرأها مراحل الـ compute
+    VkDeviceSize vertexBytes = (VkDeviceSize) header.vertexCount * sizeof(CookedVertex);
+    VkDeviceSize indexBytes = (VkDeviceSize) header.indexCount * header.indexSize;
+    mesh.vertices = createBuffer(state, vertexBytes,
+                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                 VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    mesh.indices = createBuffer(state, indexBytes,
+                                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uploadBuffer(state, mesh.vertices.buffer, 0, bytes, vertexBytes);
+    // التذاكر تكتمل بالترتيب، فتذكرة الفهارس تكفي للاثنين
+    mesh.ticket = uploadBuffer(state, mesh.indices.buffer, 0, bytes + vertexBytes, indexBytes);
+    return mesh;
+}
+
+bool meshReady(State *state, const Mesh &mesh) {
+    return mesh.ticket == 0 || uploadComplete(state, mesh.ticket);
+}
+
+void destroyMesh(State *state, Mesh *mesh) {
+    destroyBuffer(state, &mesh->vertices);
+    destroyBuffer(state, &mesh->indices);
+    *mesh = {};
+}
+
+const CookedMeshHeader *cookedMeshHeader(const void *data, size_t size) {
+    if (size < sizeof(CookedMeshHeader)) {
+        return nullptr;
+    }
+    const CookedMeshHeader *header = static_cast<const CookedMeshHeader *>(data);
+    bool valid = memcmp(header->magic, COOKED_MESH_MAGIC, 4) == 0 && header->version == COOKED_VERSION &&
+                 (header->indexSize == 2 || header->indexSize == 4) && header->vertexCount > 0 &&
+                 header->indexCount > 0 &&
+                 sizeof(CookedMeshHeader) + (uint64_t) header->vertexCount * sizeof(CookedVertex) +
+                 (uint64_t) header->indexCount * header->indexSize <= size;
+    return valid ? header : nullptr;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+
+#include "buffer.h"
+#include "cooked.h"
+#include "upload.h"
+
+struct State;
+
+// مجسم مطبوخ في ذاكرة الـ GPU؛ الرؤوس بصيغة CookedVertex والتفكيك يتم في الـ vertex shader
+struct Mesh {
+    Buffer vertices;
+    Buffer indices;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+    float positionOffset[3] = {};
+    float positionScale[3] = {};
+    float boundsCenter[3] = {};
+    float boundsRadius = 0.0f;
+    UploadTicket ticket = 0;
+};
+
+// data يشير إلى ما بعد CookedMeshHeader مباشرة
+Mesh createMesh(State *state, const CookedMeshHeader &header, const void *data);
+bool meshReady(State *state, const Mesh &mesh);
+void destroyMesh(State *state, Mesh *mesh);
+
+// يتحقق من الرأس وأن البيانات تكفي، ويعيد nullptr إن لم تكن صالحة
+const CookedMeshHeader *cookedMeshHeader(const void *data, size_t size);
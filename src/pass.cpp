@@ -0,0 +1,299 @@
+#include "pass.h"
+#include "state.h"
+
+#include <algorithm>
+#include <cstdio>
+
+PassImage passImage(const Image &image, VkImageAspectFlags aspectMask, VkSampleCountFlagBits samples,
+                    bool transient) {
+    return {
+        .image = image.image,
+        .view = image.view,
+        .aspectMask = aspectMask,
+        .mipLevels = image.mipLevels,
+        .format = image.format,
+        .extent = image.extent,
+        .samples = samples,
+        .transient = transient,
+    };
+}
+
+void transitionImage(BarrierBatch *batch, PassImage *image, const ImageState &next, bool discard) {
+    ImageState &current = image->state;
+    // قراءة بعد قراءة بنفس التخطيط لا تحتاج حاجزاً
+    bool readOnly = (current.access & ~(VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT |
+                                        VK_ACCESS_2_TRANSFER_READ_BIT)) == 0;
+    if (current.layout == next.layout && readOnly && current.access != VK_ACCESS_2_NONE &&
+        (next.access & ~current.access) == 0 && (next.stage & ~current.stage) == 0) {
+        return;
+    }
+    EXPECT(batch->imageCount == MAX_PASS_BARRIERS, "Too many barriers in one batch");
+    batch->images[batch->imageCount++] = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = current.stage,
+        .srcAccessMask = discard ? VK_ACCESS_2_NONE : current.access,
+        .dstStageMask = next.stage,
+        .dstAccessMask = next.access,
+        .oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : current.layout,
+        .newLayout = next.layout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image->image,
+        .subresourceRange = {
+            .aspectMask = image->aspectMask,
+            .baseMipLevel = 0,
+            .levelCount = image->mipLevels,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+    current = next;
+}
+
+void flushBarriers(VkCommandBuffer commandBuffer, BarrierBatch *batch) {
+    if (batch->imageCount == 0) {
+        return;
+    }
+    VkDependencyInfo dependencyInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = batch->imageCount,
+        .pImageMemoryBarriers = batch->images,
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+    batch->imageCount = 0;
+}
+
+static uint32_t formatBytes(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_D16_UNORM:
+            return 2;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return 8;
+        default:
+            return 4;   // صيغ الـ Swapchain الشائعة وD32 وD24S8
+    }
+}
+
+static uint64_t imageBytes(const PassImage &image) {
+    return (uint64_t) image.extent.width * image.extent.height * formatBytes(image.format) * image.samples;
+}
+
+// اختيار عمليات التحميل والتخزين من وصف الاستخدام، مع احتساب البايتات المقدرة
+static VkRenderingAttachmentInfo planAttachment(State *state, const PassAttachment &attachment) {
+    const PassImage &image = *attachment.image;
+    EXPECT(image.transient && (attachment.readsPrevious || attachment.readAfter),
+           "Transient attachment cannot be loaded or stored");
+    VkAttachmentLoadOp loadOp = attachment.readsPrevious ? VK_ATTACHMENT_LOAD_OP_LOAD
+                                : attachment.clear       ? VK_ATTACHMENT_LOAD_OP_CLEAR
+                                                         : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    // مع الحل داخل الممر تبقى العينات في ذاكرة البلاطات ولا يُكتب إلا الناتج المحلول
+    VkAttachmentStoreOp storeOp = attachment.readAfter ? VK_ATTACHMENT_STORE_OP_STORE
+                                                       : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+    PassStats &stats = state->renderTargets.frame;
+    uint64_t bytes = imageBytes(image);
+    stats.bytesLoaded += loadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? bytes : 0;
+    stats.bytesStored += storeOp == VK_ATTACHMENT_STORE_OP_STORE ? bytes : 0;
+    stats.naiveBytes += 2 * bytes;
+
+    VkRenderingAttachmentInfo info{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+        .imageView = image.view,
+        .imageLayout = image.state.layout,
+        .loadOp = loadOp,
+        .storeOp = storeOp,
+        .clearValue = attachment.clearValue,
+    };
+    if (attachment.resolve) {
+        bool depth = (image.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) != 0;
+        info.resolveMode = depth ? VK_RESOLVE_MODE_SAMPLE_ZERO_BIT : VK_RESOLVE_MODE_AVERAGE_BIT;
+        info.resolveImageView = attachment.resolve->view;
+        info.resolveImageLayout = attachment.resolve->state.layout;
+        stats.bytesStored += imageBytes(*attachment.resolve);
+        stats.naiveBytes += imageBytes(*attachment.resolve);
+    }
+    return info;
+}
+
+void beginPass(State *state, VkCommandBuffer commandBuffer, const PassDesc &desc) {
+    BarrierBatch batch;
+    for (uint32_t i = 0; i < desc.colorCount; i++) {
+        const PassAttachment &color = desc.colors[i];
+        transitionImage(&batch, color.image, IMAGE_STATE_COLOR_ATTACHMENT, !color.readsPrevious);
+        if (color.resolve) {
+            transitionImage(&batch, color.resolve, IMAGE_STATE_COLOR_ATTACHMENT, true);
+        }
+    }
+    if (desc.depth.image) {
+        transitionImage(&batch, desc.depth.image, IMAGE_STATE_DEPTH_ATTACHMENT, !desc.depth.readsPrevious);
+    }
+    flushBarriers(commandBuffer, &batch);
+
+    VkRenderingAttachmentInfo colors[MAX_PASS_COLOR_ATTACHMENTS];
+    for (uint32_t i = 0; i < desc.colorCount; i++) {
+        colors[i] = planAttachment(state, desc.colors[i]);
+    }
+    VkRenderingAttachmentInfo depth{};
+    if (desc.depth.image) {
+        depth = planAttachment(state, desc.depth);
+    }
+    state->renderTargets.frame.passes++;
+
+    VkRenderingInfo renderingInfo{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = {{0, 0}, desc.extent},
+        .layerCount = 1,
+        .colorAttachmentCount = desc.colorCount,
+        .pColorAttachments = colors,
+        .pDepthAttachment = desc.depth.image ? &depth : nullptr,
+    };
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+
+    VkViewport viewport{0, 0, (float) desc.extent.width, (float) desc.extent.height, 0, 1};
+    VkRect2D scissor{{0, 0}, desc.extent};
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void endPass(VkCommandBuffer commandBuffer) {
+    vkCmdEndRendering(commandBuffer);
+}
+
+static VkSampleCountFlagBits selectSamples(State *state, uint32_t requested) {
+    const VkPhysicalDeviceLimits &limits = state->physicalDeviceProperties.limits;
+    VkSampleCountFlags supported = limits.framebufferColorSampleCounts & limits.framebufferDepthSampleCounts;
+    uint32_t samples = 1;
+    while (samples * 2 <= requested && (supported & (samples * 2))) {
+        samples *= 2;
+    }
+    return (VkSampleCountFlagBits) samples;
+}
+
+void createRenderTargets(State *state) {
+    RenderTargets &targets = state->renderTargets;
+    for (VkFormat format : {VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D16_UNORM}) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(state->physicalDevice, format, &properties);
+        if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+            targets.depthFormat = format;
+            break;
+        }
+    }
+    EXPECT(targets.depthFormat == VK_FORMAT_UNDEFINED, "No depth attachment format");
+    targets.samples = selectSamples(state, targets.requestedSamples);
+    printf("Render targets: depth format %d, %ux MSAA\n", targets.depthFormat, targets.samples);
+}
+
+static Image createTargetImage(State *state, VkFormat format, VkExtent2D extent, VkSampleCountFlagBits samples,
+                               VkImageUsageFlags usage, VkImageAspectFlags aspectMask, bool transient) {
+    VkImageCreateInfo imageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = {extent.width, extent.height, 1},
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = samples,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = transient ? usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &state->queueFamilyIndex,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    return createImage(state, imageInfo, aspectMask, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                       transient ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0);
+}
+
+void updateRenderTargets(State *state) {
+    RenderTargets &targets = state->renderTargets;
+    targets.last = targets.frame;
+    targets.frame = {};
+    VkExtent2D extent = state->swapchainExtent;
+    float scale = targets.offscreen ? targets.renderScale : 1.0f;
+    targets.renderExtent = {
+        std::clamp((uint32_t) ((float) extent.width * scale + 0.5f), 1u, extent.width),
+        std::clamp((uint32_t) ((float) extent.height * scale + 0.5f), 1u, extent.height),
+    };
+    if (targets.extent.width == extent.width && targets.extent.height == extent.height) {
+        return;
+    }
+    destroyImage(state, &targets.depth);
+    destroyImage(state, &targets.color);
+    destroyImage(state, &targets.scene);
+    targets.extent = extent;
+    VkImageUsageFlags depthUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    if (targets.sampledDepth) {
+        depthUsage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+    }
+    targets.depth = createTargetImage(state, targets.depthFormat, extent, targets.samples, depthUsage,
+                                      VK_IMAGE_ASPECT_DEPTH_BIT, !targets.sampledDepth);
+    targets.depthTarget = passImage(targets.depth, VK_IMAGE_ASPECT_DEPTH_BIT, targets.samples, !targets.sampledDepth);
+    if (targets.samples != VK_SAMPLE_COUNT_1_BIT) {
+        targets.color = createTargetImage(state, renderTargetFormat(state), extent, targets.samples,
+                                          VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT, true);
+        targets.colorTarget = passImage(targets.color, VK_IMAGE_ASPECT_COLOR_BIT, targets.samples, true);
+    }
+    if (targets.offscreen) {
+        targets.scene = createTargetImage(state, renderTargetFormat(state), extent, VK_SAMPLE_COUNT_1_BIT,
+                                          VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                          VK_IMAGE_ASPECT_COLOR_BIT, false);
+        targets.sceneTarget = passImage(targets.scene, VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT, false);
+    }
+}
+
+void destroyRenderTargets(State *state) {
+    RenderTargets &targets = state->renderTargets;
+    destroyImage(state, &targets.depth);
+    destroyImage(state, &targets.color);
+    destroyImage(state, &targets.scene);
+    targets = {};
+}
+
+VkFormat renderTargetFormat(State *state) {
+    const RenderTargets &targets = state->renderTargets;
+    if (targets.offscreen && targets.sceneFormat != VK_FORMAT_UNDEFINED) {
+        return targets.sceneFormat;
+    }
+    return state->swapchainFormat;
+}
+
+static VkDeviceSize committedBytes(State *state, const Image &image) {
+    if (image.memory == VK_NULL_HANDLE || !(image.memoryFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)) {
+        return 0;
+    }
+    VkDeviceSize committed = 0;
+    vkGetDeviceMemoryCommitment(state->device, image.memory, &committed);
+    return committed;
+}
+
+void attachmentBenchmarkFrame(State *state) {
+    RenderTargets &targets = state->renderTargets;
+    if (targets.benchmarkFrames == 0 && targets.benchmarkTotal.passes == 0) {
+        targets.benchmarkStart = std::chrono::steady_clock::now();
+    }
+    // إحصاءات الإطار السابق؛ الجاري لم يُسجَّل بعد
+    targets.benchmarkTotal.bytesLoaded += targets.last.bytesLoaded;
+    targets.benchmarkTotal.bytesStored += targets.last.bytesStored;
+    targets.benchmarkTotal.naiveBytes += targets.last.naiveBytes;
+    targets.benchmarkTotal.passes += targets.last.passes;
+    targets.benchmarkFrames++;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - targets.benchmarkStart).count();
+    if (elapsed < 1.0) {
+        return;
+    }
+    const double MB = 1024.0 * 1024.0;
+    PassStats &total = targets.benchmarkTotal;
+    double frames = targets.benchmarkFrames;
+    bool lazy = targets.depth.memoryFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+    printf("Attachments: %.2f MB loaded, %.2f MB stored per frame (%.2f MB if every attachment were loaded and "
+           "stored), %.1f passes, transient memory %s, %llu KB committed of %llu KB\n",
+           total.bytesLoaded / frames / MB, total.bytesStored / frames / MB, total.naiveBytes / frames / MB,
+           total.passes / frames, lazy ? "lazily allocated" : "device local (no lazily allocated type)",
+           (unsigned long long) (committedBytes(state, targets.depth) + committedBytes(state, targets.color)) / 1024,
+           (unsigned long long) (targets.depth.memorySize + targets.color.memorySize) / 1024);
+    targets.benchmarkStart = std::chrono::steady_clock::now();
+    targets.benchmarkFrames = 0;
+    total = {};
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <chrono>
+#include <cstdint>
+
+#include "image.h"
+
+struct State;
+
+// آخر استخدام للصورة: يكفي لبناء حاجز sync2 دقيق نحو الاستخدام التالي بدلاً من ALL_COMMANDS
+struct ImageState {
+    VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 access = VK_ACCESS_2_NONE;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+constexpr ImageState IMAGE_STATE_COLOR_ATTACHMENT{
+    VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+    VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+};
+constexpr ImageState IMAGE_STATE_DEPTH_ATTACHMENT{
+    VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+    VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+};
+constexpr ImageState IMAGE_STATE_SHADER_READ{
+    VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+    VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+};
+constexpr ImageState IMAGE_STATE_PRESENT{
+    VK_PIPELINE_STAGE_2_NONE,
+    VK_ACCESS_2_NONE,
+    VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+};
+
+// صورة يُتتبَّع استخدامها عبر الممرات داخل الإطار
+struct PassImage {
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    uint32_t mipLevels = 1;
+    ImageState state;
+
+    // لتقدير البايتات المنقولة بين ذاكرة البلاطات والذاكرة الرئيسية
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent{};
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    bool transient = false;         // محتواه لا يعيش بعد الممر فلا يُحمَّل ولا يُخزَّن أبداً
+};
+
+PassImage passImage(const Image &image, VkImageAspectFlags aspectMask, VkSampleCountFlagBits samples,
+                    bool transient);
+
+// يجمع الحواجز ويرسلها باستدعاء vkCmdPipelineBarrier2 واحد
+constexpr uint32_t MAX_PASS_BARRIERS = 8;
+
+struct BarrierBatch {
+    VkImageMemoryBarrier2 images[MAX_PASS_BARRIERS];
+    uint32_t imageCount = 0;
+};
+
+// discard: المحتوى السابق غير مطلوب فيُنقل من UNDEFINED دون انتظار كتابته
+void transitionImage(BarrierBatch *batch, PassImage *image, const ImageState &next, bool discard = false);
+void flushBarriers(VkCommandBuffer commandBuffer, BarrierBatch *batch);
+
+// المرفق يصف كيف يُستخدم فقط؛ beginPass يختار منه عمليات التحميل والتخزين.
+// على معالجات البلاطات (Apple عبر MoltenVK) كل LOAD أو STORE غير لازم نقل كامل للصورة
+struct PassAttachment {
+    PassImage *image = nullptr;
+    PassImage *resolve = nullptr;   // حل الـ MSAA داخل الممر إلى هذه الصورة
+    bool readsPrevious = false;     // يحتاج المحتوى السابق: LOAD، وإلا CLEAR أو DONT_CARE
+    bool clear = true;
+    bool readAfter = false;         // يُقرأ بعد الممر: STORE، وإلا DONT_CARE
+    VkClearValue clearValue{};
+};
+
+constexpr uint32_t MAX_PASS_COLOR_ATTACHMENTS = 4;
+
+// المرفقات تُحدد لكل ممر عند التسجيل؛ لا VkRenderPass ولا VkFramebuffer يُعاد بناؤها مع الـ Swapchain
+struct PassDesc {
+    const char *name = "";
+    VkExtent2D extent{};
+    PassAttachment colors[MAX_PASS_COLOR_ATTACHMENTS];
+    uint32_t colorCount = 0;
+    PassAttachment depth;           // image = nullptr إن لم يوجد
+};
+
+// تقدير حركة المرفقات في الإطار الجاري؛ naive هو ما كان سيُنقل لو حُمّل وخُزّن كل مرفق
+struct PassStats {
+    uint64_t bytesLoaded = 0;
+    uint64_t bytesStored = 0;
+    uint64_t naiveBytes = 0;
+    uint32_t passes = 0;
+};
+
+// المرفقات الداخلية للممر الرئيسي: عمق و MSAA في ذاكرة مؤقتة تُخصص عند الحاجة فقط (lazily allocated)
+struct RenderTargets {
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    uint32_t requestedSamples = 1;      // --msaa <n>
+    bool sampledDepth = false;          // العمق يُخزَّن بعد الممر ويُقرأ في compute (هرم العمق)، فلا يكون مؤقتاً
+    bool offscreen = false;             // الدقة الديناميكية أو المعالجة اللاحقة: المشهد يُرسم في scene ثم يُنقل إلى الـ swapchain
+    VkFormat sceneFormat = VK_FORMAT_UNDEFINED;     // صيغة scene إن اختلفت عن الـ swapchain (HDR للمعالجة اللاحقة)
+    float renderScale = 1.0f;
+    VkExtent2D extent{};
+    VkExtent2D renderExtent{};          // الجزء المرسوم من الزاوية العليا؛ الصور بحجم extent فلا تُعاد مع كل مقياس
+    Image depth;
+    Image color;                        // فقط مع MSAA
+    Image scene;                        // فقط مع offscreen، بعينة واحدة
+    PassImage depthTarget;
+    PassImage colorTarget;
+    PassImage sceneTarget;
+
+    PassStats frame;
+    PassStats last;
+
+    // --bench attachments
+    std::chrono::steady_clock::time_point benchmarkStart;
+    uint32_t benchmarkFrames = 0;
+    PassStats benchmarkTotal;
+};
+
+// يختار صيغة العمق وعدد العينات؛ الصور نفسها تُنشأ في updateRenderTargets عند أول إطار وعند تغير الحجم
+void createRenderTargets(State *state);
+void updateRenderTargets(State *state);
+void destroyRenderTargets(State *state);
+
+// صيغة ألوان الممر الرئيسي: scene إن كان خارج الشاشة، وإلا الـ swapchain
+VkFormat renderTargetFormat(State *state);
+
+// ينقل كل المرفقات إلى حالاتها بحاجز واحد ثم vkCmdBeginRendering، ويضبط الـ viewport والـ scissor على extent
+void beginPass(State *state, VkCommandBuffer commandBuffer, const PassDesc &desc);
+void endPass(VkCommandBuffer commandBuffer);
+
+// --bench attachments: البايتات المحمّلة والمخزّنة لكل إطار، وما التزم به الـ driver من الذاكرة المؤقتة
+void attachmentBenchmarkFrame(State *state);
@@ -0,0 +1,719 @@
+#include "pipeline.h"
+#include "shader.h"
+#include "state.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static const char PIPELINE_LIST_MAGIC[4] = {'B', 'K', 'P', 'L'};
+static const uint32_t PIPELINE_LIST_VERSION = 1;
+
+static uint64_t hashBytes(const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void setPipelineShaders(PipelineDesc *desc, const char *vertexShader, const char *fragmentShader) {
+    bool tooLong = strlen(vertexShader) >= PIPELINE_SHADER_NAME_SIZE || strlen(fragmentShader) >= PIPELINE_SHADER_NAME_SIZE;
+    EXPECT(tooLong, "Shader name too long: %s / %s", vertexShader, fragmentShader);
+    memset(desc->vertexShader, 0, sizeof(desc->vertexShader));
+    memset(desc->fragmentShader, 0, sizeof(desc->fragmentShader));
+    strcpy(desc->vertexShader, vertexShader);
+    strcpy(desc->fragmentShader, fragmentShader);
+}
+
+void setPipelineFeatures(State *state, PipelineDesc *desc, uint32_t features) {
+    uint32_t declared = shaderSpecConstants(state, desc->vertexShader);
+    if (desc->fragmentShader[0]) {
+        declared |= shaderSpecConstants(state, desc->fragmentShader);
+    }
+    desc->features = features & declared;
+}
+
+uint64_t pipelineHash(const PipelineDesc &desc) {
+    uint64_t hash = hashBytes(&desc, sizeof(desc));
+    return hash != 0 ? hash : 1;    // الصفر يعني خانة فارغة
+}
+
+static std::string cachePath(State *state, const char *file) {
+    return std::string(state->pipelines.cacheDirectory) + "/" + file;
+}
+
+static std::vector<uint8_t> readFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return {};
+    }
+    std::vector<uint8_t> data((size_t) file.tellg());
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(data.data()), (std::streamsize) data.size());
+    return file ? data : std::vector<uint8_t>{};
+}
+
+// كل حالات الإنشاء مبنية من الوصف مرة واحدة؛ المسار الكامل يستخدمها كلها وأجزاء المكتبة تأخذ ما يخصها
+struct PipelineStates {
+    VkSpecializationMapEntry specializationEntries[32];
+    VkBool32 specializationData[32];
+    VkSpecializationInfo specialization;
+    VkPipelineShaderStageCreateInfo stages[2];
+    VkVertexInputBindingDescription bindings[PIPELINE_MAX_VERTEX_BINDINGS];
+    VkVertexInputAttributeDescription attributes[PIPELINE_MAX_VERTEX_ATTRIBUTES];
+    VkPipelineVertexInputStateCreateInfo vertexInput;
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+    VkPipelineViewportStateCreateInfo viewport;
+    VkPipelineRasterizationStateCreateInfo rasterization;
+    VkPipelineMultisampleStateCreateInfo multisample;
+    VkPipelineDepthStencilStateCreateInfo depthStencil;
+    VkPipelineColorBlendAttachmentState blendAttachment;
+    VkPipelineColorBlendStateCreateInfo colorBlend;
+    VkDynamicState dynamicStates[2];
+    VkPipelineDynamicStateCreateInfo dynamicState;
+    VkFormat colorFormat;
+    VkPipelineRenderingCreateInfo rendering;
+};
+
+static void fillPipelineStates(State *state, const PipelineDesc &desc, PipelineStates *states) {
+    PipelineStates &s = *states;
+    // ثابت لكل بت حتى أعلى ميزة مضبوطة؛ الثوابت التي لا يعلنها الـ shader يتجاهلها الـ driver
+    uint32_t specializationCount = 32 - (uint32_t) std::countl_zero(desc.features);
+    for (uint32_t i = 0; i < specializationCount; i++) {
+        s.specializationEntries[i] = {.constantID = i, .offset = i * 4, .size = sizeof(VkBool32)};
+        s.specializationData[i] = (desc.features >> i) & 1;
+    }
+    s.specialization = {
+        .mapEntryCount = specializationCount,
+        .pMapEntries = s.specializationEntries,
+        .dataSize = specializationCount * sizeof(VkBool32),
+        .pData = s.specializationData,
+    };
+    const VkSpecializationInfo *specialization = specializationCount ? &s.specialization : nullptr;
+    s.stages[0] = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .stage = VK_SHADER_STAGE_VERTEX_BIT,
+        .module = getShaderModule(state, desc.vertexShader),
+        .pName = "main",
+        .pSpecializationInfo = specialization,
+    };
+    s.stages[1] = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .module = desc.fragmentShader[0] ? getShaderModule(state, desc.fragmentShader) : VK_NULL_HANDLE,
+        .pName = "main",
+        .pSpecializationInfo = specialization,
+    };
+    for (uint32_t i = 0; i < desc.bindingCount; i++) {
+        s.bindings[i] = {
+            .binding = i,
+            .stride = desc.bindings[i].stride,
+            .inputRate = (VkVertexInputRate) desc.bindings[i].inputRate,
+        };
+    }
+    for (uint32_t i = 0; i < desc.attributeCount; i++) {
+        s.attributes[i] = {
+            .location = desc.attributes[i].location,
+            .binding = desc.attributes[i].binding,
+            .format = (VkFormat) desc.attributes[i].format,
+            .offset = desc.attributes[i].offset,
+        };
+    }
+    s.vertexInput = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = desc.bindingCount,
+        .pVertexBindingDescriptions = s.bindings,
+        .vertexAttributeDescriptionCount = desc.attributeCount,
+        .pVertexAttributeDescriptions = s.attributes,
+    };
+    s.inputAssembly = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = (VkPrimitiveTopology) desc.topology,
+    };
+    s.viewport = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .scissorCount = 1,
+    };
+    s.rasterization = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = (VkPolygonMode) desc.polygonMode,
+        .cullMode = (VkCullModeFlags) desc.cullMode,
+        .frontFace = (VkFrontFace) desc.frontFace,
+        .lineWidth = 1.0f,
+    };
+    s.multisample = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = (VkSampleCountFlagBits) desc.samples,
+    };
+    s.depthStencil = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = desc.depthTest,
+        .depthWriteEnable = desc.depthWrite,
+        .depthCompareOp = (VkCompareOp) desc.depthCompare,
+    };
+
+    s.blendAttachment = {
+        .blendEnable = desc.blend != BlendMode::Opaque,
+        .colorBlendOp = VK_BLEND_OP_ADD,
+        .alphaBlendOp = VK_BLEND_OP_ADD,
+        .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+                          VK_COLOR_COMPONENT_A_BIT,
+    };
+    VkPipelineColorBlendAttachmentState &blendAttachment = s.blendAttachment;
+    switch (desc.blend) {
+        case BlendMode::Opaque:
+            break;
+        case BlendMode::Alpha:
+            blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            break;
+        case BlendMode::Additive:
+            blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+            blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            break;
+        case BlendMode::Premultiplied:
+            blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            break;
+    }
+    bool hasColor = desc.colorFormat != VK_FORMAT_UNDEFINED;
+    s.colorBlend = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .attachmentCount = hasColor ? 1u : 0u,
+        .pAttachments = &s.blendAttachment,
+    };
+    s.dynamicStates[0] = VK_DYNAMIC_STATE_VIEWPORT;
+    s.dynamicStates[1] = VK_DYNAMIC_STATE_SCISSOR;
+    s.dynamicState = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = 2,
+        .pDynamicStates = s.dynamicStates,
+    };
+    s.colorFormat = (VkFormat) desc.colorFormat;
+    s.rendering = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = hasColor ? 1u : 0u,
+        .pColorAttachmentFormats = &s.colorFormat,
+        .depthAttachmentFormat = (VkFormat) desc.depthFormat,
+    };
+}
+
+static VkPipeline compilePipeline(State *state, const PipelineDesc &desc, VkPipelineLayout layout) {
+    PipelineStates s;
+    fillPipelineStates(state, desc, &s);
+    VkGraphicsPipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &s.rendering,
+        .stageCount = desc.fragmentShader[0] ? 2u : 1u,
+        .pStages = s.stages,
+        .pVertexInputState = &s.vertexInput,
+        .pInputAssemblyState = &s.inputAssembly,
+        .pViewportState = &s.viewport,
+        .pRasterizationState = &s.rasterization,
+        .pMultisampleState = &s.multisample,
+        .pDepthStencilState = &s.depthStencil,
+        .pColorBlendState = &s.colorBlend,
+        .pDynamicState = &s.dynamicState,
+        .layout = layout,
+    };
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = vkCreateGraphicsPipelines(state->device, state->pipelines.cache, 1, &pipelineInfo,
+                                                state->allocator, &pipeline);
+    return result == VK_SUCCESS ? pipeline : VK_NULL_HANDLE;
+}
+
+// أجزاء VK_EXT_graphics_pipeline_library بالترتيب الذي تُربط به
+static const VkGraphicsPipelineLibraryFlagsEXT LIBRARY_PARTS[4] = {
+    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+};
+
+// مفتاح الجزء هو تجزئة الحقول التي يعتمد عليها فقط، فالمواد التي تختلف في المزج مثلاً تشارك بقية الأجزاء
+static uint64_t libraryPartKey(const PipelineDesc &desc, uint32_t part) {
+    PipelineDesc key{};
+    key.reserved[0] = part + 1;
+    switch (part) {
+        case 0:
+            key.topology = desc.topology;
+            key.bindingCount = desc.bindingCount;
+            key.attributeCount = desc.attributeCount;
+            memcpy(key.bindings, desc.bindings, sizeof(key.bindings));
+            memcpy(key.attributes, desc.attributes, sizeof(key.attributes));
+            break;
+        case 1:
+            memcpy(key.vertexShader, desc.vertexShader, sizeof(key.vertexShader));
+            key.topology = desc.topology;       // gl_PointSize وبعض المعالجات تبني الـ vertex shader حسب نوع الأوليات
+            key.features = desc.features;
+            key.layout = desc.layout;
+            key.polygonMode = desc.polygonMode;
+            key.cullMode = desc.cullMode;
+            key.frontFace = desc.frontFace;
+            break;
+        case 2:
+            memcpy(key.fragmentShader, desc.fragmentShader, sizeof(key.fragmentShader));
+            key.features = desc.features;
+            key.layout = desc.layout;
+            key.depthTest = desc.depthTest;
+            key.depthWrite = desc.depthWrite;
+            key.depthCompare = desc.depthCompare;
+            key.depthFormat = desc.depthFormat;
+            key.samples = desc.samples;
+            break;
+        case 3:
+            key.blend = desc.blend;
+            key.colorFormat = desc.colorFormat;
+            key.depthFormat = desc.depthFormat;
+            key.samples = desc.samples;
+            break;
+    }
+    return pipelineHash(key);
+}
+
+static VkPipeline createLibraryPart(State *state, const PipelineDesc &desc, VkPipelineLayout layout, uint32_t part) {
+    PipelineStates s;
+    fillPipelineStates(state, desc, &s);
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+        .pNext = &s.rendering,
+        .flags = LIBRARY_PARTS[part],
+    };
+    VkGraphicsPipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryInfo,
+        .flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT,
+    };
+    switch (part) {
+        case 0:
+            pipelineInfo.pVertexInputState = &s.vertexInput;
+            pipelineInfo.pInputAssemblyState = &s.inputAssembly;
+            break;
+        case 1:
+            pipelineInfo.stageCount = 1;
+            pipelineInfo.pStages = &s.stages[0];
+            pipelineInfo.pViewportState = &s.viewport;
+            pipelineInfo.pRasterizationState = &s.rasterization;
+            pipelineInfo.pDynamicState = &s.dynamicState;
+            pipelineInfo.layout = layout;
+            break;
+        case 2:
+            pipelineInfo.stageCount = desc.fragmentShader[0] ? 1u : 0u;
+            pipelineInfo.pStages = &s.stages[1];
+            pipelineInfo.pMultisampleState = &s.multisample;
+            pipelineInfo.pDepthStencilState = &s.depthStencil;
+            pipelineInfo.layout = layout;
+            break;
+        case 3:
+            pipelineInfo.pMultisampleState = &s.multisample;
+            pipelineInfo.pColorBlendState = &s.colorBlend;
+            break;
+    }
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = vkCreateGraphicsPipelines(state->device, state->pipelines.cache, 1, &pipelineInfo,
+                                                state->allocator, &pipeline);
+    return result == VK_SUCCESS ? pipeline : VK_NULL_HANDLE;
+}
+
+static VkPipeline getLibraryPart(State *state, const PipelineDesc &desc, VkPipelineLayout layout, uint32_t part) {
+    PipelineManager &manager = state->pipelines;
+    uint64_t key = libraryPartKey(desc, part);
+    {
+        std::lock_guard<std::mutex> lock(manager.libraryMutex);
+        auto found = manager.libraries.find(key);
+        if (found != manager.libraries.end()) {
+            return found->second;
+        }
+    }
+    // يُبنى خارج القفل؛ إن سبقنا خيط آخر لنفس الجزء نحتفظ بنسخته
+    VkPipeline library = createLibraryPart(state, desc, layout, part);
+    if (library == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+    std::lock_guard<std::mutex> lock(manager.libraryMutex);
+    auto [found, inserted] = manager.libraries.emplace(key, library);
+    if (!inserted) {
+        vkDestroyPipeline(state->device, library, state->allocator);
+    }
+    return found->second;
+}
+
+static VkPipeline linkPipeline(State *state, const PipelineDesc &desc, VkPipelineLayout layout, bool optimize) {
+    VkPipeline parts[4];
+    for (uint32_t part = 0; part < 4; part++) {
+        parts[part] = getLibraryPart(state, desc, layout, part);
+        if (parts[part] == VK_NULL_HANDLE) {
+            return VK_NULL_HANDLE;
+        }
+    }
+    VkPipelineLibraryCreateInfoKHR libraryInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+        .libraryCount = 4,
+        .pLibraries = parts,
+    };
+    VkGraphicsPipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryInfo,
+        .flags = optimize ? (VkPipelineCreateFlags) VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0u,
+        .layout = layout,
+    };
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = vkCreateGraphicsPipelines(state->device, state->pipelines.cache, 1, &pipelineInfo,
+                                                state->allocator, &pipeline);
+    return result == VK_SUCCESS ? pipeline : VK_NULL_HANDLE;
+}
+
+static void compilerMain(State *state) {
+    PipelineManager &manager = state->pipelines;
+    while (true) {
+        PipelineJob job;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        {
+            std::unique_lock<std::mutex> lock(manager.mutex);
+            manager.wake.wait(lock, [&] { return manager.stopping || !manager.queue.empty(); });
+            if (manager.stopping) {
+                // ما بقي في الطابور لن يُترجم أبداً؛ يُحذف من العداد حتى لا ينتظره أحد
+                manager.pending.fetch_sub((uint32_t) manager.queue.size(), std::memory_order_relaxed);
+                manager.queue.clear();
+                return;
+            }
+            job = manager.queue.front();
+            manager.queue.pop_front();
+            auto found = manager.layouts.find(job.desc.layout);
+            layout = found != manager.layouts.end() ? found->second : VK_NULL_HANDLE;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (layout != VK_NULL_HANDLE) {
+            pipeline = job.kind == PipelineJobKind::Compile
+                           ? compilePipeline(state, job.desc, layout)
+                           : linkPipeline(state, job.desc, layout, job.kind == PipelineJobKind::Optimize);
+        }
+        auto end = std::chrono::steady_clock::now();
+        manager.pending.fetch_sub(1, std::memory_order_relaxed);
+
+        if (job.kind == PipelineJobKind::Optimize) {
+            // فشل التحسين ليس خطأ: الرابط السريع يبقى مستخدماً
+            if (pipeline != VK_NULL_HANDLE) {
+                VkPipeline fast = job.slot->pipeline.exchange(pipeline, std::memory_order_acq_rel);
+                std::lock_guard<std::mutex> lock(manager.mutex);
+                manager.retired.push_back(fast);
+                manager.optimized.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+        if (pipeline == VK_NULL_HANDLE) {
+            std::cerr << "Failed to compile pipeline " << job.desc.vertexShader << " + " << job.desc.fragmentShader
+                      << std::endl;
+            job.slot->failed.store(true, std::memory_order_release);
+            continue;
+        }
+        job.slot->readyMs = std::chrono::duration<double, std::milli>(end - job.slot->requested).count();
+        manager.compileMicroseconds.fetch_add(
+            (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+            std::memory_order_relaxed);
+        job.slot->pipeline.store(pipeline, std::memory_order_release);
+        if (job.kind == PipelineJobKind::Compile) {
+            manager.compiled.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        manager.linked.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(manager.mutex);
+            manager.pending.fetch_add(1, std::memory_order_relaxed);
+            manager.queue.push_back({job.desc, job.slot, PipelineJobKind::Optimize});
+        }
+        manager.wake.notify_one();
+    }
+}
+
+void createPipelineManager(State *state) {
+    PipelineManager &manager = state->pipelines;
+    manager.slots = std::make_unique<PipelineSlot[]>(PIPELINE_TABLE_CAPACITY);
+    manager.useLibraries = state->graphicsPipelineLibrary;
+
+    // بيانات الـ cache يتحقق منها الـ driver بنفسه (المعرّف والإصدار في رأسها) ويتجاهلها إن لم تطابق
+    std::vector<uint8_t> cacheData;
+    if (manager.cacheDirectory) {
+        cacheData = readFile(cachePath(state, "pipeline_cache.bin"));
+        std::vector<uint8_t> list = readFile(cachePath(state, "pipelines.bin"));
+        uint32_t count = 0;
+        if (list.size() >= 12 && memcmp(list.data(), PIPELINE_LIST_MAGIC, 4) == 0 &&
+            memcmp(list.data() + 4, &PIPELINE_LIST_VERSION, 4) == 0) {
+            memcpy(&count, list.data() + 8, 4);
+            count = list.size() == 12 + (size_t) count * sizeof(PipelineDesc) ? count : 0;
+        }
+        manager.precompile.resize(count);
+        if (count > 0) {
+            memcpy(manager.precompile.data(), list.data() + 12, (size_t) count * sizeof(PipelineDesc));
+        }
+    }
+    VkPipelineCacheCreateInfo cacheInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = cacheData.size(),
+        .pInitialData = cacheData.empty() ? nullptr : cacheData.data(),
+    };
+    VkResult result = vkCreatePipelineCache(state->device, &cacheInfo, state->allocator, &manager.cache);
+    EXPECT(result != VK_SUCCESS, "Failed to create pipeline cache");
+
+    uint32_t threadCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        manager.threads.emplace_back(compilerMain, state);
+    }
+    std::cout << "Pipeline manager: " << threadCount << " compile threads, "
+              << (manager.useLibraries ? "pipeline libraries, " : "monolithic pipelines, ") << cacheData.size() / 1024
+              << " KB cache, " << manager.precompile.size() << " recorded pipelines" << std::endl;
+}
+
+static PipelineSlot *findSlot(PipelineManager &manager, uint64_t key) {
+    for (uint32_t i = 0, index = key & (PIPELINE_TABLE_CAPACITY - 1); i < PIPELINE_TABLE_CAPACITY;
+         i++, index = (index + 1) & (PIPELINE_TABLE_CAPACITY - 1)) {
+        uint64_t existing = manager.slots[index].key.load(std::memory_order_acquire);
+        if (existing == key) {
+            return &manager.slots[index];
+        }
+        if (existing == 0) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+static void saveCache(State *state) {
+    PipelineManager &manager = state->pipelines;
+    size_t size = 0;
+    vkGetPipelineCacheData(state->device, manager.cache, &size, nullptr);
+    std::vector<uint8_t> data(size);
+    if (size > 0 && vkGetPipelineCacheData(state->device, manager.cache, &size, data.data()) == VK_SUCCESS) {
+        std::ofstream file(cachePath(state, "pipeline_cache.bin"), std::ios::binary);
+        file.write(reinterpret_cast<const char *>(data.data()), (std::streamsize) size);
+    }
+
+    // فقط ما تُرجم بنجاح
+    std::vector<PipelineDesc> list;
+    for (const PipelineDesc &desc : manager.recorded) {
+        PipelineSlot *slot = findSlot(manager, pipelineHash(desc));
+        if (slot && slot->pipeline.load(std::memory_order_relaxed) != VK_NULL_HANDLE) {
+            list.push_back(desc);
+        }
+    }
+    std::ofstream file(cachePath(state, "pipelines.bin"), std::ios::binary);
+    uint32_t count = (uint32_t) list.size();
+    file.write(PIPELINE_LIST_MAGIC, 4);
+    file.write(reinterpret_cast<const char *>(&PIPELINE_LIST_VERSION), 4);
+    file.write(reinterpret_cast<const char *>(&count), 4);
+    file.write(reinterpret_cast<const char *>(list.data()), (std::streamsize) (list.size() * sizeof(PipelineDesc)));
+    std::cout << "Pipeline cache: saved " << size / 1024 << " KB and " << count << " pipelines" << std::endl;
+}
+
+void destroyPipelineManager(State *state) {
+    PipelineManager &manager = state->pipelines;
+    {
+        std::lock_guard<std::mutex> lock(manager.mutex);
+        manager.stopping = true;
+    }
+    manager.wake.notify_all();
+    for (std::thread &thread : manager.threads) {
+        thread.join();
+    }
+    manager.threads.clear();
+    if (!manager.slots) {
+        return;
+    }
+
+    uint32_t ready = manager.compiled.load() + manager.linked.load();
+    if (ready > 0) {
+        printf("Pipelines: %u compiled, %u linked (%u optimized, %zu library parts), %.2f ms average to first use, "
+               "%u draws waited on a pipeline\n",
+               manager.compiled.load(), manager.linked.load(), manager.optimized.load(), manager.libraries.size(),
+               (double) manager.compileMicroseconds.load() / 1000.0 / ready, manager.misses);
+    }
+    if (manager.cacheDirectory) {
+        saveCache(state);
+    }
+    for (uint32_t i = 0; i < PIPELINE_TABLE_CAPACITY; i++) {
+        deferDestroy(state, manager.slots[i].pipeline.load());
+    }
+    for (VkPipeline pipeline : manager.retired) {
+        deferDestroy(state, pipeline);
+    }
+    for (auto &[key, library] : manager.libraries) {
+        deferDestroy(state, library);
+    }
+    vkDestroyPipelineCache(state->device, manager.cache, state->allocator);
+    manager.cache = VK_NULL_HANDLE;
+    manager.slots.reset();
+    manager.queue.clear();
+    manager.layouts.clear();
+    manager.recorded.clear();
+    manager.retired.clear();
+    manager.libraries.clear();
+}
+
+void pipelinePump(State *state) {
+    PipelineManager &manager = state->pipelines;
+    std::vector<VkPipeline> retired;
+    {
+        std::lock_guard<std::mutex> lock(manager.mutex);
+        retired.swap(manager.retired);
+    }
+    // الإطارات المرسلة قد تستخدم الرابط السريع، فيُحرَّر بعد اكتمالها
+    for (VkPipeline pipeline : retired) {
+        deferDestroy(state, pipeline);
+    }
+}
+
+uint64_t registerPipelineLayout(State *state, const char *name, VkPipelineLayout layout) {
+    PipelineManager &manager = state->pipelines;
+    uint64_t id = hashBytes(name, strlen(name));
+    std::lock_guard<std::mutex> lock(manager.mutex);
+    manager.layouts[id] = layout;
+    return id;
+}
+
+static PipelineSlot *requestPipeline(State *state, const PipelineDesc &desc, PipelineJobKind kind) {
+    PipelineManager &manager = state->pipelines;
+    uint64_t key = pipelineHash(desc);
+    uint32_t index = key & (PIPELINE_TABLE_CAPACITY - 1);
+    for (uint32_t probe = 0; probe < PIPELINE_TABLE_CAPACITY; probe++) {
+        PipelineSlot &slot = manager.slots[index];
+        uint64_t existing = slot.key.load(std::memory_order_acquire);
+        if (existing == key) {
+            return &slot;
+        }
+        if (existing == 0) {
+            // الخيط الذي يحجز الخانة هو الوحيد الذي يضيف مهمة الترجمة
+            if (slot.key.compare_exchange_strong(existing, key, std::memory_order_acq_rel)) {
+                slot.requested = std::chrono::steady_clock::now();
+                {
+                    std::lock_guard<std::mutex> lock(manager.mutex);
+                    manager.pending.fetch_add(1, std::memory_order_relaxed);
+                    manager.queue.push_back({desc, &slot, kind});
+                    manager.recorded.push_back(desc);
+                }
+                manager.wake.notify_one();
+                return &slot;
+            }
+            if (existing == key) {
+                return &slot;
+            }
+        }
+        index = (index + 1) & (PIPELINE_TABLE_CAPACITY - 1);
+    }
+    EXPECT(true, "Pipeline table is full (%u entries)", PIPELINE_TABLE_CAPACITY);
+    return nullptr;
+}
+
+PipelineSlot *requestPipeline(State *state, const PipelineDesc &desc) {
+    PipelineJobKind kind = state->pipelines.useLibraries ? PipelineJobKind::Link : PipelineJobKind::Compile;
+    return requestPipeline(state, desc, kind);
+}
+
+VkPipeline getPipeline(State *state, const PipelineDesc &desc) {
+    VkPipeline pipeline = requestPipeline(state, desc)->pipeline.load(std::memory_order_acquire);
+    state->pipelines.misses += pipeline == VK_NULL_HANDLE;
+    return pipeline;
+}
+
+VkPipeline getPipeline(State *state, const PipelineDesc &desc, const PipelineDesc &fallback) {
+    VkPipeline pipeline = requestPipeline(state, desc)->pipeline.load(std::memory_order_acquire);
+    if (pipeline != VK_NULL_HANDLE) {
+        return pipeline;
+    }
+    return getPipeline(state, fallback);
+}
+
+void pipelinePrecompile(State *state) {
+    PipelineManager &manager = state->pipelines;
+    uint32_t skipped = 0;
+    for (const PipelineDesc &desc : manager.precompile) {
+        bool known;
+        {
+            std::lock_guard<std::mutex> lock(manager.mutex);
+            known = manager.layouts.count(desc.layout) > 0;
+        }
+        if (known) {
+            requestPipeline(state, desc);
+        } else {
+            skipped++;
+        }
+    }
+    if (!manager.precompile.empty()) {
+        std::cout << "Pipeline precompile: " << manager.precompile.size() - skipped << " queued, " << skipped
+                  << " with unknown layouts skipped" << std::endl;
+    }
+    manager.precompile.clear();
+}
+
+void pipelineBenchmarkFrame(State *state) {
+    PipelineManager &manager = state->pipelines;
+    const uint32_t MATERIALS = 32;
+    auto now = std::chrono::steady_clock::now();
+
+    // الرسم الأول ممكن في أول إطار يجد فيه الـ pipeline جاهزاً
+    if (PipelineSlot *slot = manager.benchmarkSlot) {
+        bool failed = slot->failed.load(std::memory_order_acquire);
+        if (slot->pipeline.load(std::memory_order_acquire) == VK_NULL_HANDLE && !failed) {
+            return;
+        }
+        uint32_t path = manager.benchmarkPath;
+        double ms = std::chrono::duration<double, std::milli>(now - slot->requested).count();
+        if (!failed) {
+            manager.benchmarkReadyMs[path] += ms;
+            manager.benchmarkWorstMs[path] = std::max(manager.benchmarkWorstMs[path], ms);
+            manager.benchmarkCount[path]++;
+        }
+        manager.benchmarkSlot = nullptr;
+    }
+    if (manager.benchmarkIndex > MATERIALS) {
+        return;
+    }
+    if (manager.benchmarkIndex == MATERIALS) {
+        manager.benchmarkIndex++;
+        for (uint32_t path = 0; path < 2; path++) {
+            uint32_t count = std::max(manager.benchmarkCount[path], 1u);
+            if (manager.benchmarkCount[path] > 0) {
+                printf("Time to first draw (%s): %.2f ms average, %.2f ms worst over %u new materials\n",
+                       path == 0 ? "full compile" : "library link", manager.benchmarkReadyMs[path] / count,
+                       manager.benchmarkWorstMs[path], manager.benchmarkCount[path]);
+            }
+        }
+        if (!manager.useLibraries) {
+            printf("Pipeline libraries are not supported on this device; only the full compile path was measured\n");
+        }
+        return;
+    }
+
+    // مواد جديدة مبنية على الـ sprite: كل مادة تختلف في المزج أو متغير الـ shader أو الحذف، والمساران بالتناوب
+    while (manager.benchmarkIndex < MATERIALS) {
+        uint32_t index = manager.benchmarkIndex++;
+        PipelineDesc desc = state->sprites.pipeline;
+        desc.colorFormat = renderTargetFormat(state);
+        desc.blend = (BlendMode) (index % 4);
+        setPipelineVariant(state, &desc, ShaderVariant<SpriteFeature>{}
+                                             .with(SpriteFeature::AlphaTest, (index / 4) & 1)
+                                             .with(SpriteFeature::Grayscale, (index / 8) & 1));
+        desc.cullMode = (index / 16) % 2 ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_NONE;
+        if (findSlot(manager, pipelineHash(desc))) {
+            continue;   // موجود مسبقاً فليس مادة جديدة
+        }
+        bool library = manager.useLibraries && index % 2 == 1;
+        manager.benchmarkSlot = requestPipeline(state, desc, library ? PipelineJobKind::Link : PipelineJobKind::Compile);
+        manager.benchmarkPath = library ? 1 : 0;
+        return;
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "shader.h"
+
+struct State;
+
+constexpr uint32_t PIPELINE_MAX_VERTEX_BINDINGS = 8;
+constexpr uint32_t PIPELINE_MAX_VERTEX_ATTRIBUTES = 16;
+constexpr uint32_t PIPELINE_SHADER_NAME_SIZE = 32;
+constexpr uint32_t PIPELINE_TABLE_CAPACITY = 4096;     // قوة للعدد 2؛ الجدول لا يكبر
+
+enum class BlendMode : uint32_t {
+    Opaque,
+    Alpha,
+    Additive,
+    Premultiplied,
+};
+
+struct PipelineVertexBinding {
+    uint32_t stride;
+    uint32_t inputRate;         // VkVertexInputRate
+};
+
+struct PipelineVertexAttribute {
+    uint32_t location;
+    uint32_t binding;
+    uint32_t format;            // VkFormat
+    uint32_t offset;
+};
+
+// وصف كامل لحالة الـ pipeline بدون حشو ولا مؤشرات: يُجزأ كبايتات ويُحفظ في قائمة الـ PSO كما هو.
+// الـ viewport والـ scissor ديناميكيان دائماً
+struct PipelineDesc {
+    char vertexShader[PIPELINE_SHADER_NAME_SIZE] = {};
+    char fragmentShader[PIPELINE_SHADER_NAME_SIZE] = {};
+    uint64_t layout = 0;                                // من registerPipelineLayout
+    uint32_t topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    uint32_t polygonMode = VK_POLYGON_MODE_FILL;
+    uint32_t cullMode = VK_CULL_MODE_NONE;
+    uint32_t frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    BlendMode blend = BlendMode::Opaque;
+    uint32_t depthTest = 0;
+    uint32_t depthWrite = 0;
+    uint32_t depthCompare = VK_COMPARE_OP_GREATER_OR_EQUAL;
+    uint32_t colorFormat = VK_FORMAT_UNDEFINED;
+    uint32_t depthFormat = VK_FORMAT_UNDEFINED;
+    uint32_t samples = VK_SAMPLE_COUNT_1_BIT;
+    uint32_t bindingCount = 0;
+    uint32_t attributeCount = 0;
+    uint32_t features = 0;                              // البت i هو قيمة ثابت التخصيص constant_id = i
+    uint32_t reserved[2] = {};
+    PipelineVertexBinding bindings[PIPELINE_MAX_VERTEX_BINDINGS] = {};
+    PipelineVertexAttribute attributes[PIPELINE_MAX_VERTEX_ATTRIBUTES] = {};
+};
+
+static_assert(std::has_unique_object_representations_v<PipelineDesc>, "PipelineDesc must not contain padding");
+
+void setPipelineShaders(PipelineDesc *desc, const char *vertexShader, const char *fragmentShader);
+uint64_t pipelineHash(const PipelineDesc &desc);
+
+// بعد setPipelineShaders: الميزات التي لا يعلنها أي من الـ shaders تُحذف من المفتاح،
+// فالمتغيرات التي لا تختلف إلا فيها تشترك في pipeline واحد
+void setPipelineFeatures(State *state, PipelineDesc *desc, uint32_t features);
+
+template<typename Feature>
+void setPipelineVariant(State *state, PipelineDesc *desc, ShaderVariant<Feature> variant) {
+    setPipelineFeatures(state, desc, variant.bits);
+}
+
+// خانة في جدول مفتوح العنونة: المفتاح يُحجز بـ CAS والـ pipeline يُنشر بـ release بعد الترجمة،
+// فالقراءة من أي خيط بدون أقفال
+struct PipelineSlot {
+    std::atomic<uint64_t> key{0};
+    std::atomic<VkPipeline> pipeline{VK_NULL_HANDLE};
+    std::atomic<bool> failed{false};
+    std::chrono::steady_clock::time_point requested;
+    double readyMs = 0.0;       // من الطلب حتى أول pipeline قابل للرسم
+};
+
+enum class PipelineJobKind : uint8_t {
+    Compile,        // pipeline كامل دفعة واحدة
+    Link,           // ربط سريع من أجزاء المكتبة (تُبنى الناقصة منها أولاً)
+    Optimize,       // ربط محسّن في الخلفية يحل محل الربط السريع
+};
+
+struct PipelineJob {
+    PipelineDesc desc;
+    PipelineSlot *slot;
+    PipelineJobKind kind;
+};
+
+struct PipelineManager {
+    std::unique_ptr<PipelineSlot[]> slots;
+    VkPipelineCache cache = VK_NULL_HANDLE;     // مشترك بين خيوط الترجمة، والـ driver يزامنه داخلياً
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<PipelineJob> queue;
+    bool stopping = false;
+
+    std::unordered_map<uint64_t, VkPipelineLayout> layouts;     // تحت mutex
+    std::vector<PipelineDesc> recorded;                         // كل وصف طُلب، تحت mutex
+    std::vector<PipelineDesc> precompile;                       // من الجلسة السابقة
+
+    // VK_EXT_graphics_pipeline_library: الأجزاء الأربعة تُخزن منفصلة وتُشارك بين الـ pipelines
+    bool useLibraries = false;
+    std::mutex libraryMutex;
+    std::unordered_map<uint64_t, VkPipeline> libraries;
+    std::vector<VkPipeline> retired;            // روابط سريعة استُبدلت، تحت mutex حتى pipelinePump
+
+    const char *cacheDirectory = nullptr;       // --pipeline-cache <dir>
+    std::atomic<uint32_t> compiled{0};
+    std::atomic<uint32_t> linked{0};
+    std::atomic<uint32_t> optimized{0};
+    std::atomic<uint32_t> pending{0};
+    std::atomic<uint64_t> compileMicroseconds{0};
+    uint32_t misses = 0;                        // طلبات أُعيد فيها بديل أو لا شيء
+
+    // --bench pipeline
+    uint32_t benchmarkIndex = 0;
+    PipelineSlot *benchmarkSlot = nullptr;
+    uint32_t benchmarkPath = 0;                 // مسار benchmarkSlot عند طلبه: 0 كامل، 1 مكتبة
+    double benchmarkReadyMs[2] = {};            // [0] كامل، [1] مكتبة
+    double benchmarkWorstMs[2] = {};
+    uint32_t benchmarkCount[2] = {};
+};
+
+void createPipelineManager(State *state);
+void destroyPipelineManager(State *state);
+
+// مرة في كل إطار: يسلّم الروابط السريعة المستبدلة لطابور التدمير
+void pipelinePump(State *state);
+
+// يُستدعى بعد تسجيل كل التخطيطات: يبدأ ترجمة قائمة الـ PSO المسجلة في الجلسة السابقة
+void pipelinePrecompile(State *state);
+
+uint64_t registerPipelineLayout(State *state, const char *name, VkPipelineLayout layout);
+
+// VK_NULL_HANDLE إن لم يكتمل بعد (والترجمة تبدأ في الخلفية)؛ على المستدعي تخطي الرسم أو استخدام بديل
+VkPipeline getPipeline(State *state, const PipelineDesc &desc);
+VkPipeline getPipeline(State *state, const PipelineDesc &desc, const PipelineDesc &fallback);
+PipelineSlot *requestPipeline(State *state, const PipelineDesc &desc);
+
+// --bench pipeline: زمن أول رسم لمادة جديدة بالمسارين بالتناوب
+void pipelineBenchmarkFrame(State *state);
@@ -0,0 +1,484 @@
+#include "post.h"
+#include "descriptors.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// يطابق BloomConstants في shaders/bloom.glsl
+struct BloomConstants {
+    float sourceUvScale[2];
+    float sourceUvMax[2];
+    float sourceTexel[2];
+    int32_t targetSize[2];
+    float threshold;
+    float knee;
+    uint32_t prefilter;
+    float reserved;
+};
+
+// يطابق FinalConstants في shaders/post_final.comp
+struct FinalConstants {
+    float uvScale[2];
+    float uvMax[2];
+    float bloomTexel[2];
+    int32_t outputSize[2];
+    float exposure;
+    float bloomIntensity;
+    float saturation;
+    float contrast;
+    float tint[3];
+    uint32_t encodeSrgb;
+};
+
+static_assert(sizeof(FinalConstants) == 64, "FinalConstants layout");
+
+enum BloomBinding : uint32_t {
+    BLOOM_BINDING_SOURCE,
+    BLOOM_BINDING_TARGET,
+    BLOOM_BINDING_TOTAL,
+};
+
+enum FinalBinding : uint32_t {
+    FINAL_BINDING_SCENE,
+    FINAL_BINDING_BLOOM,
+    FINAL_BINDING_OUTPUT,
+    FINAL_BINDING_TOTAL,
+};
+
+// مستويات الـ bloom تُقرأ وتُكتب في GENERAL طوال السلسلة؛ بين الـ dispatches حواجز ذاكرة فقط
+constexpr ImageState POST_STATE_STORAGE{
+    VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+    VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+    VK_IMAGE_LAYOUT_GENERAL,
+};
+constexpr ImageState POST_STATE_BLIT_SOURCE{
+    VK_PIPELINE_STAGE_2_BLIT_BIT,
+    VK_ACCESS_2_TRANSFER_READ_BIT,
+    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+};
+constexpr ImageState POST_STATE_BLIT_TARGET{
+    VK_PIPELINE_STAGE_2_BLIT_BIT,
+    VK_ACCESS_2_TRANSFER_WRITE_BIT,
+    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+};
+
+constexpr VkFormat POST_HDR_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+static bool formatSupports(State *state, VkFormat format, VkFormatFeatureFlags features) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(state->physicalDevice, format, &properties);
+    return (properties.optimalTilingFeatures & features) == features;
+}
+
+static bool isSrgb(VkFormat format) {
+    return format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_R8G8B8A8_SRGB ||
+           format == VK_FORMAT_A8B8G8R8_SRGB_PACK32;
+}
+
+static VkDescriptorSetLayout createSetLayout(State *state, const VkDescriptorType *types, uint32_t bindingCount) {
+    VkDescriptorSetLayoutBinding bindings[FINAL_BINDING_TOTAL];
+    for (uint32_t i = 0; i < bindingCount; i++) {
+        bindings[i] = {
+            .binding = i,
+            .descriptorType = types[i],
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        };
+    }
+    return getDescriptorSetLayout(state, bindings, bindingCount);
+}
+
+static VkPipelineLayout createPipelineLayout(State *state, VkDescriptorSetLayout setLayout, uint32_t pushSize) {
+    VkPushConstantRange pushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = pushSize,
+    };
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &setLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
+    };
+    VkPipelineLayout layout;
+    VkResult result = vkCreatePipelineLayout(state->device, &pipelineLayoutInfo, state->allocator, &layout);
+    EXPECT(result != VK_SUCCESS, "Failed to create post-processing pipeline layout");
+    return layout;
+}
+
+static VkPipeline createComputePipeline(State *state, const char *shader, VkPipelineLayout layout) {
+    VkComputePipelineCreateInfo computeInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = getShaderModule(state, shader),
+            .pName = "main",
+        },
+        .layout = layout,
+    };
+    VkPipeline pipeline;
+    VkResult result = vkCreateComputePipelines(state->device, state->pipelines.cache, 1, &computeInfo,
+                                               state->allocator, &pipeline);
+    EXPECT(result != VK_SUCCESS, "Failed to create compute pipeline %s", shader);
+    return pipeline;
+}
+
+void createPost(State *state) {
+    Post &post = state->post;
+    if (!post.requested) {
+        return;
+    }
+    // صور الـ swapchain BGRA غالباً، ولا صيغة GLSL لها؛ الكتابة بلا صيغة تغطيها وتغطي RGBA16F للـ blit
+    if (!state->storageImageWriteWithoutFormat) {
+        std::cout << "Post-processing: disabled, shaderStorageImageWriteWithoutFormat unsupported" << std::endl;
+        return;
+    }
+    if (!formatSupports(state, POST_HDR_FORMAT, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT |
+                                                VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT |
+                                                VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+        std::cout << "Post-processing: disabled, RGBA16F cannot be rendered, stored and filtered" << std::endl;
+        return;
+    }
+    post.blitSupported = (state->swapchainUsage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) &&
+                         formatSupports(state, state->swapchainFormat, VK_FORMAT_FEATURE_BLIT_DST_BIT);
+    post.direct = state->swapchainUsage & VK_IMAGE_USAGE_STORAGE_BIT;
+    if (!post.direct && !post.blitSupported) {
+        std::cout << "Post-processing: disabled, swapchain images accept neither storage writes nor blits"
+                  << std::endl;
+        return;
+    }
+    post.enabled = true;
+    RenderTargets &targets = state->renderTargets;
+    targets.offscreen = true;
+    targets.sceneFormat = POST_HDR_FORMAT;
+
+    const VkDescriptorType bloomTypes[BLOOM_BINDING_TOTAL] = {
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+    };
+    post.bloomSetLayout = createSetLayout(state, bloomTypes, BLOOM_BINDING_TOTAL);
+    post.bloomPipelineLayout = createPipelineLayout(state, post.bloomSetLayout, sizeof(BloomConstants));
+    post.downsamplePipeline = createComputePipeline(state, "bloom_down.comp", post.bloomPipelineLayout);
+    post.upsamplePipeline = createComputePipeline(state, "bloom_up.comp", post.bloomPipelineLayout);
+
+    const VkDescriptorType finalTypes[FINAL_BINDING_TOTAL] = {
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+    };
+    post.finalSetLayout = createSetLayout(state, finalTypes, FINAL_BINDING_TOTAL);
+    post.finalPipelineLayout = createPipelineLayout(state, post.finalSetLayout, sizeof(FinalConstants));
+    post.finalPipeline = createComputePipeline(state, "post_final.comp", post.finalPipelineLayout);
+
+    VkSamplerCreateInfo samplerInfo{
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+    };
+    post.sampler = getSampler(state, samplerInfo);
+    printf("Post-processing: HDR scene, %u bloom levels, final pass %s, swapchain format %d\n", POST_BLOOM_LEVELS,
+           post.direct ? "writes the swapchain directly" : "blits to the swapchain", state->swapchainFormat);
+}
+
+static void destroyBloom(State *state) {
+    Post &post = state->post;
+    for (VkImageView &view : post.bloomLevels) {
+        if (view != VK_NULL_HANDLE) {
+            deferDestroy(state, view);
+            view = VK_NULL_HANDLE;
+        }
+    }
+    destroyImage(state, &post.bloom);
+    destroyImage(state, &post.output);
+    post.bloomImage = {};
+    post.outputImage = {};
+    post.extent = {};
+}
+
+void destroyPost(State *state) {
+    Post &post = state->post;
+    destroyBloom(state);
+    for (VkPipeline pipeline : {post.downsamplePipeline, post.upsamplePipeline, post.finalPipeline}) {
+        if (pipeline != VK_NULL_HANDLE) {
+            deferDestroy(state, pipeline);
+        }
+    }
+    for (VkPipelineLayout layout : {post.bloomPipelineLayout, post.finalPipelineLayout}) {
+        if (layout != VK_NULL_HANDLE) {
+            deferDestroy(state, layout);
+        }
+    }
+    post = {};
+}
+
+static Image createPostImage(State *state, VkExtent2D extent, uint32_t mipLevels, VkImageUsageFlags usage) {
+    VkImageCreateInfo imageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = POST_HDR_FORMAT,
+        .extent = {extent.width, extent.height, 1},
+        .mipLevels = mipLevels,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &state->queueFamilyIndex,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    return createImage(state, imageInfo, VK_IMAGE_ASPECT_COLOR_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+// الـ bloom بنصف دقة الشاشة لا المشهد، فلا يُعاد إنشاؤه مع كل مقياس للدقة الديناميكية
+static void updatePostImages(State *state) {
+    Post &post = state->post;
+    VkExtent2D extent = state->swapchainExtent;
+    if (post.bloom.image != VK_NULL_HANDLE && extent.width == post.extent.width &&
+        extent.height == post.extent.height) {
+        return;
+    }
+    destroyBloom(state);
+    VkExtent2D half = {std::max(extent.width / 2, 1u), std::max(extent.height / 2, 1u)};
+    uint32_t levels = 1;
+    while (levels < POST_BLOOM_LEVELS && (std::max(half.width, half.height) >> levels) > 0) {
+        levels++;
+    }
+    post.bloom = createPostImage(state, half, levels, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    post.bloomImage = passImage(post.bloom, VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT, false);
+    for (uint32_t level = 0; level < levels; level++) {
+        post.bloomLevels[level] = createImageView(state, post.bloom.image, POST_HDR_FORMAT,
+                                                  VK_IMAGE_ASPECT_COLOR_BIT, level, 1);
+    }
+    if (post.blitSupported) {
+        post.output = createPostImage(state, extent, 1, VK_IMAGE_USAGE_STORAGE_BIT |
+                                                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+        post.outputImage = passImage(post.output, VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT, false);
+    }
+    post.extent = extent;
+}
+
+static VkExtent2D levelExtent(const Post &post, uint32_t level) {
+    return {std::max(post.bloom.extent.width >> level, 1u), std::max(post.bloom.extent.height >> level, 1u)};
+}
+
+static void computeBarrier(VkCommandBuffer commandBuffer) {
+    VkMemoryBarrier2 barrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        .dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+                         VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+    };
+    VkDependencyInfo dependency{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &barrier,
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &dependency);
+}
+
+static VkDescriptorSet writeSet(State *state, VkDescriptorSetLayout layout, const VkDescriptorImageInfo *infos,
+                                const VkDescriptorType *types, uint32_t count) {
+    VkDescriptorSet set = allocateFrameDescriptorSet(state, layout);
+    VkWriteDescriptorSet writes[FINAL_BINDING_TOTAL];
+    for (uint32_t i = 0; i < count; i++) {
+        writes[i] = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = i,
+            .descriptorCount = 1,
+            .descriptorType = types[i],
+            .pImageInfo = &infos[i],
+        };
+    }
+    vkUpdateDescriptorSets(state->device, count, writes, 0, nullptr);
+    return set;
+}
+
+// dispatch لمستوى واحد: المصدر يُقرأ بالـ sampler والهدف يُكتب كصورة تخزين
+static void dispatchBloom(State *state, VkCommandBuffer commandBuffer, VkImageView source, VkImageLayout sourceLayout,
+                          uint32_t level, const BloomConstants &constants) {
+    Post &post = state->post;
+    const VkDescriptorImageInfo infos[BLOOM_BINDING_TOTAL] = {
+        {post.sampler, source, sourceLayout},
+        {VK_NULL_HANDLE, post.bloomLevels[level], VK_IMAGE_LAYOUT_GENERAL},
+    };
+    const VkDescriptorType types[BLOOM_BINDING_TOTAL] = {
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+    };
+    VkDescriptorSet set = writeSet(state, post.bloomSetLayout, infos, types, BLOOM_BINDING_TOTAL);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, post.bloomPipelineLayout, 0, 1, &set, 0,
+                            nullptr);
+    vkCmdPushConstants(commandBuffer, post.bloomPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants),
+                       &constants);
+    vkCmdDispatch(commandBuffer, (constants.targetSize[0] + POST_GROUP_SIZE - 1) / POST_GROUP_SIZE,
+                  (constants.targetSize[1] + POST_GROUP_SIZE - 1) / POST_GROUP_SIZE, 1);
+    computeBarrier(commandBuffer);
+    post.dispatches++;
+}
+
+void postRender(State *state, VkCommandBuffer commandBuffer, PassImage *target) {
+    Post &post = state->post;
+    RenderTargets &targets = state->renderTargets;
+    updatePostImages(state);
+    post.dispatches = 0;
+    bool direct = post.direct && (state->swapchainUsage & VK_IMAGE_USAGE_STORAGE_BIT);
+    gpuTimerBegin(state, commandBuffer, GPU_TIMER_POST);
+
+    PassImage *output = direct ? target : &post.outputImage;
+    BarrierBatch barriers;
+    transitionImage(&barriers, &targets.sceneTarget, IMAGE_STATE_SHADER_READ);
+    transitionImage(&barriers, &post.bloomImage, POST_STATE_STORAGE, true);
+    transitionImage(&barriers, output, POST_STATE_STORAGE, true);
+    flushBarriers(commandBuffer, &barriers);
+
+    // المستوى 0 يقرأ الجزء المرسوم من المشهد فقط؛ بقية المستويات تملأ صورها
+    const PostSettings &settings = post.settings;
+    float width = (float) targets.extent.width;
+    float height = (float) targets.extent.height;
+    float uvScale[2] = {targets.renderExtent.width / width, targets.renderExtent.height / height};
+    float uvMax[2] = {(targets.renderExtent.width - 0.5f) / width, (targets.renderExtent.height - 0.5f) / height};
+    uint32_t levels = post.bloom.mipLevels;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, post.downsamplePipeline);
+    for (uint32_t level = 0; level < levels; level++) {
+        VkExtent2D size = levelExtent(post, level);
+        BloomConstants constants{
+            .sourceUvScale = {1.0f, 1.0f},
+            .sourceUvMax = {1.0f, 1.0f},
+            .targetSize = {(int32_t) size.width, (int32_t) size.height},
+            .threshold = settings.bloomThreshold,
+            .knee = std::max(settings.bloomKnee, 1e-4f),
+            .prefilter = level == 0,
+        };
+        if (level == 0) {
+            constants.sourceUvScale[0] = uvScale[0];
+            constants.sourceUvScale[1] = uvScale[1];
+            constants.sourceUvMax[0] = uvMax[0];
+            constants.sourceUvMax[1] = uvMax[1];
+            constants.sourceTexel[0] = 1.0f / width;
+            constants.sourceTexel[1] = 1.0f / height;
+            dispatchBloom(state, commandBuffer, targets.sceneTarget.view, IMAGE_STATE_SHADER_READ.layout, level,
+                          constants);
+        } else {
+            VkExtent2D source = levelExtent(post, level - 1);
+            constants.sourceTexel[0] = 1.0f / source.width;
+            constants.sourceTexel[1] = 1.0f / source.height;
+            dispatchBloom(state, commandBuffer, post.bloomLevels[level - 1], VK_IMAGE_LAYOUT_GENERAL, level,
+                          constants);
+        }
+    }
+    // التكبير حتى المستوى 0 فقط؛ آخر خطوة إلى دقة الشاشة مدمجة في الممر الأخير
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, post.upsamplePipeline);
+    for (uint32_t level = levels - 1; level-- > 0;) {
+        VkExtent2D size = levelExtent(post, level);
+        VkExtent2D source = levelExtent(post, level + 1);
+        BloomConstants constants{
+            .sourceUvScale = {1.0f, 1.0f},
+            .sourceUvMax = {1.0f, 1.0f},
+            .sourceTexel = {1.0f / source.width, 1.0f / source.height},
+            .targetSize = {(int32_t) size.width, (int32_t) size.height},
+        };
+        dispatchBloom(state, commandBuffer, post.bloomLevels[level + 1], VK_IMAGE_LAYOUT_GENERAL, level, constants);
+    }
+
+    const VkDescriptorImageInfo infos[FINAL_BINDING_TOTAL] = {
+        {post.sampler, targets.sceneTarget.view, IMAGE_STATE_SHADER_READ.layout},
+        {post.sampler, post.bloomLevels[0], VK_IMAGE_LAYOUT_GENERAL},
+        {VK_NULL_HANDLE, output->view, VK_IMAGE_LAYOUT_GENERAL},
+    };
+    const VkDescriptorType types[FINAL_BINDING_TOTAL] = {
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+    };
+    VkDescriptorSet set = writeSet(state, post.finalSetLayout, infos, types, FINAL_BINDING_TOTAL);
+    VkExtent2D bloomSize = levelExtent(post, 0);
+    VkExtent2D extent = state->swapchainExtent;
+    // مع blit إلى صورة sRGB يرمّز الـ blit نفسه، فالـ shader يرمّز فقط لصيغ UNORM
+    FinalConstants constants{
+        .uvScale = {uvScale[0], uvScale[1]},
+        .uvMax = {uvMax[0], uvMax[1]},
+        .bloomTexel = {1.0f / bloomSize.width, 1.0f / bloomSize.height},
+        .outputSize = {(int32_t) extent.width, (int32_t) extent.height},
+        .exposure = settings.exposure,
+        .bloomIntensity = settings.bloomIntensity,
+        .saturation = settings.saturation,
+        .contrast = settings.contrast,
+        .tint = {settings.tint[0], settings.tint[1], settings.tint[2]},
+        .encodeSrgb = !isSrgb(state->swapchainFormat),
+    };
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, post.finalPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, post.finalPipelineLayout, 0, 1, &set, 0,
+                            nullptr);
+    vkCmdPushConstants(commandBuffer, post.finalPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants),
+                       &constants);
+    vkCmdDispatch(commandBuffer, (extent.width + POST_GROUP_SIZE - 1) / POST_GROUP_SIZE,
+                  (extent.height + POST_GROUP_SIZE - 1) / POST_GROUP_SIZE, 1);
+    post.dispatches++;
+
+    if (!direct) {
+        transitionImage(&barriers, &post.outputImage, POST_STATE_BLIT_SOURCE);
+        transitionImage(&barriers, target, POST_STATE_BLIT_TARGET, true);
+        flushBarriers(commandBuffer, &barriers);
+        VkImageBlit region{
+            .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .srcOffsets = {{0, 0, 0}, {(int32_t) extent.width, (int32_t) extent.height, 1}},
+            .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .dstOffsets = {{0, 0, 0}, {(int32_t) extent.width, (int32_t) extent.height, 1}},
+        };
+        vkCmdBlitImage(commandBuffer, post.outputImage.image, POST_STATE_BLIT_SOURCE.layout, target->image,
+                       POST_STATE_BLIT_TARGET.layout, 1, &region, VK_FILTER_NEAREST);
+    }
+    gpuTimerEnd(state, commandBuffer, GPU_TIMER_POST);
+}
+
+void postBenchmarkFrame(State *state) {
+    Post &post = state->post;
+    if (!post.enabled) {
+        return;
+    }
+    if (post.benchmarkFrames == 0) {
+        post.benchmarkStart = std::chrono::steady_clock::now();
+    }
+    sceneBenchmarkFrame(state);
+    // القياسات متأخرة بعدد الإطارات الجارية: بعد كل تبديل تُهمل حتى تصل قياسات المسار الجديد
+    if (post.benchmarkFrames > FRAMES_IN_FLIGHT) {
+        post.benchmarkGpuMs[post.direct] += state->gpuTimers.ms[GPU_TIMER_POST];
+        post.benchmarkSamples[post.direct]++;
+    }
+    post.benchmarkFrames++;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - post.benchmarkStart).count();
+    if (elapsed < 1.0) {
+        return;
+    }
+    const double MB = 1024.0 * 1024.0;
+    double ms[2] = {};
+    for (uint32_t i = 0; i < 2; i++) {
+        ms[i] = post.benchmarkSamples[i] ? post.benchmarkGpuMs[i] / post.benchmarkSamples[i] : 0;
+    }
+    // الـ blit يكتب output بـ 8 بايتات للبكسل ثم يقرؤها ويكتب الـ swapchain بأربعة
+    double blitBytes = (double) post.extent.width * post.extent.height * (8 + 8 + 4);
+    double directBytes = (double) post.extent.width * post.extent.height * 4;
+    printf("Post: %u dispatches, bloom %ux%u with %u levels, GPU post %.3f ms direct, %.3f ms blit, "
+           "%.2f MB per frame saved by writing the swapchain directly\n",
+           post.dispatches, post.bloom.extent.width, post.bloom.extent.height, post.bloom.mipLevels, ms[1], ms[0],
+           (blitBytes - directBytes) / MB);
+    // المساران بالتناوب كل ثانية حيث يدعمهما الجهاز
+    if (post.blitSupported && (state->swapchainUsage & VK_IMAGE_USAGE_STORAGE_BIT)) {
+        post.direct = !post.direct;
+    }
+    post.benchmarkFrames = 0;
+}
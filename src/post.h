@@ -0,0 +1,67 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <chrono>
+#include <cstdint>
+
+#include "image.h"
+#include "pass.h"
+
+struct State;
+
+constexpr uint32_t POST_BLOOM_LEVELS = 6;           // من نصف الدقة حتى 1/64
+constexpr uint32_t POST_GROUP_SIZE = 8;             // يطابق local_size في shaders/bloom_*.comp و post_final.comp
+
+struct PostSettings {
+    float exposure = 1.0f;
+    float bloomThreshold = 1.0f;    // ما فوقه فقط يتوهج؛ المشهد بدقة HDR
+    float bloomKnee = 0.5f;         // عرض الانتقال الناعم حول العتبة
+    float bloomIntensity = 0.08f;
+    float saturation = 1.0f;
+    float contrast = 1.0f;
+    float tint[3] = {1.0f, 1.0f, 1.0f};
+};
+
+// المشهد يُرسم بصيغة HDR ثم تمر عليه ممرات compute: تصغير الـ bloom (العتبة مدمجة في أولها)،
+// ثم تكبيره، ثم ممر أخير يدمج آخر تكبير مع tonemap والتدريج والتكبير من الدقة الديناميكية وترميز sRGB
+struct Post {
+    bool requested = true;          // --post off يعطلها؛ يُقرأ في createSwapchain لاختيار صيغة قابلة للتخزين
+    bool enabled = false;
+    bool direct = false;            // الممر الأخير يكتب في صورة الـ swapchain، وإلا في output ثم blit
+    bool blitSupported = false;
+    PostSettings settings;
+
+    VkExtent2D extent{};
+    Image bloom;                    // RGBA16F بنصف الدقة مع مستوياته
+    PassImage bloomImage;
+    VkImageView bloomLevels[POST_BLOOM_LEVELS] = {};
+    Image output;                   // فقط عندما لا تقبل صور الـ swapchain الكتابة من compute
+    PassImage outputImage;
+
+    VkSampler sampler = VK_NULL_HANDLE;                     // يملكه كاش الـ samplers
+    VkDescriptorSetLayout bloomSetLayout = VK_NULL_HANDLE;  // يملكها كاش التخطيطات
+    VkDescriptorSetLayout finalSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout bloomPipelineLayout = VK_NULL_HANDLE;
+    VkPipelineLayout finalPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline downsamplePipeline = VK_NULL_HANDLE;
+    VkPipeline upsamplePipeline = VK_NULL_HANDLE;
+    VkPipeline finalPipeline = VK_NULL_HANDLE;
+    uint32_t dispatches = 0;        // في آخر إطار
+
+    // --bench post
+    std::chrono::steady_clock::time_point benchmarkStart;
+    uint32_t benchmarkFrames = 0;
+    double benchmarkGpuMs[2] = {};  // [0] مع blit، [1] مباشرة
+    uint32_t benchmarkSamples[2] = {};
+};
+
+// بعد createRenderTargets و createGpuTimers وقبل createDynamicResolution: يجعل المشهد HDR خارج الشاشة
+void createPost(State *state);
+void destroyPost(State *state);
+
+// بعد الممر الرئيسي: كل السلسلة حتى صورة الـ swapchain، التي تبقى في حالة الكتابة الأخيرة
+void postRender(State *state, VkCommandBuffer commandBuffer, PassImage *target);
+
+// --bench post: زمن السلسلة على الـ GPU مع الكتابة المباشرة والـ blit بالتناوب كل ثانية
+void postBenchmarkFrame(State *state);
@@ -0,0 +1,272 @@
+#include "readback.h"
+#include "state.h"
+
+#include <algorithm>
+#include <iostream>
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t size) {
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        initialized = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void writeU32(std::vector<uint8_t> &out, uint32_t value) {
+    out.push_back((uint8_t) (value >> 24));
+    out.push_back((uint8_t) (value >> 16));
+    out.push_back((uint8_t) (value >> 8));
+    out.push_back((uint8_t) value);
+}
+
+static void writeChunk(FILE *file, const char *type, const std::vector<uint8_t> &data) {
+    std::vector<uint8_t> chunk;
+    writeU32(chunk, (uint32_t) data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    uint32_t crc = crc32(0, chunk.data() + 4, chunk.size() - 4);
+    writeU32(chunk, crc);
+    fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+// PNG بكتل deflate مخزّنة دون ضغط: أسرع بكثير من الضغط الحقيقي ويكفي لاختبارات الصور المرجعية
+static void writePng(FILE *file, const ReadbackJob &job) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), file);
+
+    std::vector<uint8_t> header;
+    writeU32(header, job.extent.width);
+    writeU32(header, job.extent.height);
+    header.insert(header.end(), {8, 6, 0, 0, 0});   // 8 بت، RGBA
+    writeChunk(file, "IHDR", header);
+
+    size_t rowSize = (size_t) job.extent.width * 4;
+    std::vector<uint8_t> raw;
+    raw.reserve((rowSize + 1) * job.extent.height);
+    for (uint32_t y = 0; y < job.extent.height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), job.pixels.begin() + y * rowSize, job.pixels.begin() + (y + 1) * rowSize);
+    }
+
+    std::vector<uint8_t> zlib{0x78, 0x01};
+    uint32_t adlerA = 1, adlerB = 0;
+    for (uint8_t byte : raw) {
+        adlerA = (adlerA + byte) % 65521;
+        adlerB = (adlerB + adlerA) % 65521;
+    }
+    for (size_t offset = 0;; offset += 65535) {
+        size_t length = std::min<size_t>(65535, raw.size() - offset);
+        bool last = offset + length >= raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back((uint8_t) length);
+        zlib.push_back((uint8_t) (length >> 8));
+        zlib.push_back((uint8_t) ~length);
+        zlib.push_back((uint8_t) (~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+        if (last) {
+            break;
+        }
+    }
+    writeU32(zlib, (adlerB << 16) | adlerA);
+    writeChunk(file, "IDAT", zlib);
+    writeChunk(file, "IEND", {});
+}
+
+static void writeJob(Readback &readback, ReadbackJob &job) {
+    if (job.swizzleBgra) {
+        for (size_t i = 0; i + 3 < job.pixels.size(); i += 4) {
+            std::swap(job.pixels[i], job.pixels[i + 2]);
+        }
+    }
+
+    char path[1024];
+    if (readback.format == CaptureFormat::Png) {
+        snprintf(path, sizeof(path), "%s/frame_%06llu.png", readback.directory,
+                 (unsigned long long) job.frameNumber);
+    } else {
+        snprintf(path, sizeof(path), "%s/frame_%06llu_%ux%u.rgba", readback.directory,
+                 (unsigned long long) job.frameNumber, job.extent.width, job.extent.height);
+    }
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to open capture file %s\n", path);
+        return;
+    }
+    if (readback.format == CaptureFormat::Png) {
+        writePng(file, job);
+    } else {
+        fwrite(job.pixels.data(), 1, job.pixels.size(), file);
+    }
+    fclose(file);
+}
+
+static void writerThread(Readback *readback) {
+    for (;;) {
+        ReadbackJob job;
+        {
+            std::unique_lock<std::mutex> lock(readback->mutex);
+            readback->condition.wait(lock, [readback] { return readback->stopping || !readback->jobs.empty(); });
+            if (readback->jobs.empty()) {
+                return;
+            }
+            job = std::move(readback->jobs.front());
+            readback->jobs.pop_front();
+        }
+        writeJob(*readback, job);
+        std::lock_guard<std::mutex> lock(readback->mutex);
+        readback->written++;
+    }
+}
+
+void createReadback(State *state) {
+    Readback &readback = state->readback;
+    if (!readback.directory) {
+        return;
+    }
+    readback.stopping = false;
+    readback.writer = std::thread(writerThread, &readback);
+    std::cout << "Capturing every frame to " << readback.directory
+              << (readback.format == CaptureFormat::Png ? " as PNG" : " as raw RGBA") << std::endl;
+}
+
+void destroyReadback(State *state) {
+    Readback &readback = state->readback;
+    if (readback.writer.joinable()) {
+        readbackPoll(state);
+        {
+            std::lock_guard<std::mutex> lock(readback.mutex);
+            readback.stopping = true;
+        }
+        readback.condition.notify_one();
+        readback.writer.join();
+        std::cout << "Captured " << readback.written << " frames, dropped " << readback.dropped << std::endl;
+    }
+    for (ReadbackSlot &slot : readback.slots) {
+        destroyBuffer(state, &slot.buffer);
+        slot = {};
+    }
+}
+
+void readbackCapture(State *state, VkImage image, VkImageLayout layout, VkExtent2D extent, VkFormat format,
+                     VkPipelineStageFlags2 producerStage, VkAccessFlags2 producerAccess) {
+    Readback &readback = state->readback;
+    ReadbackSlot &slot = readback.slots[readback.nextSlot];
+    // لا يحدث عادة: الحلقة أكبر من عدد الإطارات الجارية بواحد
+    if (slot.frameNumber != 0) {
+        readback.dropped++;
+        return;
+    }
+    readback.nextSlot = (readback.nextSlot + 1) % READBACK_RING_SIZE;
+
+    VkDeviceSize size = (VkDeviceSize) extent.width * extent.height * 4;
+    if (slot.buffer.size < size) {
+        destroyBuffer(state, &slot.buffer);
+        slot.buffer = createBuffer(state, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    }
+    slot.frameNumber = state->frameNumber;
+    slot.extent = extent;
+    slot.format = format;
+
+    VkCommandBuffer commandBuffer = state->commandBuffer;
+    VkImageMemoryBarrier2 barriers[2] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = producerStage,
+            .srcAccessMask = producerAccess,
+            .dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+            .dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+            .oldLayout = layout,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = image,
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+        },
+    };
+    barriers[1] = barriers[0];
+    barriers[1].srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barriers[1].srcAccessMask = VK_ACCESS_2_NONE;
+    barriers[1].dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+    barriers[1].dstAccessMask = VK_ACCESS_2_NONE;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[1].newLayout = layout;
+
+    VkDependencyInfo dependencyInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &barriers[0],
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+    VkBufferImageCopy region{
+        .bufferOffset = 0,
+        .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+        .imageExtent = {extent.width, extent.height, 1},
+    };
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer.buffer, 1,
+                           &region);
+
+    // الحاجز الثاني يعيد التخطيط ويجعل الكتابة مرئية للمضيف عند اكتمال الإطار
+    VkMemoryBarrier2 hostBarrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+        .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+    };
+    dependencyInfo.memoryBarrierCount = 1;
+    dependencyInfo.pMemoryBarriers = &hostBarrier;
+    dependencyInfo.pImageMemoryBarriers = &barriers[1];
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void readbackCaptureSwapchain(State *state) {
+    readbackCapture(state, state->swapchainImages[state->imageIndex], VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                    state->swapchainExtent, state->swapchainFormat, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                    VK_ACCESS_2_MEMORY_WRITE_BIT);
+}
+
+void readbackPoll(State *state) {
+    Readback &readback = state->readback;
+    for (ReadbackSlot &slot : readback.slots) {
+        if (slot.frameNumber == 0 || !isFrameComplete(state, slot.frameNumber)) {
+            continue;
+        }
+        VkDeviceSize size = (VkDeviceSize) slot.extent.width * slot.extent.height * 4;
+        invalidateBuffer(state, slot.buffer, 0, size);
+
+        ReadbackJob job{
+            .frameNumber = slot.frameNumber,
+            .extent = slot.extent,
+            .swizzleBgra = slot.format == VK_FORMAT_B8G8R8A8_SRGB || slot.format == VK_FORMAT_B8G8R8A8_UNORM,
+        };
+        slot.frameNumber = 0;
+        {
+            std::lock_guard<std::mutex> lock(readback.mutex);
+            if (readback.jobs.size() >= READBACK_MAX_QUEUED_WRITES) {
+                readback.dropped++;
+                continue;
+            }
+        }
+        const uint8_t *pixels = static_cast<const uint8_t *>(slot.buffer.mapped);
+        job.pixels.assign(pixels, pixels + size);
+        {
+            std::lock_guard<std::mutex> lock(readback.mutex);
+            readback.jobs.push_back(std::move(job));
+        }
+        readback.condition.notify_one();
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer.h"
+#include "frame.h"
+
+struct State;
+
+// FRAMES_IN_FLIGHT + 1 تكفي: beginFrame يضمن اكتمال الإطار الذي استخدم الفتحة قبل إعادة استخدامها
+constexpr uint32_t READBACK_RING_SIZE = FRAMES_IN_FLIGHT + 1;
+constexpr size_t READBACK_MAX_QUEUED_WRITES = 64;
+
+enum class CaptureFormat {
+    Png,
+    Raw,
+};
+
+struct ReadbackSlot {
+    Buffer buffer;
+    uint64_t frameNumber = 0;           // 0 تعني أن الفتحة حرة
+    VkExtent2D extent{};
+    VkFormat format = VK_FORMAT_UNDEFINED;
+};
+
+struct ReadbackJob {
+    uint64_t frameNumber;
+    VkExtent2D extent;
+    bool swizzleBgra;
+    std::vector<uint8_t> pixels;
+};
+
+struct Readback {
+    const char *directory = nullptr;    // --capture <dir>
+    CaptureFormat format = CaptureFormat::Png;
+    ReadbackSlot slots[READBACK_RING_SIZE];
+    uint32_t nextSlot = 0;
+
+    // خيط الكتابة في الخلفية حتى لا يتأثر الرسم بسرعة القرص أو ضغط PNG
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<ReadbackJob> jobs;
+    bool stopping = false;
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+};
+
+void createReadback(State *state);
+void destroyReadback(State *state);
+
+// تُسجَّل داخل أوامر الإطار الحالي؛ النسخ يكتمل بعد عدة إطارات دون أي انتظار
+void readbackCapture(State *state, VkImage image, VkImageLayout layout, VkExtent2D extent, VkFormat format,
+                     VkPipelineStageFlags2 producerStage, VkAccessFlags2 producerAccess);
+void readbackCaptureSwapchain(State *state);
+
+// يُستدعى كل إطار: يسلّم الفتحات المكتملة إلى خيط الكتابة
+void readbackPoll(State *state);
@@ -0,0 +1,223 @@
+#include "resolution.h"
+#include "descriptors.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+constexpr uint32_t RESOLUTION_WINDOW = 8;          // قياسات لكل قرار
+constexpr float RESOLUTION_STEP = 1.0f / 40.0f;     // المقاييس مكمّمة فلا تتغير الدقة بفروق لا تُرى
+constexpr float RESOLUTION_MAX_DROP = 0.85f;        // النزول أسرع من الصعود: تجاوز الميزانية أسوأ من دقة أقل
+constexpr float RESOLUTION_MAX_RISE = 1.10f;
+
+// يطابق UpscaleConstants في shaders/upscale.frag
+struct UpscaleConstants {
+    float uvScale[2];
+    float uvMax[2];
+};
+
+void createDynamicResolution(State *state) {
+    DynamicResolution &resolution = state->resolution;
+    if (resolution.targetMs <= 0) {
+        return;
+    }
+    if (!state->gpuTimers.enabled) {
+        std::cout << "Dynamic resolution: disabled, no GPU timestamps on the graphics queue" << std::endl;
+        return;
+    }
+    resolution.enabled = true;
+    resolution.scale = resolution.maxScale;
+    state->renderTargets.offscreen = true;
+    state->renderTargets.renderScale = resolution.scale;
+    printf("Dynamic resolution: %.2f ms GPU budget, scale %.2f to %.2f\n", resolution.targetMs, resolution.minScale,
+           resolution.maxScale);
+    // الممر الأخير في المعالجة اللاحقة يكبّر المشهد بنفسه فلا حاجة لممر التكبير
+    if (state->post.enabled) {
+        return;
+    }
+
+    VkDescriptorSetLayoutBinding binding{
+        .binding = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+    };
+    resolution.setLayout = getDescriptorSetLayout(state, &binding, 1);
+    VkPushConstantRange pushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .offset = 0,
+        .size = sizeof(UpscaleConstants),
+    };
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &resolution.setLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
+    };
+    VkResult result = vkCreatePipelineLayout(state->device, &pipelineLayoutInfo, state->allocator,
+                                             &resolution.pipelineLayout);
+    EXPECT(result != VK_SUCCESS, "Failed to create upscale pipeline layout");
+
+    VkSamplerCreateInfo samplerInfo{
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+    };
+    resolution.sampler = getSampler(state, samplerInfo);
+
+    PipelineDesc &desc = resolution.pipeline;
+    setPipelineShaders(&desc, "upscale.vert", "upscale.frag");
+    desc.layout = registerPipelineLayout(state, "upscale", resolution.pipelineLayout);
+    desc.colorFormat = state->swapchainFormat;
+    requestPipeline(state, desc);
+}
+
+void destroyDynamicResolution(State *state) {
+    DynamicResolution &resolution = state->resolution;
+    if (resolution.pipelineLayout != VK_NULL_HANDLE) {
+        deferDestroy(state, resolution.pipelineLayout);
+    }
+    resolution = {};
+}
+
+void dynamicResolutionUpdate(State *state) {
+    DynamicResolution &resolution = state->resolution;
+    if (!resolution.enabled) {
+        return;
+    }
+    // القياسات التي تصل الآن سُجّلت قبل التغيير الأخير
+    if (resolution.settleFrames > 0) {
+        resolution.settleFrames--;
+        return;
+    }
+    resolution.sampleMs += state->gpuTimers.ms[GPU_TIMER_FRAME];
+    resolution.samples++;
+    if (resolution.samples < RESOLUTION_WINDOW) {
+        return;
+    }
+    resolution.averageMs = resolution.sampleMs / resolution.samples;
+    resolution.sampleMs = 0;
+    resolution.samples = 0;
+
+    float average = (float) resolution.averageMs;
+    float budget = resolution.targetMs;
+    bool over = average > budget * resolution.upperBand;
+    bool under = average < budget * resolution.lowerBand && resolution.scale < resolution.maxScale;
+    if (!over && !under) {
+        return;
+    }
+    // الزمن يتناسب تقريباً مع عدد البكسلات، أي مربع المقياس؛ الهدف منتصف النطاق الميت
+    float goal = budget * 0.5f * (resolution.lowerBand + resolution.upperBand);
+    float next = resolution.scale * sqrtf(goal / std::max(average, 0.001f));
+    next = std::clamp(next, resolution.scale * RESOLUTION_MAX_DROP, resolution.scale * RESOLUTION_MAX_RISE);
+    next = std::clamp(roundf(next / RESOLUTION_STEP) * RESOLUTION_STEP, resolution.minScale, resolution.maxScale);
+    if (next == resolution.scale) {
+        return;
+    }
+    int32_t direction = next > resolution.scale ? 1 : -1;
+    if (resolution.lastDirection != 0 && direction != resolution.lastDirection) {
+        resolution.reversals++;
+    }
+    resolution.lastDirection = direction;
+    resolution.changes++;
+    resolution.scale = next;
+    state->renderTargets.renderScale = next;
+    resolution.settleFrames = FRAMES_IN_FLIGHT + 1;
+}
+
+void dynamicResolutionUpscale(State *state, VkCommandBuffer commandBuffer, PassImage *target) {
+    DynamicResolution &resolution = state->resolution;
+    RenderTargets &targets = state->renderTargets;
+    BarrierBatch barriers;
+    transitionImage(&barriers, &targets.sceneTarget, IMAGE_STATE_SHADER_READ);
+    flushBarriers(commandBuffer, &barriers);
+
+    // المثلث يغطي كل بكسل، فلا حاجة لمسح الصورة ولا لمحتواها السابق؛
+    // لكن ما دام الـ pipeline يُترجم لا رسم، فتُمسح كي لا يُعرض محتوى غير معرّف
+    resolution.pipeline.colorFormat = state->swapchainFormat;
+    VkPipeline pipeline = getPipeline(state, resolution.pipeline);
+    PassDesc upscalePass{
+        .name = "upscale",
+        .extent = state->swapchainExtent,
+        .colors = {{
+            .image = target,
+            .clear = pipeline == VK_NULL_HANDLE,
+            .readAfter = true,
+        }},
+        .colorCount = 1,
+    };
+    beginPass(state, commandBuffer, upscalePass);
+    if (pipeline != VK_NULL_HANDLE) {
+        VkDescriptorSet set = allocateFrameDescriptorSet(state, resolution.setLayout);
+        VkDescriptorImageInfo imageInfo{
+            .sampler = resolution.sampler,
+            .imageView = targets.sceneTarget.view,
+            .imageLayout = IMAGE_STATE_SHADER_READ.layout,
+        };
+        VkWriteDescriptorSet write{
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo = &imageInfo,
+        };
+        vkUpdateDescriptorSets(state->device, 1, &write, 0, nullptr);
+
+        float width = (float) targets.extent.width;
+        float height = (float) targets.extent.height;
+        UpscaleConstants constants{
+            .uvScale = {targets.renderExtent.width / width, targets.renderExtent.height / height},
+            .uvMax = {(targets.renderExtent.width - 0.5f) / width, (targets.renderExtent.height - 0.5f) / height},
+        };
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, resolution.pipelineLayout, 0, 1, &set,
+                                0, nullptr);
+        vkCmdPushConstants(commandBuffer, resolution.pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                           sizeof(constants), &constants);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+    endPass(commandBuffer);
+}
+
+void dynamicResolutionBenchmarkFrame(State *state) {
+    DynamicResolution &resolution = state->resolution;
+    if (!resolution.enabled) {
+        return;
+    }
+    if (resolution.benchmarkFrames == 0 && resolution.benchmarkTargetMs == 0) {
+        resolution.benchmarkTargetMs = resolution.targetMs;
+        resolution.benchmarkStart = std::chrono::steady_clock::now();
+    }
+    sceneBenchmarkFrame(state);
+    resolution.benchmarkGpuMs += state->gpuTimers.ms[GPU_TIMER_FRAME];
+    resolution.benchmarkFrames++;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - resolution.benchmarkStart).count();
+    if (elapsed < 1.0) {
+        return;
+    }
+    const RenderTargets &targets = state->renderTargets;
+    printf("Resolution: scale %.3f (%ux%u of %ux%u), GPU frame %.3f ms for a %.2f ms budget, %u changes, "
+           "%u reversals\n",
+           resolution.scale, targets.renderExtent.width, targets.renderExtent.height, targets.extent.width,
+           targets.extent.height, resolution.benchmarkGpuMs / resolution.benchmarkFrames, resolution.targetMs,
+           resolution.changes, resolution.reversals);
+    // ميزانية تتبدل بين الأصلية ونصفها لقياس الاستجابة والاستقرار بعدها
+    resolution.benchmarkPhase++;
+    if (resolution.benchmarkPhase % 5 == 0) {
+        bool halved = resolution.targetMs != resolution.benchmarkTargetMs;
+        resolution.targetMs = halved ? resolution.benchmarkTargetMs : resolution.benchmarkTargetMs * 0.5f;
+    }
+    resolution.benchmarkStart = std::chrono::steady_clock::now();
+    resolution.benchmarkFrames = 0;
+    resolution.benchmarkGpuMs = 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <chrono>
+#include <cstdint>
+
+#include "pass.h"
+#include "pipeline.h"
+
+struct State;
+
+// متحكم الدقة الديناميكية: يقارن زمن الـ GPU بالميزانية ويغيّر مقياس المشهد بخطوات محدودة.
+// القياس متأخر بعدد الإطارات الجارية، فبعد كل تغيير ينتظر حتى تصل قياسات المقياس الجديد
+struct DynamicResolution {
+    bool enabled = false;
+    float targetMs = 0;                 // --dynamic-resolution <ms>؛ 0 يعني معطل
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float scale = 1.0f;                 // المقياس الجاري لكل محور، يُعرض كمقياس أداء
+
+    // نطاق ميت حول الميزانية: لا تغيير ما دام الزمن بين الحدين، فلا تذبذب حول نقطة واحدة
+    float lowerBand = 0.80f;
+    float upperBand = 0.95f;
+    uint32_t settleFrames = 0;          // إطارات متبقية قبل أن تُقبل القياسات بعد آخر تغيير
+    uint32_t samples = 0;
+    double sampleMs = 0;
+    double averageMs = 0;               // متوسط آخر نافذة اكتملت
+    int32_t lastDirection = 0;
+    uint32_t changes = 0;
+    uint32_t reversals = 0;             // تغيير عكس الذي قبله؛ كثرتها تعني تذبذباً
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;       // يملكه كاش التخطيطات
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;                     // يملكه كاش الـ samplers
+    PipelineDesc pipeline;
+
+    // --bench resolution
+    std::chrono::steady_clock::time_point benchmarkStart;
+    uint32_t benchmarkFrames = 0;
+    uint32_t benchmarkPhase = 0;
+    double benchmarkGpuMs = 0;
+    float benchmarkTargetMs = 0;
+};
+
+// بعد مدير الـ pipelines و createPost وقبل أول إطار: يحوّل الممر الرئيسي إلى صورة خارج الشاشة
+void createDynamicResolution(State *state);
+void destroyDynamicResolution(State *state);
+
+// أول recordFrame بعد gpuTimersBeginFrame: يقرأ زمن الإطار ويضبط renderScale قبل updateRenderTargets
+void dynamicResolutionUpdate(State *state);
+
+// بعد الممر الرئيسي: ممر على صورة الـ swapchain بمثلث يغطيها، يكبّر الجزء المرسوم من المشهد بترشيح خطي
+void dynamicResolutionUpscale(State *state, VkCommandBuffer commandBuffer, PassImage *target);
+
+// --bench resolution: حمل شبكة المشهد مع ميزانية تتبدل كل 5 ثوان، ويطبع المقياس والتغييرات والانعكاسات
+void dynamicResolutionBenchmarkFrame(State *state);
@@ -0,0 +1,978 @@
+#include "scene.h"
+#include "descriptors.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+// يجب أن تطابق shaders/scene.glsl و scene_cull.comp
+enum SceneBinding : uint32_t {
+    SCENE_BINDING_INSTANCES,
+    SCENE_BINDING_MESHES,
+    SCENE_BINDING_VERTICES,
+    SCENE_BINDING_DRAWS,
+    SCENE_BINDING_COUNTERS,
+    SCENE_BINDING_VISIBILITY,
+    SCENE_BINDING_PYRAMID,
+    SCENE_BINDING_VIEW,
+    SCENE_BINDING_TOTAL,
+};
+
+// يجب أن تطابق depth_pyramid.comp
+enum PyramidBinding : uint32_t {
+    PYRAMID_BINDING_DEPTH,
+    PYRAMID_BINDING_LEVELS,
+    PYRAMID_BINDING_COUNTER,
+    PYRAMID_BINDING_TOTAL,
+};
+
+constexpr uint32_t SCENE_FRUSTUM_PLANES = 5;   // المستوى البعيد في اللانهاية مع العمق المعكوس
+
+// يطابق SceneView (std140) في shaders/scene.glsl
+struct SceneViewUniforms {
+    float view[16];
+    float viewProjection[16];
+    float planes[SCENE_FRUSTUM_PLANES][4];
+    float projection[4];        // P00، P11، near
+    float pyramid[4];           // العرض، الارتفاع، عدد المستويات
+};
+
+enum SceneCullPhase : uint32_t {
+    SCENE_CULL_ALL,             // frustum فقط، بمرحلة واحدة
+    SCENE_CULL_EARLY,           // المرئي في الإطار السابق
+    SCENE_CULL_LATE,            // الكل على هرم العمق؛ يُرسم ما لم يُرسم مبكراً ويُحدَّث المرئي
+};
+
+struct SceneCullConstants {
+    uint32_t instanceCount;
+    uint32_t maxDraws;
+    uint32_t phase;
+};
+
+struct PyramidConstants {
+    int32_t sourceSize[2];
+    int32_t pyramidSize[2];
+    int32_t levelCount;
+    uint32_t groupCount;
+};
+
+constexpr ImageState PYRAMID_STATE_WRITE{
+    VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+    VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+    VK_IMAGE_LAYOUT_GENERAL,
+};
+constexpr ImageState PYRAMID_STATE_READ{
+    VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+    VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+    VK_IMAGE_LAYOUT_GENERAL,
+};
+
+// المصفوفات بالأعمدة: m[column * 4 + row]
+static void multiply(const float *a, const float *b, float *result) {
+    for (uint32_t column = 0; column < 4; column++) {
+        for (uint32_t row = 0; row < 4; row++) {
+            float sum = 0;
+            for (uint32_t k = 0; k < 4; k++) {
+                sum += a[k * 4 + row] * b[column * 4 + k];
+            }
+            result[column * 4 + row] = sum;
+        }
+    }
+}
+
+static void normalize3(float *v) {
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length > 0) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+}
+
+static void lookAt(const float *eye, const float *target, float *result) {
+    float forward[3] = {target[0] - eye[0], target[1] - eye[1], target[2] - eye[2]};
+    normalize3(forward);
+    // side = forward × (0, 1, 0)؛ المحور Y للأعلى
+    float side[3] = {-forward[2], 0, forward[0]};
+    normalize3(side);
+    float up[3] = {side[1] * forward[2] - side[2] * forward[1], side[2] * forward[0] - side[0] * forward[2],
+                   side[0] * forward[1] - side[1] * forward[0]};
+    float view[16] = {
+        side[0], up[0], -forward[0], 0,
+        side[1], up[1], -forward[1], 0,
+        side[2], up[2], -forward[2], 0,
+        -(side[0] * eye[0] + side[1] * eye[1] + side[2] * eye[2]),
+        -(up[0] * eye[0] + up[1] * eye[1] + up[2] * eye[2]),
+        forward[0] * eye[0] + forward[1] * eye[1] + forward[2] * eye[2], 1,
+    };
+    memcpy(result, view, sizeof(view));
+}
+
+// منظور بعمق معكوس ومستوى بعيد في اللانهاية: العمق near/-z، و y مقلوب لإحداثيات Vulkan
+static void perspective(float fovY, float aspect, float nearPlane, float *result) {
+    float focal = 1.0f / tanf(fovY * 0.5f);
+    float projection[16] = {
+        focal / aspect, 0, 0, 0,
+        0, -focal, 0, 0,
+        0, 0, 0, -1,
+        0, 0, nearPlane, 0,
+    };
+    memcpy(result, projection, sizeof(projection));
+}
+
+// Gribb-Hartmann: كل مستوى مجموع أو فرق صفين من view-projection، والداخل موجب
+static void frustumPlanes(const float *m, float planes[SCENE_FRUSTUM_PLANES][4]) {
+    auto row = [m](uint32_t i, uint32_t j) { return m[j * 4 + i]; };
+    const float signs[SCENE_FRUSTUM_PLANES][2] = {{0, 1}, {0, -1}, {1, 1}, {1, -1}, {2, -1}};
+    for (uint32_t p = 0; p < SCENE_FRUSTUM_PLANES; p++) {
+        uint32_t axis = (uint32_t) signs[p][0];
+        for (uint32_t j = 0; j < 4; j++) {
+            planes[p][j] = row(3, j) + signs[p][1] * row(axis, j);
+        }
+        float length = sqrtf(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+        for (uint32_t j = 0; j < 4; j++) {
+            planes[p][j] /= length;
+        }
+    }
+}
+
+static PipelineDesc scenePipelineDesc(State *state) {
+    Scene &scene = state->scene;
+    PipelineDesc desc;
+    setPipelineShaders(&desc, "scene.vert", "scene.frag");
+    desc.layout = registerPipelineLayout(state, "scene", scene.pipelineLayout);
+    desc.cullMode = VK_CULL_MODE_BACK_BIT;
+    desc.depthTest = 1;
+    desc.depthWrite = 1;
+    desc.colorFormat = renderTargetFormat(state);
+    desc.depthFormat = state->renderTargets.depthFormat;
+    desc.samples = state->renderTargets.samples;
+    return desc;
+}
+
+static Buffer createDeviceBuffer(State *state, VkDeviceSize size, VkBufferUsageFlags usage) {
+    return createBuffer(state, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+static uint32_t previousPowerOfTwo(uint32_t value) {
+    uint32_t result = 1;
+    while (result * 2 <= value) {
+        result *= 2;
+    }
+    return result;
+}
+
+static bool formatSupports(State *state, VkFormat format, VkFormatFeatureFlags features) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(state->physicalDevice, format, &properties);
+    return (properties.optimalTilingFeatures & features) == features;
+}
+
+static VkDescriptorSetLayout createSetLayout(State *state, const VkDescriptorType *types, const uint32_t *counts,
+                                             uint32_t bindingCount) {
+    VkDescriptorSetLayoutBinding bindings[SCENE_BINDING_TOTAL];
+    for (uint32_t i = 0; i < bindingCount; i++) {
+        bindings[i] = {
+            .binding = i,
+            .descriptorType = types[i],
+            .descriptorCount = counts ? counts[i] : 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT,
+        };
+    }
+    return getDescriptorSetLayout(state, bindings, bindingCount);
+}
+
+static VkPipelineLayout createComputeLayout(State *state, const VkDescriptorSetLayout *setLayouts, uint32_t setCount,
+                                            uint32_t pushSize) {
+    VkPushConstantRange pushConstantRange{
+        .stageFlags = VK_SHADER_STAGE_ALL,
+        .offset = 0,
+        .size = pushSize,
+    };
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = setCount,
+        .pSetLayouts = setLayouts,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
+    };
+    VkPipelineLayout layout;
+    VkResult result = vkCreatePipelineLayout(state->device, &pipelineLayoutInfo, state->allocator, &layout);
+    EXPECT(result != VK_SUCCESS, "Failed to create scene pipeline layout");
+    return layout;
+}
+
+// pipelines الـ compute صغيرة وتُنشأ مباشرة؛ مدير الـ pipelines للرسم فقط
+static VkPipeline createComputePipeline(State *state, const char *shader, VkPipelineLayout layout) {
+    VkComputePipelineCreateInfo computeInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = getShaderModule(state, shader),
+            .pName = "main",
+        },
+        .layout = layout,
+    };
+    VkPipeline pipeline;
+    VkResult result = vkCreateComputePipelines(state->device, state->pipelines.cache, 1, &computeInfo,
+                                               state->allocator, &pipeline);
+    EXPECT(result != VK_SUCCESS, "Failed to create compute pipeline %s", shader);
+    return pipeline;
+}
+
+void createScene(State *state) {
+    Scene &scene = state->scene;
+    // firstInstance يحمل فهرس الـ instance إلى الـ vertex shader، وكل الأوامر في استدعاء واحد
+    if (!state->multiDrawIndirect) {
+        std::cout << "GPU culling: disabled, multiDrawIndirect or drawIndirectFirstInstance unsupported" << std::endl;
+        return;
+    }
+    scene.enabled = true;
+    scene.drawIndirectCount = state->drawIndirectCount;
+    scene.maxDraws = std::min(SCENE_MAX_INSTANCES, state->physicalDeviceProperties.limits.maxDrawIndirectCount);
+
+    // هرم العمق يُبنى من عمق بعينة واحدة؛ مع MSAA تبقى التصفية على الـ frustum فقط
+    RenderTargets &targets = state->renderTargets;
+    scene.occlusionSupported = targets.samples == VK_SAMPLE_COUNT_1_BIT &&
+                               formatSupports(state, targets.depthFormat, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) &&
+                               formatSupports(state, VK_FORMAT_R32_SFLOAT, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT |
+                                                                           VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+    scene.occlusion = scene.occlusionSupported;
+    targets.sampledDepth = scene.occlusionSupported;
+
+    scene.vertices = createDeviceBuffer(state, (VkDeviceSize) SCENE_MAX_VERTICES * sizeof(CookedVertex),
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    scene.indices = createDeviceBuffer(state, (VkDeviceSize) SCENE_MAX_INDICES * sizeof(uint32_t),
+                                       VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    scene.meshes = createDeviceBuffer(state, (VkDeviceSize) SCENE_MAX_MESHES * sizeof(SceneMeshGpu),
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    scene.instances = createDeviceBuffer(state, (VkDeviceSize) SCENE_MAX_INSTANCES * sizeof(SceneInstance),
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    scene.visibility = createDeviceBuffer(state, (VkDeviceSize) SCENE_MAX_INSTANCES * sizeof(uint32_t),
+                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    scene.pyramidCounter = createDeviceBuffer(state, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    for (SceneFrame &frame : scene.frames) {
+        frame.draws = createDeviceBuffer(state, (VkDeviceSize) SCENE_LIST_COUNT * scene.maxDraws *
+                                                sizeof(VkDrawIndexedIndirectCommand),
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+        frame.counters = createBuffer(state, sizeof(SceneCounters),
+                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        memset(frame.counters.mapped, 0, sizeof(SceneCounters));
+        flushBuffer(state, frame.counters, 0, sizeof(SceneCounters));
+    }
+
+    const VkDescriptorType sceneTypes[SCENE_BINDING_TOTAL] = {
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+    };
+    scene.setLayout = createSetLayout(state, sceneTypes, nullptr, SCENE_BINDING_TOTAL);
+    // التصفية والرسم يشتركان في التخطيط؛ الرسم لا يستخدم الـ push constants، والتصفية لا تستخدم الأضواء في set 1
+    const VkDescriptorSetLayout setLayouts[] = {scene.setLayout, state->lights.setLayout};
+    scene.pipelineLayout = createComputeLayout(state, setLayouts, 2, sizeof(SceneCullConstants));
+    scene.cullPipeline = createComputePipeline(state, "scene_cull.comp", scene.pipelineLayout);
+
+    const VkDescriptorType pyramidTypes[PYRAMID_BINDING_TOTAL] = {
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    };
+    const uint32_t pyramidCounts[PYRAMID_BINDING_TOTAL] = {1, SCENE_PYRAMID_MAX_LEVELS, 1};
+    scene.pyramidSetLayout = createSetLayout(state, pyramidTypes, pyramidCounts, PYRAMID_BINDING_TOTAL);
+    scene.pyramidPipelineLayout = createComputeLayout(state, &scene.pyramidSetLayout, 1, sizeof(PyramidConstants));
+    scene.pyramidPipeline = createComputePipeline(state, "depth_pyramid.comp", scene.pyramidPipelineLayout);
+    VkSamplerCreateInfo samplerInfo{
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_NEAREST,
+        .minFilter = VK_FILTER_NEAREST,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .maxLod = 1000.0f,
+    };
+    scene.pyramidSampler = getSampler(state, samplerInfo);
+
+    scene.pipeline = scenePipelineDesc(state);
+    requestPipeline(state, scene.pipeline);
+    std::cout << "GPU culling: " << scene.maxDraws << " draws max, "
+              << (scene.drawIndirectCount ? "vkCmdDrawIndexedIndirectCount" : "zeroed vkCmdDrawIndexedIndirect")
+              << ", occlusion " << (scene.occlusionSupported ? "two-phase Hi-Z" : "unavailable") << std::endl;
+}
+
+static void destroyPyramid(State *state) {
+    Scene &scene = state->scene;
+    for (VkImageView &view : scene.pyramidLevels) {
+        if (view != VK_NULL_HANDLE) {
+            deferDestroy(state, view);
+            view = VK_NULL_HANDLE;
+        }
+    }
+    destroyImage(state, &scene.pyramid);
+    scene.pyramidImage = {};
+    scene.pyramidSource = {};
+}
+
+void destroyScene(State *state) {
+    Scene &scene = state->scene;
+    destroyBuffer(state, &scene.vertices);
+    destroyBuffer(state, &scene.indices);
+    destroyBuffer(state, &scene.meshes);
+    destroyBuffer(state, &scene.instances);
+    destroyBuffer(state, &scene.visibility);
+    destroyBuffer(state, &scene.pyramidCounter);
+    destroyPyramid(state);
+    for (SceneFrame &frame : scene.frames) {
+        destroyBuffer(state, &frame.draws);
+        destroyBuffer(state, &frame.counters);
+        destroyBuffer(state, &frame.staging);
+    }
+    for (VkPipeline pipeline : {scene.cullPipeline, scene.pyramidPipeline}) {
+        if (pipeline != VK_NULL_HANDLE) {
+            deferDestroy(state, pipeline);
+        }
+    }
+    for (VkPipelineLayout layout : {scene.pipelineLayout, scene.pyramidPipelineLayout}) {
+        if (layout != VK_NULL_HANDLE) {
+            deferDestroy(state, layout);
+        }
+    }
+    scene = {};
+}
+
+// الهرم يتبع حجم العمق؛ بدون تصفية الحجب يبقى 1x1 فقط ليكون ربط الواصف صالحاً
+static void updatePyramid(State *state) {
+    Scene &scene = state->scene;
+    VkExtent2D source = scene.occlusionSupported ? state->renderTargets.extent : VkExtent2D{1, 1};
+    if (scene.pyramid.image != VK_NULL_HANDLE && source.width == scene.pyramidSource.width &&
+        source.height == scene.pyramidSource.height) {
+        return;
+    }
+    destroyPyramid(state);
+    uint32_t width = previousPowerOfTwo(source.width);
+    uint32_t height = previousPowerOfTwo(source.height);
+    uint32_t levels = 1;
+    while (levels < SCENE_PYRAMID_MAX_LEVELS && (std::max(width, height) >> levels) > 0) {
+        levels++;
+    }
+    VkImageCreateInfo imageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = VK_FORMAT_R32_SFLOAT,
+        .extent = {width, height, 1},
+        .mipLevels = levels,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &state->queueFamilyIndex,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    scene.pyramid = createImage(state, imageInfo, VK_IMAGE_ASPECT_COLOR_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    scene.pyramidImage = passImage(scene.pyramid, VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT, false);
+    for (uint32_t level = 0; level < levels; level++) {
+        scene.pyramidLevels[level] = createImageView(state, scene.pyramid.image, VK_FORMAT_R32_SFLOAT,
+                                                     VK_IMAGE_ASPECT_COLOR_BIT, level, 1);
+    }
+    scene.pyramidSource = source;
+}
+
+SceneMeshId sceneAddMesh(State *state, const CookedMeshHeader &header, const void *data) {
+    Scene &scene = state->scene;
+    EXPECT(!scene.enabled, "GPU culling is not available");
+    EXPECT(scene.meshTable.size() >= SCENE_MAX_MESHES, "Scene mesh table is full");
+    EXPECT(scene.vertexCount + header.vertexCount > SCENE_MAX_VERTICES, "Scene vertex buffer is full");
+    EXPECT(scene.indexCount + header.indexCount > SCENE_MAX_INDICES, "Scene index buffer is full");
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    VkDeviceSize vertexBytes = (VkDeviceSize) header.vertexCount * sizeof(CookedVertex);
+    uploadBuffer(state, scene.vertices.buffer, (VkDeviceSize) scene.vertexCount * sizeof(CookedVertex), bytes,
+                 vertexBytes);
+
+    // كل المجسمات في مخزن فهارس 32 بت واحد ليكفي ربط واحد للرسم غير المباشر
+    VkDeviceSize indexOffset = (VkDeviceSize) scene.indexCount * sizeof(uint32_t);
+    UploadTicket ticket;
+    if (header.indexSize == 2) {
+        std::vector<uint32_t> widened(header.indexCount);
+        const uint16_t *indices = reinterpret_cast<const uint16_t *>(bytes + vertexBytes);
+        for (uint32_t i = 0; i < header.indexCount; i++) {
+            widened[i] = indices[i];
+        }
+        ticket = uploadBuffer(state, scene.indices.buffer, indexOffset, widened.data(),
+                              widened.size() * sizeof(uint32_t));
+    } else {
+        ticket = uploadBuffer(state, scene.indices.buffer, indexOffset, bytes + vertexBytes,
+                              (VkDeviceSize) header.indexCount * sizeof(uint32_t));
+    }
+
+    SceneMeshGpu mesh{
+        .firstIndex = scene.indexCount,
+        .indexCount = header.indexCount,
+        .vertexOffset = (int32_t) scene.vertexCount,
+        .boundsRadius = header.boundsRadius,
+    };
+    memcpy(mesh.positionOffset, header.positionOffset, sizeof(header.positionOffset));
+    memcpy(mesh.positionScale, header.positionScale, sizeof(header.positionScale));
+    memcpy(mesh.boundsCenter, header.boundsCenter, sizeof(header.boundsCenter));
+    scene.meshTable.push_back(mesh);
+    scene.meshTickets.push_back(ticket);
+    scene.pendingMeshes += ticket != 0;
+    scene.vertexCount += header.vertexCount;
+    scene.indexCount += header.indexCount;
+    scene.meshesDirty = true;
+    return (SceneMeshId) scene.meshTable.size() - 1;
+}
+
+static void markDirty(Scene &scene, SceneInstanceId id) {
+    if (!scene.dirtyFlags[id]) {
+        scene.dirtyFlags[id] = 1;
+        scene.dirty.push_back(id);
+    }
+}
+
+SceneInstanceId sceneAddInstance(State *state, const SceneInstance &instance) {
+    Scene &scene = state->scene;
+    EXPECT(!scene.enabled, "GPU culling is not available");
+    EXPECT(scene.instanceData.size() >= SCENE_MAX_INSTANCES, "Scene instance buffer is full");
+    EXPECT(instance.mesh >= scene.meshTable.size(), "Unknown scene mesh %u", instance.mesh);
+    scene.instanceData.push_back(instance);
+    scene.dirtyFlags.push_back(0);
+    SceneInstanceId id = (SceneInstanceId) scene.instanceData.size() - 1;
+    markDirty(scene, id);
+    return id;
+}
+
+void sceneUpdateInstance(State *state, SceneInstanceId id, const SceneInstance &instance) {
+    Scene &scene = state->scene;
+    EXPECT(id >= scene.instanceData.size(), "Unknown scene instance %u", id);
+    EXPECT(instance.mesh >= scene.meshTable.size(), "Unknown scene mesh %u", instance.mesh);
+    scene.instanceData[id] = instance;
+    markDirty(scene, id);
+}
+
+static void memoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+                          VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess) {
+    VkMemoryBarrier2 barrier{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = srcStage,
+        .srcAccessMask = srcAccess,
+        .dstStageMask = dstStage,
+        .dstAccessMask = dstAccess,
+    };
+    VkDependencyInfo dependency{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &barrier,
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &dependency);
+}
+
+// ينسخ التعديلات عبر مخزن الإطار بأوامر نسخ في قائمة الرسم نفسها، فتترتب بعد قراءات الإطار السابق
+static void recordSceneUpdates(State *state, VkCommandBuffer commandBuffer, SceneFrame &frame) {
+    Scene &scene = state->scene;
+    for (size_t i = 0; scene.pendingMeshes > 0 && i < scene.meshTickets.size(); i++) {
+        if (scene.meshTickets[i] != 0 && uploadComplete(state, scene.meshTickets[i])) {
+            scene.meshTickets[i] = 0;
+            scene.pendingMeshes--;
+            scene.meshesDirty = true;
+        }
+    }
+
+    VkDeviceSize meshBytes = scene.meshesDirty ? scene.meshTable.size() * sizeof(SceneMeshGpu) : 0;
+    VkDeviceSize bytes = meshBytes + scene.dirty.size() * sizeof(SceneInstance);
+    scene.stats.updated = (uint32_t) scene.dirty.size();
+    if (bytes == 0) {
+        return;
+    }
+    if (frame.staging.size < bytes) {
+        VkDeviceSize capacity = std::max<VkDeviceSize>(frame.staging.size, 64 * 1024);
+        while (capacity < bytes) {
+            capacity *= 2;
+        }
+        destroyBuffer(state, &frame.staging);
+        frame.staging = createBuffer(state, capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    }
+    uint8_t *staging = static_cast<uint8_t *>(frame.staging.mapped);
+
+    // الإطار السابق ما زال قد يقرأ هذه المخازن على الـ GPU
+    memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                  VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+
+    if (meshBytes > 0) {
+        // المجسمات التي لم تكتمل هندستها تُنشر بعدد فهارس 0 فتتخطاها التصفية
+        SceneMeshGpu *meshes = reinterpret_cast<SceneMeshGpu *>(staging);
+        for (size_t i = 0; i < scene.meshTable.size(); i++) {
+            meshes[i] = scene.meshTable[i];
+            if (scene.meshTickets[i] != 0) {
+                meshes[i].indexCount = 0;
+            }
+        }
+        VkBufferCopy copy{.srcOffset = 0, .dstOffset = 0, .size = meshBytes};
+        vkCmdCopyBuffer(commandBuffer, frame.staging.buffer, scene.meshes.buffer, 1, &copy);
+        scene.meshesDirty = false;
+    }
+
+    if (!scene.dirty.empty()) {
+        // المتجاورة تُدمج في منطقة نسخ واحدة
+        std::sort(scene.dirty.begin(), scene.dirty.end());
+        scene.copies.clear();
+        VkDeviceSize offset = meshBytes;
+        for (SceneInstanceId id : scene.dirty) {
+            memcpy(staging + offset, &scene.instanceData[id], sizeof(SceneInstance));
+            VkDeviceSize dstOffset = (VkDeviceSize) id * sizeof(SceneInstance);
+            if (!scene.copies.empty() && scene.copies.back().dstOffset + scene.copies.back().size == dstOffset) {
+                scene.copies.back().size += sizeof(SceneInstance);
+            } else {
+                scene.copies.push_back({.srcOffset = offset, .dstOffset = dstOffset, .size = sizeof(SceneInstance)});
+            }
+            offset += sizeof(SceneInstance);
+            scene.dirtyFlags[id] = 0;
+        }
+        vkCmdCopyBuffer(commandBuffer, frame.staging.buffer, scene.instances.buffer, (uint32_t) scene.copies.size(),
+                        scene.copies.data());
+        scene.dirty.clear();
+    }
+    flushBuffer(state, frame.staging, 0, bytes);
+}
+
+// الأوامر والعداد ومصفوفة المرئي يقرؤها الرسم وتصفية الإطار التالي
+static void culledBarrier(VkCommandBuffer commandBuffer) {
+    memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                  VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+                  VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+                  VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+}
+
+static void writeViewUniforms(State *state, SceneViewUniforms *uniforms) {
+    Scene &scene = state->scene;
+    VkExtent2D extent = state->swapchainExtent;
+    float aspect = (float) extent.width / (float) extent.height;
+    float projection[16];
+    lookAt(scene.camera.position, scene.camera.target, scene.view);
+    perspective(scene.camera.fovY, aspect, scene.camera.nearPlane, projection);
+    memcpy(scene.projection, projection, sizeof(projection));
+    multiply(projection, scene.view, scene.viewProjection);
+
+    memcpy(uniforms->view, scene.view, sizeof(uniforms->view));
+    memcpy(uniforms->viewProjection, scene.viewProjection, sizeof(uniforms->viewProjection));
+    frustumPlanes(scene.viewProjection, uniforms->planes);
+    // الإسقاط في scene_cull.comp بمحور Z للأمام و Y للأعلى، فـ P11 موجب هناك
+    uniforms->projection[0] = projection[0];
+    uniforms->projection[1] = -projection[5];
+    uniforms->projection[2] = scene.camera.nearPlane;
+    uniforms->projection[3] = 0;
+    uniforms->pyramid[0] = (float) scene.pyramid.extent.width;
+    uniforms->pyramid[1] = (float) scene.pyramid.extent.height;
+    uniforms->pyramid[2] = (float) scene.pyramid.mipLevels;
+    uniforms->pyramid[3] = 0;
+}
+
+static void dispatchCull(State *state, VkCommandBuffer commandBuffer, SceneCullPhase phase) {
+    Scene &scene = state->scene;
+    SceneCullConstants constants{
+        .instanceCount = scene.stats.instances,
+        .maxDraws = scene.maxDraws,
+        .phase = phase,
+    };
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, scene.cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, scene.pipelineLayout, 0, 1, &scene.set, 0,
+                            nullptr);
+    vkCmdPushConstants(commandBuffer, scene.pipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(constants), &constants);
+    vkCmdDispatch(commandBuffer, (constants.instanceCount + SCENE_CULL_GROUP_SIZE - 1) / SCENE_CULL_GROUP_SIZE, 1, 1);
+    culledBarrier(commandBuffer);
+}
+
+bool sceneCull(State *state, VkCommandBuffer commandBuffer) {
+    Scene &scene = state->scene;
+    scene.set = VK_NULL_HANDLE;
+    scene.twoPhase = false;
+    scene.drawList = SCENE_LIST_EARLY;
+    if (!scene.enabled) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    SceneFrame &frame = scene.frames[state->frameNumber % FRAMES_IN_FLIGHT];
+
+    // beginFrame انتظر هذه الفتحة، فالعدادات من آخر إطار استخدمها جاهزة للقراءة
+    invalidateBuffer(state, frame.counters, 0, sizeof(SceneCounters));
+    memcpy(&scene.stats.counters, frame.counters.mapped, sizeof(SceneCounters));
+    scene.stats.visible = std::min(scene.stats.counters.draws[SCENE_LIST_EARLY], scene.maxDraws) +
+                          std::min(scene.stats.counters.draws[SCENE_LIST_LATE], scene.maxDraws);
+    scene.stats.instances = (uint32_t) scene.instanceData.size();
+
+    updatePyramid(state);
+    recordSceneUpdates(state, commandBuffer, frame);
+    uint32_t instanceCount = scene.stats.instances;
+    if (instanceCount == 0) {
+        scene.stats.visible = 0;
+        return false;
+    }
+    scene.twoPhase = scene.occlusion && scene.occlusionSupported;
+
+    if (!scene.buffersCleared) {
+        // instances لم تُختبر بعد تُعتبر مخفية، فتُرسم في المرحلة المتأخرة من أول إطار
+        vkCmdFillBuffer(commandBuffer, scene.visibility.buffer, 0, VK_WHOLE_SIZE, 0);
+        vkCmdFillBuffer(commandBuffer, scene.pyramidCounter.buffer, 0, VK_WHOLE_SIZE, 0);
+        scene.buffersCleared = true;
+    }
+    vkCmdFillBuffer(commandBuffer, frame.counters.buffer, 0, sizeof(SceneCounters), 0);
+    if (!scene.drawIndirectCount) {
+        // بدون عدّاد على الـ GPU تُرسم كل الأوامر، فما بعد المضغوطة يجب أن يكون بعدد instances صفر
+        VkDeviceSize listBytes = (VkDeviceSize) scene.maxDraws * sizeof(VkDrawIndexedIndirectCommand);
+        vkCmdFillBuffer(commandBuffer, frame.draws.buffer, 0, scene.twoPhase ? 2 * listBytes : listBytes, 0);
+    }
+    memoryBarrier(commandBuffer, VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT,
+                  VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                  VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    if (scene.pyramidImage.state.layout == VK_IMAGE_LAYOUT_UNDEFINED) {
+        // الواصف يشير إلى الهرم حتى قبل أول بناء له
+        BarrierBatch barriers;
+        transitionImage(&barriers, &scene.pyramidImage, PYRAMID_STATE_READ, true);
+        flushBarriers(commandBuffer, &barriers);
+    }
+
+    UniformAllocation uniforms = uniformRingAllocate(state, state->uniformRing, sizeof(SceneViewUniforms));
+    writeViewUniforms(state, static_cast<SceneViewUniforms *>(uniforms.data));
+
+    scene.set = allocateFrameDescriptorSet(state, scene.setLayout);
+    VkDescriptorBufferInfo bufferInfos[SCENE_BINDING_TOTAL] = {
+        {scene.instances.buffer, 0, VK_WHOLE_SIZE},
+        {scene.meshes.buffer, 0, VK_WHOLE_SIZE},
+        {scene.vertices.buffer, 0, VK_WHOLE_SIZE},
+        {frame.draws.buffer, 0, VK_WHOLE_SIZE},
+        {frame.counters.buffer, 0, VK_WHOLE_SIZE},
+        {scene.visibility.buffer, 0, VK_WHOLE_SIZE},
+        {},
+        {uniforms.buffer, uniforms.offset, sizeof(SceneViewUniforms)},
+    };
+    VkDescriptorImageInfo pyramidInfo{
+        .sampler = scene.pyramidSampler,
+        .imageView = scene.pyramid.view,
+        .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+    };
+    VkWriteDescriptorSet writes[SCENE_BINDING_TOTAL];
+    for (uint32_t i = 0; i < SCENE_BINDING_TOTAL; i++) {
+        writes[i] = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = scene.set,
+            .dstBinding = i,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &bufferInfos[i],
+        };
+    }
+    writes[SCENE_BINDING_PYRAMID].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[SCENE_BINDING_PYRAMID].pBufferInfo = nullptr;
+    writes[SCENE_BINDING_PYRAMID].pImageInfo = &pyramidInfo;
+    writes[SCENE_BINDING_VIEW].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    vkUpdateDescriptorSets(state->device, SCENE_BINDING_TOTAL, writes, 0, nullptr);
+
+    dispatchCull(state, commandBuffer, scene.twoPhase ? SCENE_CULL_EARLY : SCENE_CULL_ALL);
+    scene.stats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return scene.twoPhase;
+}
+
+// dispatch واحد لكل الهرم: كل مجموعة تختزل مربعاً من 64x64 حتى المستوى 6، وآخر مجموعة تنتهي تكمل الباقي
+static void buildDepthPyramid(State *state, VkCommandBuffer commandBuffer) {
+    Scene &scene = state->scene;
+    RenderTargets &targets = state->renderTargets;
+    gpuTimerBegin(state, commandBuffer, GPU_TIMER_DEPTH_PYRAMID);
+
+    BarrierBatch barriers;
+    transitionImage(&barriers, &targets.depthTarget, IMAGE_STATE_SHADER_READ);
+    transitionImage(&barriers, &scene.pyramidImage, PYRAMID_STATE_WRITE, true);
+    flushBarriers(commandBuffer, &barriers);
+
+    VkDescriptorSet set = allocateFrameDescriptorSet(state, scene.pyramidSetLayout);
+    VkDescriptorImageInfo depthInfo{
+        .sampler = scene.pyramidSampler,
+        .imageView = targets.depthTarget.view,
+        .imageLayout = IMAGE_STATE_SHADER_READ.layout,
+    };
+    // المستويات غير الموجودة تشير إلى آخر مستوى؛ الـ shader لا يكتب فيها
+    VkDescriptorImageInfo levelInfos[SCENE_PYRAMID_MAX_LEVELS];
+    for (uint32_t level = 0; level < SCENE_PYRAMID_MAX_LEVELS; level++) {
+        levelInfos[level] = {
+            .imageView = scene.pyramidLevels[std::min(level, scene.pyramid.mipLevels - 1)],
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+        };
+    }
+    VkDescriptorBufferInfo counterInfo{scene.pyramidCounter.buffer, 0, VK_WHOLE_SIZE};
+    VkWriteDescriptorSet writes[PYRAMID_BINDING_TOTAL] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = PYRAMID_BINDING_DEPTH,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo = &depthInfo,
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = PYRAMID_BINDING_LEVELS,
+            .descriptorCount = SCENE_PYRAMID_MAX_LEVELS,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .pImageInfo = levelInfos,
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = PYRAMID_BINDING_COUNTER,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &counterInfo,
+        },
+    };
+    vkUpdateDescriptorSets(state->device, PYRAMID_BINDING_TOTAL, writes, 0, nullptr);
+
+    VkExtent2D size = scene.pyramid.extent;
+    uint32_t groupsX = (size.width + SCENE_PYRAMID_TILE - 1) / SCENE_PYRAMID_TILE;
+    uint32_t groupsY = (size.height + SCENE_PYRAMID_TILE - 1) / SCENE_PYRAMID_TILE;
+    PyramidConstants constants{
+        .sourceSize = {(int32_t) targets.renderExtent.width, (int32_t) targets.renderExtent.height},
+        .pyramidSize = {(int32_t) size.width, (int32_t) size.height},
+        .levelCount = (int32_t) scene.pyramid.mipLevels,
+        .groupCount = groupsX * groupsY,
+    };
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, scene.pyramidPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, scene.pyramidPipelineLayout, 0, 1, &set,
+                            0, nullptr);
+    vkCmdPushConstants(commandBuffer, scene.pyramidPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(constants),
+                       &constants);
+    vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+
+    transitionImage(&barriers, &scene.pyramidImage, PYRAMID_STATE_READ);
+    flushBarriers(commandBuffer, &barriers);
+    gpuTimerEnd(state, commandBuffer, GPU_TIMER_DEPTH_PYRAMID);
+}
+
+void sceneCullLate(State *state, VkCommandBuffer commandBuffer) {
+    Scene &scene = state->scene;
+    if (!scene.twoPhase) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    buildDepthPyramid(state, commandBuffer);
+    dispatchCull(state, commandBuffer, SCENE_CULL_LATE);
+    scene.drawList = SCENE_LIST_LATE;
+    scene.stats.cpuMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void sceneRender(State *state, VkCommandBuffer commandBuffer) {
+    Scene &scene = state->scene;
+    // الإضاءة في scene.frag تقرأ قوائم الـ froxels من lightsCluster
+    if (scene.set == VK_NULL_HANDLE || state->lights.set == VK_NULL_HANDLE) {
+        return;
+    }
+    scene.pipeline.colorFormat = renderTargetFormat(state);
+    VkPipeline pipeline = getPipeline(state, scene.pipeline);
+    if (pipeline == VK_NULL_HANDLE) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    SceneFrame &frame = scene.frames[state->frameNumber % FRAMES_IN_FLIGHT];
+    uint32_t maxDraws = std::min(scene.stats.instances, scene.maxDraws);
+    VkDeviceSize drawOffset = (VkDeviceSize) scene.drawList * scene.maxDraws * sizeof(VkDrawIndexedIndirectCommand);
+    VkDeviceSize countOffset = offsetof(SceneCounters, draws) + scene.drawList * sizeof(uint32_t);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    VkDescriptorSet sets[] = {scene.set, state->lights.set};
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scene.pipelineLayout, 0, 2, sets, 0,
+                            nullptr);
+    vkCmdBindIndexBuffer(commandBuffer, scene.indices.buffer, 0, VK_INDEX_TYPE_UINT32);
+    if (scene.drawIndirectCount) {
+        vkCmdDrawIndexedIndirectCount(commandBuffer, frame.draws.buffer, drawOffset, frame.counters.buffer,
+                                      countOffset, maxDraws, sizeof(VkDrawIndexedIndirectCommand));
+    } else {
+        vkCmdDrawIndexedIndirect(commandBuffer, frame.draws.buffer, drawOffset, maxDraws,
+                                 sizeof(VkDrawIndexedIndirectCommand));
+    }
+    scene.stats.cpuMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// مكعب بأوجه منفصلة الأعمدة، مكمّم كما يفعل cooker
+static std::vector<uint8_t> cookCube() {
+    CookedMeshHeader header{
+        .magic = {COOKED_MESH_MAGIC[0], COOKED_MESH_MAGIC[1], COOKED_MESH_MAGIC[2], COOKED_MESH_MAGIC[3]},
+        .version = COOKED_VERSION,
+        .vertexCount = 24,
+        .indexCount = 36,
+        .indexSize = 2,
+        .positionOffset = {-0.5f, -0.5f, -0.5f},
+        .positionScale = {1.0f / 65535.0f, 1.0f / 65535.0f, 1.0f / 65535.0f},
+        .boundsCenter = {0, 0, 0},
+        .boundsRadius = 0.8660254f,
+    };
+    std::vector<uint8_t> data(sizeof(header) + 24 * sizeof(CookedVertex) + 36 * sizeof(uint16_t));
+    memcpy(data.data(), &header, sizeof(header));
+    CookedVertex *vertices = reinterpret_cast<CookedVertex *>(data.data() + sizeof(header));
+    uint16_t *indices = reinterpret_cast<uint16_t *>(vertices + 24);
+    for (uint32_t face = 0; face < 6; face++) {
+        uint32_t axis = face / 2;
+        int sign = face % 2 ? -1 : 1;
+        // u و v على المحورين الآخرين بترتيب يجعل الوجه عكس عقارب الساعة من الخارج
+        uint32_t u = (axis + (sign > 0 ? 1 : 2)) % 3;
+        uint32_t v = (axis + (sign > 0 ? 2 : 1)) % 3;
+        const uint32_t corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+        for (uint32_t corner = 0; corner < 4; corner++) {
+            CookedVertex &vertex = vertices[face * 4 + corner];
+            vertex = {};
+            vertex.position[axis] = sign > 0 ? 65535 : 0;
+            vertex.position[u] = corners[corner][0] ? 65535 : 0;
+            vertex.position[v] = corners[corner][1] ? 65535 : 0;
+            vertex.normal[axis] = (int8_t) (127 * sign);
+        }
+        const uint16_t quad[6] = {0, 1, 2, 0, 2, 3};
+        for (uint32_t i = 0; i < 6; i++) {
+            indices[face * 6 + i] = (uint16_t) (face * 4 + quad[i]);
+        }
+    }
+    return data;
+}
+
+void sceneBenchmarkGrid(State *state, float spacing) {
+    constexpr uint32_t gridSize = 320;
+    Scene &scene = state->scene;
+
+    std::vector<uint8_t> cube = cookCube();
+    const CookedMeshHeader *header = cookedMeshHeader(cube.data(), cube.size());
+    EXPECT(header == nullptr, "Benchmark cube is not a valid cooked mesh");
+    SceneMeshId mesh = sceneAddMesh(state, *header, cube.data() + sizeof(CookedMeshHeader));
+
+    uint32_t seed = 1;
+    for (uint32_t z = 0; z < gridSize; z++) {
+        for (uint32_t x = 0; x < gridSize; x++) {
+            seed = seed * 1664525u + 1013904223u;
+            float scale = 0.5f + (float) (seed >> 24) / 255.0f;
+            SceneInstance instance{
+                .transform = {
+                    scale, 0, 0, ((float) x - gridSize * 0.5f) * spacing,
+                    0, scale, 0, 0,
+                    0, 0, scale, ((float) z - gridSize * 0.5f) * spacing,
+                },
+                .mesh = mesh,
+                .color = 0xFF000000 | (seed & 0x00FFFFFF) | 0x00404040,
+            };
+            sceneAddInstance(state, instance);
+        }
+    }
+    scene.benchmarkStart = std::chrono::steady_clock::now();
+    std::cout << "Scene benchmark: " << scene.instanceData.size() << " instances" << std::endl;
+}
+
+void sceneBenchmarkFrame(State *state) {
+    constexpr uint32_t movingInstances = 256;
+    Scene &scene = state->scene;
+    if (!scene.enabled) {
+        return;
+    }
+    if (scene.instanceData.empty()) {
+        sceneBenchmarkGrid(state, 3.0f);
+    }
+
+    // الكاميرا تدور فوق الشبكة، وعدد ثابت من الـ instances يتحرك كل إطار
+    scene.benchmarkTime += 1.0f / 60.0f;
+    float angle = scene.benchmarkTime * 0.3f;
+    scene.camera.position[0] = 250.0f * cosf(angle);
+    scene.camera.position[1] = 40.0f;
+    scene.camera.position[2] = 250.0f * sinf(angle);
+    scene.camera.target[0] = 0;
+    scene.camera.target[1] = 0;
+    scene.camera.target[2] = 0;
+    for (uint32_t i = 0; i < movingInstances; i++) {
+        SceneInstanceId id = (SceneInstanceId) ((i * 7919u + scene.benchmarkFrames) % scene.instanceData.size());
+        SceneInstance instance = scene.instanceData[id];
+        instance.transform[7] = 2.0f * sinf(scene.benchmarkTime * 4.0f + (float) id);
+        sceneUpdateInstance(state, id, instance);
+    }
+
+    scene.benchmarkCpuMs += scene.stats.cpuMs;
+    scene.benchmarkFrames++;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - scene.benchmarkStart).count();
+    if (elapsed >= 1.0) {
+        printf("Scene: %u instances, %.1f FPS, %.3f ms CPU per frame, %u visible, %u updated\n",
+               scene.stats.instances, scene.benchmarkFrames / elapsed, scene.benchmarkCpuMs / scene.benchmarkFrames,
+               scene.stats.visible, scene.stats.updated);
+        scene.benchmarkStart = std::chrono::steady_clock::now();
+        scene.benchmarkFrames = 0;
+        scene.benchmarkCpuMs = 0;
+    }
+}
+
+void sceneOcclusionBenchmarkFrame(State *state) {
+    Scene &scene = state->scene;
+    if (!scene.enabled) {
+        return;
+    }
+    if (scene.instanceData.empty()) {
+        if (!scene.occlusionSupported) {
+            std::cout << "Occlusion benchmark: Hi-Z unavailable, frustum culling only" << std::endl;
+        }
+        sceneBenchmarkGrid(state, 1.6f);
+    }
+
+    // كاميرا على ارتفاع المكعبات تنظر عبر الشبكة: معظم ما في الـ frustum محجوب بما أمامه
+    scene.benchmarkTime += 1.0f / 60.0f;
+    float angle = scene.benchmarkTime * 0.2f;
+    scene.camera.position[0] = 200.0f * cosf(angle);
+    scene.camera.position[1] = 1.0f;
+    scene.camera.position[2] = 200.0f * sinf(angle);
+    scene.camera.target[0] = 0;
+    scene.camera.target[1] = 0.5f;
+    scene.camera.target[2] = 0;
+
+    // القياسات متأخرة بعدد الإطارات الجارية، فأول إطارات بعد التبديل تخص الوضع السابق
+    uint32_t mode = scene.occlusion ? 1 : 0;
+    if (scene.benchmarkFrames > FRAMES_IN_FLIGHT) {
+        scene.benchmarkGpuMs[mode] += state->gpuTimers.ms[GPU_TIMER_FRAME];
+        scene.benchmarkCulled[mode] += scene.stats.instances - std::min(scene.stats.visible, scene.stats.instances);
+        scene.benchmarkSamples[mode]++;
+        if (mode == 1) {
+            scene.benchmarkPyramidMs += state->gpuTimers.ms[GPU_TIMER_DEPTH_PYRAMID];
+        }
+    }
+    scene.benchmarkFrames++;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - scene.benchmarkStart).count();
+    if (elapsed < 1.0) {
+        return;
+    }
+    if (mode == 1 && scene.benchmarkSamples[0] > 0 && scene.benchmarkSamples[1] > 0) {
+        double instances = scene.stats.instances;
+        double gpuOff = scene.benchmarkGpuMs[0] / scene.benchmarkSamples[0];
+        double gpuOn = scene.benchmarkGpuMs[1] / scene.benchmarkSamples[1];
+        printf("Occlusion: %u instances, culled %.1f%% with Hi-Z (%.1f%% occluded) vs %.1f%% frustum only, "
+               "GPU frame %.3f ms vs %.3f ms, saved %.3f ms (depth pyramid %.3f ms)\n",
+               scene.stats.instances, 100.0 * scene.benchmarkCulled[1] / scene.benchmarkSamples[1] / instances,
+               100.0 * scene.stats.counters.occluded / instances,
+               100.0 * scene.benchmarkCulled[0] / scene.benchmarkSamples[0] / instances, gpuOn, gpuOff,
+               gpuOff - gpuOn, scene.benchmarkPyramidMs / scene.benchmarkSamples[1]);
+        for (uint32_t i = 0; i < 2; i++) {
+            scene.benchmarkGpuMs[i] = 0;
+            scene.benchmarkCulled[i] = 0;
+            scene.benchmarkSamples[i] = 0;
+        }
+        scene.benchmarkPyramidMs = 0;
+    }
+    scene.occlusion = scene.occlusionSupported && !scene.occlusion;
+    scene.benchmarkStart = std::chrono::steady_clock::now();
+    scene.benchmarkFrames = 0;
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "buffer.h"
+#include "cooked.h"
+#include "frame.h"
+#include "image.h"
+#include "pass.h"
+#include "pipeline.h"
+#include "upload.h"
+
+struct State;
+
+// السعات ثابتة: كل المخازن تُنشأ مرة واحدة ولا تكبر، فلا شيء في الإطار يتناسب مع عدد الـ instances
+constexpr uint32_t SCENE_MAX_INSTANCES = 1u << 18;
+constexpr uint32_t SCENE_MAX_MESHES = 1024;
+constexpr uint32_t SCENE_MAX_VERTICES = 1u << 20;
+constexpr uint32_t SCENE_MAX_INDICES = 1u << 22;
+constexpr uint32_t SCENE_CULL_GROUP_SIZE = 64;             // يطابق local_size_x في scene_cull.comp
+constexpr uint32_t SCENE_PYRAMID_MAX_LEVELS = 13;          // يطابق depth_pyramid.comp؛ حتى 4096 بكسل
+constexpr uint32_t SCENE_PYRAMID_TILE = 64;                // مربع المستوى 0 لكل مجموعة في depth_pyramid.comp
+
+typedef uint32_t SceneMeshId;
+typedef uint32_t SceneInstanceId;
+
+// يطابق SceneMesh في shaders/scene.glsl
+struct SceneMeshGpu {
+    uint32_t firstIndex;
+    uint32_t indexCount;        // 0 حتى يكتمل رفع الهندسة، فيُتخطى في التصفية
+    int32_t vertexOffset;
+    float boundsRadius;
+    float positionOffset[4];
+    float positionScale[4];
+    float boundsCenter[4];
+};
+
+// يطابق SceneInstance في shaders/scene.glsl؛ التحويل 3x4 بالصفوف
+struct SceneInstance {
+    float transform[12];
+    uint32_t mesh;
+    uint32_t color;             // RGBA8، R في البايت الأدنى
+    uint32_t reserved[2];
+};
+
+static_assert(sizeof(SceneMeshGpu) == 64, "SceneMeshGpu layout");
+static_assert(sizeof(SceneInstance) == 64, "SceneInstance layout");
+
+struct SceneCamera {
+    float position[3] = {0, 0, 5};
+    float target[3] = {0, 0, 0};
+    float fovY = 1.0f;          // بالراديان
+    float nearPlane = 0.1f;     // عمق معكوس بدون مستوى بعيد
+};
+
+// قائمتا أوامر في نفس المخزن: الأولى للتصفية في مرحلة واحدة أو المرحلة المبكرة، والثانية للمتأخرة
+enum SceneDrawList : uint32_t {
+    SCENE_LIST_EARLY,
+    SCENE_LIST_LATE,
+    SCENE_LIST_COUNT,
+};
+
+// يطابق SceneCounters في scene_cull.comp
+struct SceneCounters {
+    uint32_t draws[SCENE_LIST_COUNT];
+    uint32_t occluded;          // داخل الـ frustum لكن خلف هرم العمق
+    uint32_t inFrustum;
+};
+
+struct SceneFrame {
+    Buffer draws;               // VkDrawIndexedIndirectCommand مضغوطة يكتبها الـ compute، maxDraws لكل قائمة
+    Buffer counters;            // SceneCounters؛ مرئي للمضيف ليُقرأ حين تعود الفتحة
+    Buffer staging;             // تعديلات الـ instances والمجسمات لهذا الإطار
+};
+
+struct SceneStats {
+    uint32_t instances = 0;
+    SceneCounters counters{};   // من آخر إطار اكتمل في هذه الفتحة
+    uint32_t visible = 0;
+    uint32_t updated = 0;       // instances نُسخت هذا الإطار
+    double cpuMs = 0;
+};
+
+struct Scene {
+    bool enabled = false;
+    bool drawIndirectCount = false;             // وإلا vkCmdDrawIndexedIndirect بالعدد الأقصى وأوامر مصفّرة
+    uint32_t maxDraws = 0;
+
+    // هندسة كل المجسمات في مخزنين مشتركين، فكل الرسم بربط واحد للفهارس
+    Buffer vertices;
+    Buffer indices;
+    Buffer meshes;
+    Buffer instances;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    std::vector<SceneMeshGpu> meshTable;
+    std::vector<UploadTicket> meshTickets;      // تذكرة الهندسة لكل مجسم؛ 0 بعد أن يُنشر في الجدول
+    uint32_t pendingMeshes = 0;                 // التذاكر غير الصفرية؛ بدونها لا يُمسح meshTickets كل إطار
+    bool meshesDirty = false;
+
+    // نسخة المضيف؛ لا يُرفع منها إلا ما تغير
+    std::vector<SceneInstance> instanceData;
+    std::vector<SceneInstanceId> dirty;
+    std::vector<uint8_t> dirtyFlags;
+    std::vector<VkBufferCopy> copies;
+
+    // تصفية الحجب بمرحلتين: ما كان مرئياً في الإطار السابق يُرسم أولاً، ومن عمقه يُبنى الهرم
+    // الذي تُختبر عليه البقية، فما ظهر للتو يُرسم في نفس الإطار دون وميض
+    bool occlusionSupported = false;            // يتطلب عمقاً بعينة واحدة قابلاً للقراءة
+    bool occlusion = false;
+    bool twoPhase = false;                      // occlusion في الإطار الجاري
+    bool buffersCleared = false;
+    Buffer visibility;                          // uint لكل instance: مرئي في آخر مرحلة متأخرة
+    Buffer pyramidCounter;                      // آخر مجموعة في depth_pyramid.comp تكمل المستويات الصغيرة
+    Image pyramid;                              // R32 بأصغر عمق (الأبعد مع العمق المعكوس) لكل مربع
+    PassImage pyramidImage;
+    VkImageView pyramidLevels[SCENE_PYRAMID_MAX_LEVELS] = {};
+    VkExtent2D pyramidSource{};
+    VkSampler pyramidSampler = VK_NULL_HANDLE;              // يملكه كاش الـ samplers
+    VkDescriptorSetLayout pyramidSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pyramidPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pyramidPipeline = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;       // يملكه كاش التخطيطات
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline cullPipeline = VK_NULL_HANDLE;
+    PipelineDesc pipeline;
+    VkDescriptorSet set = VK_NULL_HANDLE;                   // للإطار الجاري فقط
+    SceneDrawList drawList = SCENE_LIST_EARLY;              // ما يرسمه sceneRender التالي
+
+    SceneFrame frames[FRAMES_IN_FLIGHT];
+    SceneCamera camera;
+    float view[16] = {};                                    // بالأعمدة كما يقرؤها GLSL
+    float projection[16] = {};
+    float viewProjection[16] = {};
+    SceneStats stats;
+
+    // --bench scene
+    std::chrono::steady_clock::time_point benchmarkStart;
+    uint32_t benchmarkFrames = 0;
+    double benchmarkCpuMs = 0;
+    float benchmarkTime = 0;
+    double benchmarkGpuMs[2] = {};              // --bench occlusion: [0] بدون، [1] مع
+    double benchmarkPyramidMs = 0;
+    uint32_t benchmarkSamples[2] = {};
+    uint64_t benchmarkCulled[2] = {};           // مجموع ما لم يُرسم من الـ instances
+};
+
+void createScene(State *state);
+void destroyScene(State *state);
+
+// الهندسة تُرفع في الخلفية؛ الـ instances التي تشير إلى المجسم لا تُرسم حتى يكتمل الرفع
+SceneMeshId sceneAddMesh(State *state, const CookedMeshHeader &header, const void *data);
+SceneInstanceId sceneAddInstance(State *state, const SceneInstance &instance);
+void sceneUpdateInstance(State *state, SceneInstanceId id, const SceneInstance &instance);
+
+// قبل الممر الرئيسي: ينسخ التعديلات ثم يصفّي كل الـ instances على الـ GPU ويكتب أوامر الرسم.
+// تعيد true إن كان الإطار بمرحلتين: ممر مبكر يُرسم فيه sceneRender ثم sceneCullLate ثم الممر الرئيسي
+bool sceneCull(State *state, VkCommandBuffer commandBuffer);
+
+// بعد الممر المبكر (العمق مخزّن): يبني هرم العمق في dispatch واحد ثم يختبر كل الـ instances عليه
+void sceneCullLate(State *state, VkCommandBuffer commandBuffer);
+
+// داخل الممر: رسم غير مباشر واحد للقائمة الجارية مهما كان عدد الـ instances
+void sceneRender(State *state, VkCommandBuffer commandBuffer);
+
+// شبكة 320x320 من المكعبات بالمسافة المعطاة بين المراكز، لمقاييس الأداء
+void sceneBenchmarkGrid(State *state, float spacing);
+
+// --bench scene: شبكة من مكعبات تدور حولها الكاميرا
+void sceneBenchmarkFrame(State *state);
+
+// --bench occlusion: شبكة كثيفة بكاميرا منخفضة، مع الحجب وبدونه بالتناوب كل ثانية
+void sceneOcclusionBenchmarkFrame(State *state);
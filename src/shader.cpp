@@ -0,0 +1,105 @@
+#include "shader.h"
+#include "state.h"
+
+#include "embedded_shaders.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static bool readOverride(State *state, const char *name, std::vector<uint32_t> *code) {
+    const char *directory = state->shaders.overrideDirectory;
+    if (!directory) {
+        return false;
+    }
+    std::string path = std::string(directory) + "/" + name + ".spv";
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    size_t size = (size_t) file.tellg();
+    EXPECT(size == 0 || size % 4 != 0, "Invalid SPIR-V size %zu in %s", size, path.c_str());
+    code->resize(size / 4);
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(code->data()), (std::streamsize) size);
+    return true;
+}
+
+// ملف --shader-dir إن وُجد وإلا النسخة المضمّنة؛ يُستدعى والقفل مأخوذ
+static EmbeddedShader findShader(State *state, const char *name) {
+    ShaderCache &cache = state->shaders;
+    if (cache.overrideDirectory) {
+        auto found = cache.overrides.find(name);
+        if (found == cache.overrides.end()) {
+            ShaderOverride entry;
+            if (readOverride(state, name, &entry.code)) {
+                entry.hash = spirvHash(entry.code.data(), entry.code.size());
+                entry.specConstants = spirvSpecConstantMask(entry.code.data(), entry.code.size());
+            }
+            found = cache.overrides.emplace(name, std::move(entry)).first;
+        }
+        const ShaderOverride &entry = found->second;
+        if (!entry.code.empty()) {
+            return {name, entry.code.data(), entry.code.size(), entry.hash, entry.specConstants};
+        }
+    }
+    for (const EmbeddedShader &shader : EMBEDDED_SHADERS) {
+        if (strcmp(shader.name, name) == 0) {
+            return shader;
+        }
+    }
+    return {name, nullptr, 0, 0, 0};
+}
+
+VkShaderModule getShaderModule(State *state, const char *name) {
+    ShaderCache &cache = state->shaders;
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    EmbeddedShader shader = findShader(state, name);
+    const uint32_t *code = shader.code;
+    size_t wordCount = shader.wordCount;
+    uint64_t hash = shader.hash;
+    EXPECT(code == nullptr, "Unknown shader %s", name);
+
+    auto found = cache.modules.find(hash);
+    if (found != cache.modules.end()) {
+        cache.hits++;
+        return found->second;
+    }
+    VkShaderModuleCreateInfo createInfo{
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = wordCount * sizeof(uint32_t),
+        .pCode = code,
+    };
+    VkShaderModule module;
+    VkResult result = vkCreateShaderModule(state->device, &createInfo, state->allocator, &module);
+    EXPECT(result != VK_SUCCESS, "Failed to create shader module %s", name);
+    cache.modules.emplace(hash, module);
+    cache.misses++;
+    return module;
+}
+
+uint32_t shaderSpecConstants(State *state, const char *name) {
+    std::lock_guard<std::mutex> lock(state->shaders.mutex);
+    EmbeddedShader shader = findShader(state, name);
+    EXPECT(shader.code == nullptr, "Unknown shader %s", name);
+    return shader.specConstants;
+}
+
+void shaderReloadOverrides(State *state) {
+    std::lock_guard<std::mutex> lock(state->shaders.mutex);
+    state->shaders.overrides.clear();
+}
+
+void destroyShaderCache(State *state) {
+    ShaderCache &cache = state->shaders;
+    for (auto &[hash, module] : cache.modules) {
+        vkDestroyShaderModule(state->device, module, state->allocator);
+    }
+    if (!cache.modules.empty()) {
+        std::cout << "Shader cache: " << cache.misses << " modules created, " << cache.hits << " reused" << std::endl;
+    }
+    cache.modules.clear();
+    cache.overrides.clear();
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+struct State;
+
+// FNV-1a على كلمات الـ SPIR-V؛ يُحسب أثناء الترجمة للـ shaders المضمّنة
+constexpr uint64_t spirvHash(const uint32_t *code, size_t wordCount) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < wordCount; i++) {
+        for (uint32_t shift = 0; shift < 32; shift += 8) {
+            hash ^= (code[i] >> shift) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// البت i مضبوط إن كان الـ shader يعلن ثابت تخصيص بـ constant_id = i (من تعليمات OpDecorate SpecId)
+constexpr uint32_t spirvSpecConstantMask(const uint32_t *code, size_t wordCount) {
+    const uint32_t OP_DECORATE = 71;
+    const uint32_t DECORATION_SPEC_ID = 1;
+    uint32_t mask = 0;
+    for (size_t i = 5; i < wordCount;) {
+        uint32_t length = code[i] >> 16;
+        if (length == 0 || i + length > wordCount) {
+            break;
+        }
+        if ((code[i] & 0xffff) == OP_DECORATE && length >= 4 && code[i + 2] == DECORATION_SPEC_ID &&
+            code[i + 3] < 32) {
+            mask |= 1u << code[i + 3];
+        }
+        i += length;
+    }
+    return mask;
+}
+
+// shader مترجم إلى SPIR-V أثناء البناء ومضمّن في الملف التنفيذي (embedded_shaders.h المولَّد)
+struct EmbeddedShader {
+    const char *name;
+    const uint32_t *code;
+    size_t wordCount;
+    uint64_t hash;
+    uint32_t specConstants;
+};
+
+template<size_t N>
+constexpr EmbeddedShader embeddedShader(const char *name, const uint32_t (&code)[N]) {
+    return {name, code, N, spirvHash(code, N), spirvSpecConstantMask(code, N)};
+}
+
+// مفتاح متغير الـ shader: كل قيمة في enum الميزات هي constant_id لثابت تخصيص bool.
+// الـ enum يجب أن ينتهي بـ Count
+template<typename Feature>
+struct ShaderVariant {
+    static_assert(std::is_enum_v<Feature>, "ShaderVariant needs a feature enum");
+    static_assert((uint32_t) Feature::Count <= 32, "At most 32 features per variant");
+
+    uint32_t bits = 0;
+
+    constexpr ShaderVariant() = default;
+    constexpr ShaderVariant(std::initializer_list<Feature> features) {
+        for (Feature feature : features) {
+            bits |= 1u << (uint32_t) feature;
+        }
+    }
+    constexpr ShaderVariant with(Feature feature, bool enabled = true) const {
+        ShaderVariant variant = *this;
+        variant.bits = enabled ? bits | (1u << (uint32_t) feature) : bits & ~(1u << (uint32_t) feature);
+        return variant;
+    }
+    constexpr bool has(Feature feature) const {
+        return (bits >> (uint32_t) feature) & 1;
+    }
+    constexpr bool operator==(const ShaderVariant &) const = default;
+};
+
+// ملف --shader-dir بعد قراءته؛ code فارغ يعني لا ملف لهذا الاسم فتُستخدم النسخة المضمّنة
+struct ShaderOverride {
+    std::vector<uint32_t> code;
+    uint64_t hash = 0;
+    uint32_t specConstants = 0;
+};
+
+// كل module يُنشأ مرة واحدة لكل محتوى، ويبقى حتى الإغلاق
+struct ShaderCache {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, VkShaderModule> modules;
+    const char *overrideDirectory = nullptr;    // --shader-dir: ملفات .spv تحل محل المضمّنة أثناء التطوير
+    std::unordered_map<std::string, ShaderOverride> overrides;  // يُقرأ كل ملف مرة حتى shaderReloadOverrides
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+};
+
+// آمنة من أي خيط
+VkShaderModule getShaderModule(State *state, const char *name);
+uint32_t shaderSpecConstants(State *state, const char *name);
+
+// يُهمل ملفات --shader-dir المقروءة فيعيد الطلب التالي قراءتها؛ الـ modules القديمة تبقى لأنها بحسب المحتوى
+void shaderReloadOverrides(State *state);
+void destroyShaderCache(State *state);
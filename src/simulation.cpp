@@ -0,0 +1,227 @@
+#include "simulation.h"
+#include "sprite.h"
+#include "state.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void spawnDemo(State *state, uint32_t count) {
+    Simulation &simulation = state->simulation;
+    ComponentMask mask = ecsMask({simulation.transform, simulation.velocity, simulation.visual});
+    uint32_t seed = 7;
+    auto random = [&seed](float low, float high) {
+        seed = seed * 1664525u + 1013904223u;
+        return low + (high - low) * (float) (seed >> 8) / (float) (1u << 24);
+    };
+    for (uint32_t i = 0; i < count; i++) {
+        Entity entity = ecsCreateEntity(state, mask);
+        *ecsGet<Transform2D>(state, entity, simulation.transform) = {
+            random(0, simulation.worldWidth), random(0, simulation.worldHeight), random(0, 6.2831853f)};
+        *ecsGet<Velocity2D>(state, entity, simulation.velocity) = {
+            random(-150, 150), random(-150, 150), random(-3, 3)};
+        float size = random(6, 20);
+        uint32_t color = 0xFF000000 | (uint32_t) random(64, 255) | (uint32_t) random(64, 255) << 8 |
+                         (uint32_t) random(64, 255) << 16;
+        *ecsGet<SpriteVisual>(state, entity, simulation.visual) = {
+            size, size, color, state->sprites.whiteTexture, i % 4};
+    }
+}
+
+// تحديث واحد بخطوة ثابتة؛ لا يعتمد على معدل العرض
+static void tick(State *state, float dt) {
+    Simulation &simulation = state->simulation;
+    float width = simulation.worldWidth;
+    float height = simulation.worldHeight;
+    ecsForEachChunk(state, simulation.movingQuery, [&](const ChunkView &chunk) {
+        Transform2D *transforms = chunk.column<Transform2D>(simulation.transform);
+        Velocity2D *velocities = chunk.column<Velocity2D>(simulation.velocity);
+        for (uint32_t i = 0; i < chunk.count; i++) {
+            Transform2D &transform = transforms[i];
+            Velocity2D &velocity = velocities[i];
+            transform.x += velocity.x * dt;
+            transform.y += velocity.y * dt;
+            transform.rotation += velocity.spin * dt;
+            if ((transform.x < 0 && velocity.x < 0) || (transform.x > width && velocity.x > 0)) {
+                velocity.x = -velocity.x;
+            }
+            if ((transform.y < 0 && velocity.y < 0) || (transform.y > height && velocity.y > 0)) {
+                velocity.y = -velocity.y;
+            }
+        }
+    });
+}
+
+static uint32_t acquireWriteSnapshot(Simulation &simulation) {
+    std::lock_guard<std::mutex> lock(simulation.mutex);
+    for (uint32_t i = 0; i < SIMULATION_SNAPSHOT_COUNT; i++) {
+        if (i != simulation.latest && i != simulation.previous && i != simulation.readingLatest &&
+            i != simulation.readingPrevious) {
+            return i;
+        }
+    }
+    EXPECT(true, "No free simulation snapshot");
+    return 0;
+}
+
+static void publish(State *state, uint64_t tickNumber, double time) {
+    Simulation &simulation = state->simulation;
+    uint32_t index = acquireWriteSnapshot(simulation);
+    SimulationSnapshot &snapshot = simulation.snapshots[index];
+    snapshot.tick = tickNumber;
+    snapshot.time = time;
+
+    // النسخ خارج القفل: العارض لا يلمس هذه النسخة حتى تُنشر
+    uint32_t count = ecsQueryCount(state, simulation.visibleQuery);
+    snapshot.entities.resize(count);
+    snapshot.transforms.resize(count);
+    snapshot.visuals.resize(count);
+    uint32_t offset = 0;
+    ecsForEachChunk(state, simulation.visibleQuery, [&](const ChunkView &chunk) {
+        memcpy(&snapshot.entities[offset], chunk.entities(), chunk.count * sizeof(Entity));
+        memcpy(&snapshot.transforms[offset], chunk.column<Transform2D>(simulation.transform),
+               chunk.count * sizeof(Transform2D));
+        memcpy(&snapshot.visuals[offset], chunk.column<SpriteVisual>(simulation.visual),
+               chunk.count * sizeof(SpriteVisual));
+        offset += chunk.count;
+    });
+
+    std::lock_guard<std::mutex> lock(simulation.mutex);
+    simulation.previous = simulation.latest;
+    simulation.latest = index;
+}
+
+static void simulationMain(State *state) {
+    Simulation &simulation = state->simulation;
+    uint64_t tickNumber = 0;
+    double simulatedTime = 0;
+    publish(state, tickNumber, simulatedTime);
+
+    while (simulation.running.load(std::memory_order_relaxed)) {
+        double now = secondsSince(simulation.start);
+        // متأخرون أكثر من الحد: نتخلى عن الوقت الزائد بدل محاولة اللحاق به
+        double behind = now - simulatedTime;
+        uint64_t dropped = 0;
+        if (behind > SIMULATION_MAX_CATCH_UP_TICKS * SIMULATION_DT) {
+            dropped = (uint64_t) (behind / SIMULATION_DT) - SIMULATION_MAX_CATCH_UP_TICKS;
+            simulatedTime += (double) dropped * SIMULATION_DT;
+        }
+
+        while (simulatedTime + SIMULATION_DT <= now) {
+            auto tickStart = std::chrono::steady_clock::now();
+            tick(state, (float) SIMULATION_DT);
+            tickNumber++;
+            simulatedTime += SIMULATION_DT;
+            publish(state, tickNumber, simulatedTime);
+            double tickMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart)
+                .count();
+
+            std::lock_guard<std::mutex> lock(simulation.mutex);
+            simulation.stats.ticks++;
+            simulation.stats.ticksSinceRead++;
+            simulation.stats.tickMs += tickMs;
+            simulation.stats.maxTickMs = std::max(simulation.stats.maxTickMs, tickMs);
+        }
+        if (dropped > 0) {
+            std::lock_guard<std::mutex> lock(simulation.mutex);
+            simulation.stats.droppedTicks += dropped;
+        }
+
+        std::this_thread::sleep_until(simulation.start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(simulatedTime + SIMULATION_DT)));
+    }
+}
+
+void startSimulation(State *state) {
+    Simulation &simulation = state->simulation;
+    simulation.transform = ecsComponent<Transform2D>(state, "Transform2D");
+    simulation.velocity = ecsComponent<Velocity2D>(state, "Velocity2D");
+    simulation.visual = ecsComponent<SpriteVisual>(state, "SpriteVisual");
+    simulation.movingQuery = ecsQuery(state, ecsMask({simulation.transform, simulation.velocity}));
+    simulation.visibleQuery = ecsQuery(state, ecsMask({simulation.transform, simulation.visual}));
+    simulation.worldWidth = (float) state->swapchainExtent.width;
+    simulation.worldHeight = (float) state->swapchainExtent.height;
+
+    if (state->benchmark && strcmp(state->benchmark, "simulation") == 0) {
+        spawnDemo(state, 20000);
+    }
+
+    simulation.start = std::chrono::steady_clock::now();
+    simulation.lastReport = simulation.start;
+    simulation.running = true;
+    simulation.thread = std::thread(simulationMain, state);
+}
+
+void stopSimulation(State *state) {
+    Simulation &simulation = state->simulation;
+    if (!simulation.thread.joinable()) {
+        return;
+    }
+    simulation.running = false;
+    simulation.thread.join();
+}
+
+void simulationDrawSprites(State *state) {
+    Simulation &simulation = state->simulation;
+    // العرض متأخر بخطوة واحدة ليكون بين نسختين منشورتين دائماً
+    double renderTime = secondsSince(simulation.start) - SIMULATION_DT;
+    {
+        std::lock_guard<std::mutex> lock(simulation.mutex);
+        simulation.readingLatest = simulation.latest;
+        simulation.readingPrevious = simulation.previous;
+    }
+    if (simulation.readingLatest == UINT32_MAX) {
+        return;
+    }
+
+    const SimulationSnapshot &current = simulation.snapshots[simulation.readingLatest];
+    const SimulationSnapshot *previous = simulation.readingPrevious != UINT32_MAX
+                                             ? &simulation.snapshots[simulation.readingPrevious] : nullptr;
+    float alpha = 1.0f;
+    if (previous && current.time > previous->time) {
+        alpha = (float) std::clamp((renderTime - previous->time) / (current.time - previous->time), 0.0, 1.0);
+    }
+
+    // الاستيفاء فقط حين تكون الكيانات في نفس المواضع، أي لم تتغير البنية بين التحديثين
+    bool matching = previous && previous->entities.size() == current.entities.size();
+    for (size_t i = 0; i < current.entities.size(); i++) {
+        Transform2D transform = current.transforms[i];
+        if (matching && previous->entities[i].index == current.entities[i].index &&
+            previous->entities[i].generation == current.entities[i].generation) {
+            const Transform2D &from = previous->transforms[i];
+            transform.x = from.x + (transform.x - from.x) * alpha;
+            transform.y = from.y + (transform.y - from.y) * alpha;
+            transform.rotation = from.rotation + (transform.rotation - from.rotation) * alpha;
+        }
+        const SpriteVisual &visual = current.visuals[i];
+        drawSprite(state, {
+            .position = {transform.x, transform.y},
+            .size = {visual.width, visual.height},
+            .rotation = transform.rotation,
+            .color = visual.color,
+            .texture = visual.texture,
+            .layer = visual.layer,
+        });
+    }
+
+    size_t drawn = current.entities.size();
+    std::lock_guard<std::mutex> lock(simulation.mutex);
+    simulation.readingLatest = UINT32_MAX;
+    simulation.readingPrevious = UINT32_MAX;
+
+    if (state->benchmark && strcmp(state->benchmark, "simulation") == 0 && secondsSince(simulation.lastReport) >= 1.0) {
+        SimulationStats &stats = simulation.stats;
+        printf("Simulation: tick %llu, %zu entities, %.3f ms avg / %.3f ms max per tick, %llu ticks dropped\n",
+               (unsigned long long) stats.ticks, drawn,
+               stats.ticksSinceRead ? stats.tickMs / stats.ticksSinceRead : 0.0, stats.maxTickMs,
+               (unsigned long long) stats.droppedTicks);
+        stats.tickMs = 0;
+        stats.maxTickMs = 0;
+        stats.ticksSinceRead = 0;
+        simulation.lastReport = std::chrono::steady_clock::now();
+    }
+}
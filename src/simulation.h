@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ecs.h"
+
+struct State;
+
+constexpr double SIMULATION_TICK_RATE = 60.0;
+constexpr double SIMULATION_DT = 1.0 / SIMULATION_TICK_RATE;
+// أقصى عدد تحديثات للّحاق بالوقت؛ ما زاد يُسقط بدل أن تتراكم الأعمال (spiral of death)
+constexpr uint32_t SIMULATION_MAX_CATCH_UP_TICKS = 5;
+// اثنتان يقرأهما العارض، واثنتان آخر ما نُشر، وواحدة قيد الكتابة
+constexpr uint32_t SIMULATION_SNAPSHOT_COUNT = 5;
+
+struct Transform2D {
+    float x, y, rotation;
+};
+
+struct Velocity2D {
+    float x, y, spin;
+};
+
+struct SpriteVisual {
+    float width, height;
+    uint32_t color;
+    uint32_t texture;
+    uint32_t layer;
+};
+
+// نسخة ثابتة من الحالة بعد تحديث واحد؛ العارض يقرأ منها فقط
+struct SimulationSnapshot {
+    uint64_t tick = 0;
+    double time = 0;                // بالثواني من بداية المحاكاة، على نفس ساعة العارض
+    std::vector<Entity> entities;
+    std::vector<Transform2D> transforms;
+    std::vector<SpriteVisual> visuals;
+};
+
+struct SimulationStats {
+    uint64_t ticks = 0;
+    uint64_t droppedTicks = 0;
+    double tickMs = 0;              // مجموع زمن التحديثات منذ آخر قراءة
+    double maxTickMs = 0;
+    uint32_t ticksSinceRead = 0;
+};
+
+struct Simulation {
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::chrono::steady_clock::time_point start;
+    float worldWidth = 0, worldHeight = 0;
+
+    ComponentId transform = 0, velocity = 0, visual = 0;
+    QueryId movingQuery = 0, visibleQuery = 0;
+
+    std::mutex mutex;               // يحمي الفهارس والإحصاءات فقط، لا بيانات النسخ
+    SimulationSnapshot snapshots[SIMULATION_SNAPSHOT_COUNT];
+    uint32_t latest = UINT32_MAX, previous = UINT32_MAX;
+    uint32_t readingLatest = UINT32_MAX, readingPrevious = UINT32_MAX;
+    SimulationStats stats;
+
+    std::chrono::steady_clock::time_point lastReport;
+};
+
+// يبدأ خيط المحاكاة؛ بعدها يصبح الـ World ملكاً لذلك الخيط وحده
+void startSimulation(State *state);
+void stopSimulation(State *state);
+
+// يرسم آخر حالتين منشورتين مع الاستيفاء حسب وقت العرض الحالي
+void simulationDrawSprites(State *state);
@@ -0,0 +1,421 @@
+#include "sprite.h"
+#include "bindless.h"
+#include "descriptors.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+static const uint32_t streamStrides[SPRITE_STREAM_COUNT] = {
+    sizeof(SpriteVec2),
+    sizeof(SpriteVec2),
+    sizeof(float),
+    sizeof(SpriteRect),
+    sizeof(uint32_t),
+    sizeof(uint32_t),
+};
+
+static const VkFormat streamFormats[SPRITE_STREAM_COUNT] = {
+    VK_FORMAT_R32G32_SFLOAT,
+    VK_FORMAT_R32G32_SFLOAT,
+    VK_FORMAT_R32_SFLOAT,
+    VK_FORMAT_R32G32B32A32_SFLOAT,
+    VK_FORMAT_R8G8B8A8_UNORM,
+    VK_FORMAT_R32_UINT,
+};
+
+struct SpritePushConstants {
+    float viewScale[2];
+    float viewOrigin[2];
+};
+
+// الترجمة تتم على خيوط مدير الـ pipelines؛ الصيغة تُضبط عند الرسم لأنها تتبع الـ swapchain
+static PipelineDesc spritePipelineDesc(State *state) {
+    SpriteRenderer &renderer = state->sprites;
+    PipelineDesc desc;
+    setPipelineShaders(&desc, "sprite.vert", renderer.bindless ? "sprite_bindless.frag" : "sprite.frag");
+    desc.layout = registerPipelineLayout(state, renderer.bindless ? "sprite.bindless" : "sprite",
+                                         renderer.pipelineLayout);
+    setPipelineVariant(state, &desc, renderer.variant);
+    desc.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    desc.blend = BlendMode::Alpha;
+    desc.colorFormat = renderTargetFormat(state);
+    desc.depthFormat = state->renderTargets.depthFormat;
+    desc.samples = state->renderTargets.samples;
+    desc.bindingCount = SPRITE_STREAM_COUNT;
+    desc.attributeCount = SPRITE_STREAM_COUNT;
+    for (uint32_t i = 0; i < SPRITE_STREAM_COUNT; i++) {
+        desc.bindings[i] = {.stride = streamStrides[i], .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE};
+        desc.attributes[i] = {.location = i, .binding = i, .format = streamFormats[i], .offset = 0};
+    }
+    return desc;
+}
+
+void createSpriteRenderer(State *state) {
+    SpriteRenderer &renderer = state->sprites;
+    renderer.bindless = state->bindless.set != VK_NULL_HANDLE;
+
+    if (renderer.bindless) {
+        renderer.pipelineLayout = state->bindless.pipelineLayout;
+    } else {
+        VkSamplerCreateInfo samplerInfo{
+            .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+            .magFilter = VK_FILTER_LINEAR,
+            .minFilter = VK_FILTER_LINEAR,
+            .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+            .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+            .maxLod = 1000.0f,
+        };
+        renderer.sampler = getSampler(state, samplerInfo);
+        VkDescriptorSetLayoutBinding binding{
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+        };
+        renderer.textureSetLayout = getDescriptorSetLayout(state, &binding, 1);
+
+        // نفس شكل الـ push constants في تخطيط الـ bindless ليعمل spriteRender بنفس الطريقة في المسارين
+        VkPushConstantRange pushConstantRange{
+            .stageFlags = VK_SHADER_STAGE_ALL,
+            .offset = 0,
+            .size = sizeof(SpritePushConstants),
+        };
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = 1,
+            .pSetLayouts = &renderer.textureSetLayout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &pushConstantRange,
+        };
+        VkResult result = vkCreatePipelineLayout(state->device, &pipelineLayoutInfo, state->allocator,
+                                                 &renderer.pipelineLayout);
+        EXPECT(result != VK_SUCCESS, "Failed to create sprite pipeline layout");
+    }
+    renderer.pipeline = spritePipelineDesc(state);
+    requestPipeline(state, renderer.pipeline);
+
+    if (renderer.bindless) {
+        // معرّفات الـ sprites في هذا المسار هي فهارس الكومة نفسها
+        renderer.whiteTexture = BINDLESS_DEFAULT_TEXTURE;
+    } else {
+        const uint32_t white = 0xFFFFFFFF;
+        renderer.ownedWhiteTexture = createTexture(state, {.width = 1, .height = 1}, &white);
+        renderer.whiteTexture = spriteRegisterTexture(state, renderer.ownedWhiteTexture);
+    }
+    std::cout << "Sprite renderer: " << (renderer.bindless ? "bindless, one draw per frame" : "one draw per texture")
+              << std::endl;
+}
+
+void destroySpriteRenderer(State *state) {
+    SpriteRenderer &renderer = state->sprites;
+    for (Texture &texture : renderer.benchmarkTextures) {
+        destroyTexture(state, &texture);
+    }
+    destroyTexture(state, &renderer.ownedWhiteTexture);
+    for (SpriteFrameBuffer &frame : renderer.frames) {
+        destroyBuffer(state, &frame.buffer);
+    }
+    if (!renderer.bindless) {
+        deferDestroy(state, renderer.pipelineLayout);
+    }
+    renderer = {};
+}
+
+void spriteSetVariant(State *state, ShaderVariant<SpriteFeature> variant) {
+    SpriteRenderer &renderer = state->sprites;
+    renderer.variant = variant;
+    renderer.pipeline = spritePipelineDesc(state);
+    requestPipeline(state, renderer.pipeline);
+}
+
+uint32_t spriteRegisterTexture(State *state, const Texture &texture) {
+    SpriteRenderer &renderer = state->sprites;
+    uint32_t id = renderer.bindless
+                      ? bindlessAddSampledImage(state, texture.image.view, texture.layout)
+                      : (uint32_t) renderer.textureViews.size();
+    EXPECT(id >= (1u << SPRITE_TEXTURE_BITS), "Sprite texture id %u does not fit in the sort key", id);
+    if (id >= renderer.textureViews.size()) {
+        renderer.textureViews.resize(id + 1, VK_NULL_HANDLE);
+        renderer.textureLayouts.resize(id + 1, VK_IMAGE_LAYOUT_UNDEFINED);
+    }
+    renderer.textureViews[id] = texture.image.view;
+    renderer.textureLayouts[id] = texture.layout;
+    return id;
+}
+
+void drawSprite(State *state, const Sprite &sprite) {
+    SpriteInstances &instances = state->sprites.instances;
+    instances.position.push_back(sprite.position);
+    instances.size.push_back(sprite.size);
+    instances.rotation.push_back(sprite.rotation);
+    instances.uv.push_back(sprite.uv);
+    instances.color.push_back(sprite.color);
+    instances.texture.push_back(sprite.texture);
+    instances.key.push_back(std::min(sprite.layer, SPRITE_MAX_LAYER) << SPRITE_TEXTURE_BITS | sprite.texture);
+    instances.count++;
+}
+
+static void clearInstances(SpriteInstances &instances) {
+    instances.position.clear();
+    instances.size.clear();
+    instances.rotation.clear();
+    instances.uv.clear();
+    instances.color.clear();
+    instances.texture.clear();
+    instances.key.clear();
+    instances.count = 0;
+}
+
+// LSD radix sort على 4 خانات من 8 بت؛ مستقر، فالـ sprites بنفس المفتاح تحافظ على ترتيب الإرسال
+static void radixSort(const uint32_t *keys, uint32_t count, std::vector<uint32_t> &order,
+                      std::vector<uint32_t> &scratch) {
+    order.resize(count);
+    scratch.resize(count);
+    uint32_t histograms[4][256] = {};
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t key = keys[i];
+        histograms[0][key & 0xFF]++;
+        histograms[1][(key >> 8) & 0xFF]++;
+        histograms[2][(key >> 16) & 0xFF]++;
+        histograms[3][key >> 24]++;
+        order[i] = i;
+    }
+
+    for (uint32_t pass = 0; pass < 4; pass++) {
+        uint32_t shift = pass * 8;
+        uint32_t *histogram = histograms[pass];
+        // كل المفاتيح في نفس الدلو: هذه الخانة لا تغير الترتيب
+        if (count == 0 || histogram[(keys[0] >> shift) & 0xFF] == count) {
+            continue;
+        }
+        uint32_t offset = 0;
+        for (uint32_t bucket = 0; bucket < 256; bucket++) {
+            uint32_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t index = order[i];
+            scratch[histogram[(keys[index] >> shift) & 0xFF]++] = index;
+        }
+        order.swap(scratch);
+    }
+}
+
+static void reserveFrameBuffer(State *state, SpriteFrameBuffer &frame, uint32_t count) {
+    if (count <= frame.capacity) {
+        return;
+    }
+    uint32_t capacity = std::max(frame.capacity, 4096u);
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    destroyBuffer(state, &frame.buffer);
+
+    VkDeviceSize size = 0;
+    for (uint32_t i = 0; i < SPRITE_STREAM_COUNT; i++) {
+        frame.streamOffsets[i] = size;
+        size = alignUp(size + (VkDeviceSize) capacity * streamStrides[i], 64);
+    }
+    frame.buffer = createBuffer(state, size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    frame.capacity = capacity;
+}
+
+template<typename T>
+static void gatherStream(const SpriteFrameBuffer &frame, SpriteStream stream, const std::vector<T> &source,
+                         const std::vector<uint32_t> &order) {
+    T *destination = reinterpret_cast<T *>(static_cast<uint8_t *>(frame.buffer.mapped) + frame.streamOffsets[stream]);
+    for (size_t i = 0; i < order.size(); i++) {
+        destination[i] = source[order[i]];
+    }
+}
+
+void spriteRender(State *state, VkCommandBuffer commandBuffer) {
+    SpriteRenderer &renderer = state->sprites;
+    SpriteInstances &instances = renderer.instances;
+    uint32_t count = instances.count;
+    renderer.stats = {.sprites = count};
+    if (count == 0) {
+        return;
+    }
+    renderer.pipeline.colorFormat = renderTargetFormat(state);
+    VkPipeline pipeline = getPipeline(state, renderer.pipeline);
+    if (pipeline == VK_NULL_HANDLE) {
+        // ما زال يُترجم؛ نتخطى الـ sprites هذا الإطار بدل إيقاف الخيط الرئيسي، دون أن تتراكم للإطار التالي
+        clearInstances(instances);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    radixSort(instances.key.data(), count, renderer.order, renderer.scratch);
+    auto sorted = std::chrono::steady_clock::now();
+
+    // تجميع التيارات بالترتيب الجديد مباشرة في الذاكرة المرئية للـ GPU
+    SpriteFrameBuffer &frame = renderer.frames[state->frameNumber % FRAMES_IN_FLIGHT];
+    reserveFrameBuffer(state, frame, count);
+    gatherStream(frame, SPRITE_STREAM_POSITION, instances.position, renderer.order);
+    gatherStream(frame, SPRITE_STREAM_SIZE, instances.size, renderer.order);
+    gatherStream(frame, SPRITE_STREAM_ROTATION, instances.rotation, renderer.order);
+    gatherStream(frame, SPRITE_STREAM_UV, instances.uv, renderer.order);
+    gatherStream(frame, SPRITE_STREAM_COLOR, instances.color, renderer.order);
+    gatherStream(frame, SPRITE_STREAM_TEXTURE, instances.texture, renderer.order);
+    flushBuffer(state, frame.buffer, 0, frame.buffer.size);
+    auto uploaded = std::chrono::steady_clock::now();
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    VkBuffer buffers[SPRITE_STREAM_COUNT];
+    for (VkBuffer &buffer : buffers) {
+        buffer = frame.buffer.buffer;
+    }
+    vkCmdBindVertexBuffers(commandBuffer, 0, SPRITE_STREAM_COUNT, buffers, frame.streamOffsets);
+
+    VkExtent2D extent = state->swapchainExtent;
+    SpritePushConstants pushConstants{
+        .viewScale = {2.0f / (float) extent.width, 2.0f / (float) extent.height},
+        .viewOrigin = {0, 0},
+    };
+    vkCmdPushConstants(commandBuffer, renderer.pipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(pushConstants),
+                       &pushConstants);
+
+    if (renderer.bindless) {
+        // النسيج يُقرأ من الكومة بالفهرس، فكل الـ sprites في رسم واحد
+        bindlessBind(state, commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+        vkCmdDraw(commandBuffer, 4, count, 0, 0);
+        renderer.stats.draws = 1;
+    } else {
+        const std::vector<uint32_t> &textures = instances.texture;
+        uint32_t first = 0;
+        while (first < count) {
+            uint32_t texture = textures[renderer.order[first]];
+            uint32_t last = first + 1;
+            while (last < count && textures[renderer.order[last]] == texture) {
+                last++;
+            }
+
+            VkDescriptorSet set = allocateFrameDescriptorSet(state, renderer.textureSetLayout);
+            VkDescriptorImageInfo imageInfo{
+                .sampler = renderer.sampler,
+                .imageView = renderer.textureViews[texture],
+                .imageLayout = renderer.textureLayouts[texture],
+            };
+            VkWriteDescriptorSet write{
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = set,
+                .dstBinding = 0,
+                .descriptorCount = 1,
+                .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                .pImageInfo = &imageInfo,
+            };
+            vkUpdateDescriptorSets(state->device, 1, &write, 0, nullptr);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderer.pipelineLayout, 0, 1,
+                                    &set, 0, nullptr);
+            vkCmdDraw(commandBuffer, 4, last - first, 0, first);
+            renderer.stats.draws++;
+            first = last;
+        }
+    }
+
+    renderer.stats.sortMs = std::chrono::duration<double, std::milli>(sorted - start).count();
+    renderer.stats.uploadMs = std::chrono::duration<double, std::milli>(uploaded - sorted).count();
+    clearInstances(instances);
+}
+
+static uint32_t nextRandom(uint32_t *seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+static float randomRange(uint32_t *seed, float low, float high) {
+    return low + (high - low) * (float) nextRandom(seed) / (float) (1u << 24);
+}
+
+static void createBenchmarkScene(State *state) {
+    constexpr uint32_t spriteCount = 100000;
+    constexpr uint32_t textureCount = 8;
+    constexpr uint32_t textureSize = 32;
+    SpriteRenderer &renderer = state->sprites;
+
+    // أنسجة مربعات شطرنج بألوان مختلفة ليظهر أثر الترتيب حسب النسيج
+    std::vector<uint32_t> pixels(textureSize * textureSize);
+    for (uint32_t t = 0; t < textureCount; t++) {
+        uint32_t tint = 0xFF000000 | (0x40 + 0x20 * t) | (0xFF - 0x18 * t) << 8 | (0x80 + 0x10 * t) << 16;
+        for (uint32_t y = 0; y < textureSize; y++) {
+            for (uint32_t x = 0; x < textureSize; x++) {
+                pixels[y * textureSize + x] = ((x / 8 + y / 8) & 1) ? tint : 0xFFFFFFFF;
+            }
+        }
+        Texture texture = createTexture(state, {.width = textureSize, .height = textureSize}, pixels.data());
+        uploadWait(state, texture.ticket);
+        renderer.benchmarkTextures.push_back(texture);
+    }
+
+    uint32_t textureIds[textureCount];
+    for (uint32_t t = 0; t < textureCount; t++) {
+        textureIds[t] = spriteRegisterTexture(state, renderer.benchmarkTextures[t]);
+    }
+
+    uint32_t seed = 1;
+    renderer.benchmarkSprites.resize(spriteCount);
+    renderer.benchmarkVelocities.resize(spriteCount);
+    for (uint32_t i = 0; i < spriteCount; i++) {
+        float size = randomRange(&seed, 4.0f, 16.0f);
+        renderer.benchmarkSprites[i] = {
+            .position = {randomRange(&seed, 0, (float) state->swapchainExtent.width),
+                         randomRange(&seed, 0, (float) state->swapchainExtent.height)},
+            .size = {size, size},
+            .rotation = randomRange(&seed, 0, 6.2831853f),
+            .color = 0xC0FFFFFF,
+            .texture = textureIds[nextRandom(&seed) % textureCount],
+            .layer = nextRandom(&seed) % 4,
+        };
+        renderer.benchmarkVelocities[i] = {randomRange(&seed, -120, 120), randomRange(&seed, -120, 120)};
+    }
+    renderer.benchmarkStart = std::chrono::steady_clock::now();
+    std::cout << "Sprite benchmark: " << spriteCount << " sprites, " << textureCount << " textures" << std::endl;
+}
+
+void spriteBenchmarkFrame(State *state) {
+    SpriteRenderer &renderer = state->sprites;
+    if (renderer.benchmarkSprites.empty()) {
+        createBenchmarkScene(state);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const float dt = 1.0f / 60.0f;
+    float width = (float) state->swapchainExtent.width;
+    float height = (float) state->swapchainExtent.height;
+    for (size_t i = 0; i < renderer.benchmarkSprites.size(); i++) {
+        Sprite &sprite = renderer.benchmarkSprites[i];
+        SpriteVec2 &velocity = renderer.benchmarkVelocities[i];
+        sprite.position.x += velocity.x * dt;
+        sprite.position.y += velocity.y * dt;
+        if (sprite.position.x < 0 || sprite.position.x > width) {
+            velocity.x = -velocity.x;
+        }
+        if (sprite.position.y < 0 || sprite.position.y > height) {
+            velocity.y = -velocity.y;
+        }
+        sprite.rotation += dt;
+        drawSprite(state, sprite);
+    }
+    renderer.benchmarkCpuMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    renderer.benchmarkCpuMs += renderer.stats.sortMs + renderer.stats.uploadMs;
+    renderer.benchmarkFrames++;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderer.benchmarkStart).count();
+    if (elapsed >= 1.0) {
+        printf("Sprites: %zu, %.1f FPS, %.2f ms CPU per frame, %u draws, sort %.2f ms, upload %.2f ms\n",
+               renderer.benchmarkSprites.size(), renderer.benchmarkFrames / elapsed,
+               renderer.benchmarkCpuMs / renderer.benchmarkFrames, renderer.stats.draws, renderer.stats.sortMs,
+               renderer.stats.uploadMs);
+        renderer.benchmarkStart = std::chrono::steady_clock::now();
+        renderer.benchmarkFrames = 0;
+        renderer.benchmarkCpuMs = 0;
+    }
+}
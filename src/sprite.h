@@ -0,0 +1,119 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "buffer.h"
+#include "frame.h"
+#include "pipeline.h"
+#include "texture.h"
+
+struct State;
+
+// مفتاح الترتيب: الطبقة في البتات العليا ثم النسيج، فتتجاور الـ sprites بنفس النسيج داخل كل طبقة
+constexpr uint32_t SPRITE_TEXTURE_BITS = 20;
+constexpr uint32_t SPRITE_MAX_LAYER = (1u << (32 - SPRITE_TEXTURE_BITS)) - 1;
+
+struct SpriteVec2 {
+    float x, y;
+};
+
+struct SpriteRect {
+    float u0, v0, u1, v1;
+};
+
+struct Sprite {
+    SpriteVec2 position;            // المركز بالبكسل
+    SpriteVec2 size;
+    float rotation = 0;             // بالراديان
+    SpriteRect uv = {0, 0, 1, 1};
+    uint32_t color = 0xFFFFFFFF;    // RGBA8، R في البايت الأدنى
+    uint32_t texture = 0;           // من spriteRegisterTexture
+    uint32_t layer = 0;
+};
+
+// ميزات متغيرات الـ sprite كثوابت تخصيص، بنفس الترقيم في shaders/sprite_features.glsl
+enum class SpriteFeature : uint32_t {
+    AlphaTest,          // discard للبكسلات شبه الشفافة
+    Grayscale,
+    Count,
+};
+
+// تيارات الـ instances؛ كل تيار vertex binding مستقل بنفس الترتيب في sprite.vert
+enum SpriteStream : uint32_t {
+    SPRITE_STREAM_POSITION,
+    SPRITE_STREAM_SIZE,
+    SPRITE_STREAM_ROTATION,
+    SPRITE_STREAM_UV,
+    SPRITE_STREAM_COLOR,
+    SPRITE_STREAM_TEXTURE,
+    SPRITE_STREAM_COUNT,
+};
+
+struct SpriteInstances {
+    std::vector<SpriteVec2> position;
+    std::vector<SpriteVec2> size;
+    std::vector<float> rotation;
+    std::vector<SpriteRect> uv;
+    std::vector<uint32_t> color;
+    std::vector<uint32_t> texture;
+    std::vector<uint32_t> key;
+    uint32_t count = 0;
+};
+
+struct SpriteFrameBuffer {
+    Buffer buffer;
+    uint32_t capacity = 0;
+    VkDeviceSize streamOffsets[SPRITE_STREAM_COUNT] = {};
+};
+
+struct SpriteStats {
+    uint32_t sprites = 0;
+    uint32_t draws = 0;
+    double sortMs = 0;
+    double uploadMs = 0;
+};
+
+struct SpriteRenderer {
+    bool bindless = false;
+    PipelineDesc pipeline;
+    ShaderVariant<SpriteFeature> variant;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout textureSetLayout = VK_NULL_HANDLE;    // المسار بدون bindless فقط
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    std::vector<VkImageView> textureViews;      // مفهرسة بمعرّف النسيج
+    uint32_t whiteTexture = 0;                  // للـ sprites الملونة بدون نسيج
+    Texture ownedWhiteTexture;                  // فقط بدون bindless؛ وإلا يُستخدم نسيج الكومة الافتراضي
+    std::vector<VkImageLayout> textureLayouts;
+
+    SpriteInstances instances;
+    std::vector<uint32_t> order, scratch;       // نتيجة radix sort
+    SpriteFrameBuffer frames[FRAMES_IN_FLIGHT];
+    SpriteStats stats;
+
+    std::vector<Sprite> benchmarkSprites;
+    std::vector<SpriteVec2> benchmarkVelocities;
+    std::vector<Texture> benchmarkTextures;
+    std::chrono::steady_clock::time_point benchmarkStart;
+    uint32_t benchmarkFrames = 0;
+    double benchmarkCpuMs = 0;
+};
+
+void createSpriteRenderer(State *state);
+void destroySpriteRenderer(State *state);
+
+uint32_t spriteRegisterTexture(State *state, const Texture &texture);
+
+// يبدّل متغير الـ shader لكل الـ sprites؛ الـ pipeline الجديد يُترجم في الخلفية إن لم يكن موجوداً
+void spriteSetVariant(State *state, ShaderVariant<SpriteFeature> variant);
+void drawSprite(State *state, const Sprite &sprite);
+
+// داخل ممر الـ Swapchain (beginPass يضبط الـ viewport والـ scissor): ترتيب، رفع، ثم رسم كل الدفعات
+void spriteRender(State *state, VkCommandBuffer commandBuffer);
+
+// --bench sprites: مشهد من 100 ألف sprite متحركة
+void spriteBenchmarkFrame(State *state);
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <csignal>
+#include <cstdio>
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <vector>
+
+#include "archive.h"
+#include "bindless.h"
+#include "deletion_queue.h"
+#include "descriptors.h"
+#include "ecs.h"
+#include "frame.h"
+#include "gpu_timer.h"
+#include "jobs.h"
+#include "lights.h"
+#include "loader.h"
+#include "pass.h"
+#include "pipeline.h"
+#include "post.h"
+#include "readback.h"
+#include "resolution.h"
+#include "scene.h"
+#include "shader.h"
+#include "simulation.h"
+#include "sprite.h"
+#include "sync.h"
+#include "uniform_ring.h"
+#include "upload.h"
+
+#define EXPECT(ERROR, FORMAT, ...) \
+if (ERROR) { \
+    fprintf(stderr, "%s -> %s -> %d -> Error(%i):\n\t" FORMAT "\n", \
+    __FILE__, __FUNCTION__, __LINE__, ERROR, ##__VA_ARGS__); \
+    raise(SIGSEGV); \
+}
+
+struct State {
+    const char *windowTitle;
+    const char *applicationName;
+    const char *engineName;
+    int windowWidth, windowHeight;
+    bool windowResizable;
+    bool windowFullscreen;
+    uint32_t frameBufferWidth, frameBufferHeight;
+    bool recreateSwapChain;
+
+    GLFWwindow *window = nullptr;                   // تم تعديل هذا السطر
+    GLFWmonitor *windowMonitor = nullptr;           // تم تعديل هذا السطر
+    VkAllocationCallbacks *allocator = nullptr;     // تم تعديل هذا السطر
+    const std::vector<const char *> validationLayers{
+        "VK_LAYER_KHRONOS_validation"
+    };
+
+    const std::vector<const char *> enabledExtensionNames{
+        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+        "VK_KHR_portability_subset"
+    };
+
+    VkInstance instance = VK_NULL_HANDLE;           // تم تعديل هذا السطر
+    uint32_t app_version;
+    const char *benchmark = nullptr;                   // --bench <name>
+    const char *archivePath = nullptr;                 // --archive <path>
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;  // تم تعديل هذا السطر
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;             // تم تعديل هذا السطر
+    uint32_t queueFamilyIndex;
+    uint32_t transferQueueFamilyIndex = UINT32_MAX;    // عائلة نقل مخصصة إن وُجدت
+    uint32_t sharedQueueFamilies[2];
+    VkDevice device = VK_NULL_HANDLE;                  // تم تعديل هذا السطر
+    std::vector<VkExtensionProperties> availableDeviceExtensions;
+
+    // VK_EXT_host_image_copy: رفع الصور من الـ CPU مباشرة دون staging
+    bool hostImageCopy = false;
+    VkImageLayout hostCopyDstLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    PFN_vkCopyMemoryToImageEXT vkCopyMemoryToImageEXT = nullptr;
+    PFN_vkTransitionImageLayoutEXT vkTransitionImageLayoutEXT = nullptr;
+
+    // الفهرسة الديناميكية للواصفات: كومة موارد واحدة تُربط مرة لكل إطار
+    bool descriptorIndexing = false;
+    bool bufferDeviceAddress = false;
+    bool textureCompressionBC = false;                 // الأصول المطبوخة بـ BC1/BC7
+    bool graphicsPipelineLibrary = false;              // VK_EXT_graphics_pipeline_library: ربط سريع من أجزاء
+    bool multiDrawIndirect = false;                    // مع drawIndirectFirstInstance: كل المشهد في رسم غير مباشر واحد
+    bool drawIndirectCount = false;                    // عدد الرسومات يكتبه الـ GPU
+    bool storageImageWriteWithoutFormat = false;       // الكتابة من compute في صورة الـ swapchain أياً كان ترتيب قنواتها
+    VkQueue queue = VK_NULL_HANDLE;                    // تم تعديل هذا السطر
+    uint32_t swapchainImageCount;
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;         // تم تعديل هذا السطر
+    std::vector<VkImage> swapchainImages;
+    VkExtent2D swapchainExtent;
+    VkFormat swapchainFormat = VK_FORMAT_UNDEFINED;
+    VkImageUsageFlags swapchainUsage = 0;
+    std::vector<VkImageView> swapchainImageViews;
+
+    // رقم الإطار الحالي يبدأ من 1، والكائنات المتقاعدة تُحرَّر بعد اكتمال إطارها
+    uint64_t frameNumber = 0;
+    DeletionQueue deletionQueue;
+
+    // عداد الاكتمال المشترك: كل ما يُرسل إلى طابور الرسم يرفع قيمته
+    TimelineQueue graphicsTimeline;
+    TimelineQueue transferTimeline;
+    FrameResources frames[FRAMES_IN_FLIGHT];
+    TimelineWait frameWaits[MAX_TIMELINE_WAITS - 1];
+    uint32_t frameWaitCount = 0;
+    std::vector<VkSemaphore> presentSemaphores;
+    uint32_t imageIndex = 0;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;     // أوامر الإطار الجاري بين beginFrame و endFrame
+
+    RenderTargets renderTargets;
+    DynamicResolution resolution;
+    Post post;
+    GpuTimers gpuTimers;
+    UploadManager upload;
+    Readback readback;
+    DescriptorAllocator descriptors;
+    Bindless bindless;
+    UniformRing uniformRing;
+    SpriteRenderer sprites;
+    Lights lights;
+    Scene scene;
+
+    JobSystem jobs;
+    World world;
+    Simulation simulation;
+    Archive archive;
+    AssetLoader loader;
+    ShaderCache shaders;
+    PipelineManager pipelines;
+};
@@ -0,0 +1,128 @@
+#include "sync.h"
+#include "state.h"
+
+#include <iostream>
+
+void createTimelineQueue(State *state, TimelineQueue *timeline, const char *name, uint32_t familyIndex,
+                         uint32_t queueIndex) {
+    timeline->name = name;
+    timeline->familyIndex = familyIndex;
+    vkGetDeviceQueue(state->device, familyIndex, queueIndex, &timeline->queue);
+
+    VkSemaphoreTypeCreateInfo typeInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+    VkSemaphoreCreateInfo createInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &typeInfo,
+    };
+    VkResult result = vkCreateSemaphore(state->device, &createInfo, state->allocator, &timeline->semaphore);
+    EXPECT(result != VK_SUCCESS, "Failed to create %s timeline semaphore", name);
+    timeline->submittedValue = 0;
+    timeline->completedValue = 0;
+    std::cout << "Timeline created for " << name << " queue (family " << familyIndex << ")" << std::endl;
+}
+
+void destroyTimelineQueue(State *state, TimelineQueue *timeline) {
+    deferDestroy(state, timeline->semaphore);
+    timeline->semaphore = VK_NULL_HANDLE;
+    timeline->queue = VK_NULL_HANDLE;
+}
+
+uint64_t timelineSubmit(TimelineQueue *timeline, const TimelineSubmit &submit) {
+    EXPECT(submit.waitCount + 1 > MAX_TIMELINE_WAITS, "Too many timeline waits: %u", submit.waitCount);
+
+    VkSemaphoreSubmitInfo waitInfos[MAX_TIMELINE_WAITS];
+    uint32_t waitInfoCount = 0;
+    for (uint32_t i = 0; i < submit.waitCount; i++) {
+        const TimelineWait &wait = submit.waits[i];
+        if (wait.value == 0) {
+            continue;
+        }
+        waitInfos[waitInfoCount++] = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .semaphore = wait.timeline->semaphore,
+            .value = wait.value,
+            .stageMask = wait.stageMask,
+        };
+    }
+    if (submit.binaryWait != VK_NULL_HANDLE) {
+        waitInfos[waitInfoCount++] = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .semaphore = submit.binaryWait,
+            .stageMask = submit.binaryWaitStageMask,
+        };
+    }
+
+    uint64_t signalValue = timeline->submittedValue + 1;
+    VkSemaphoreSubmitInfo signalInfos[2] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .semaphore = timeline->semaphore,
+            .value = signalValue,
+            .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .semaphore = submit.binarySignal,
+            .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        },
+    };
+
+    VkCommandBufferSubmitInfo commandBufferInfos[MAX_SUBMIT_COMMAND_BUFFERS];
+    EXPECT(submit.commandBufferCount > MAX_SUBMIT_COMMAND_BUFFERS, "Too many command buffers: %u",
+           submit.commandBufferCount);
+    for (uint32_t i = 0; i < submit.commandBufferCount; i++) {
+        commandBufferInfos[i] = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .commandBuffer = submit.commandBuffers[i],
+        };
+    }
+
+    VkSubmitInfo2 submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .waitSemaphoreInfoCount = waitInfoCount,
+        .pWaitSemaphoreInfos = waitInfos,
+        .commandBufferInfoCount = submit.commandBufferCount,
+        .pCommandBufferInfos = commandBufferInfos,
+        .signalSemaphoreInfoCount = submit.binarySignal != VK_NULL_HANDLE ? 2u : 1u,
+        .pSignalSemaphoreInfos = signalInfos,
+    };
+    VkResult result = vkQueueSubmit2(timeline->queue, 1, &submitInfo, VK_NULL_HANDLE);
+    EXPECT(result != VK_SUCCESS, "Failed to submit to %s queue", timeline->name);
+    timeline->submittedValue = signalValue;
+    return signalValue;
+}
+
+uint64_t timelinePoll(State *state, TimelineQueue *timeline) {
+    uint64_t value;
+    VkResult result = vkGetSemaphoreCounterValue(state->device, timeline->semaphore, &value);
+    EXPECT(result != VK_SUCCESS, "Failed to read %s timeline value", timeline->name);
+    timeline->completedValue = value;
+    return value;
+}
+
+bool timelineReached(State *state, TimelineQueue *timeline, uint64_t value) {
+    if (value <= timeline->completedValue) {
+        return true;
+    }
+    return timelinePoll(state, timeline) >= value;
+}
+
+void timelineWait(State *state, TimelineQueue *timeline, uint64_t value) {
+    if (timelineReached(state, timeline, value)) {
+        return;
+    }
+    VkSemaphoreWaitInfo waitInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &timeline->semaphore,
+        .pValues = &value,
+    };
+    VkResult result = vkWaitSemaphores(state->device, &waitInfo, UINT64_MAX);
+    EXPECT(result != VK_SUCCESS, "Failed to wait for %s timeline value %llu", timeline->name,
+           (unsigned long long) value);
+    timeline->completedValue = value;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+
+struct State;
+
+// طابور واحد مع semaphore من نوع timeline وقيمة واحدة تزداد بشكل رتيب لكل إرسال
+struct TimelineQueue {
+    const char *name = "";
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t familyIndex = 0;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    uint64_t submittedValue = 0;    // آخر قيمة طُلب من الـ GPU الإشارة إليها
+    uint64_t completedValue = 0;    // آخر قيمة عُرف أنها اكتملت، تُحدَّث عند الحاجة فقط
+};
+
+// اعتماد على قيمة في timeline طابور آخر (أو نفس الطابور)
+struct TimelineWait {
+    const TimelineQueue *timeline;
+    uint64_t value;
+    VkPipelineStageFlags2 stageMask;
+};
+
+constexpr uint32_t MAX_TIMELINE_WAITS = 8;
+constexpr uint32_t MAX_SUBMIT_COMMAND_BUFFERS = 8;
+
+struct TimelineSubmit {
+    const VkCommandBuffer *commandBuffers = nullptr;
+    uint32_t commandBufferCount = 0;
+    const TimelineWait *waits = nullptr;
+    uint32_t waitCount = 0;
+    // الـ swapchain لا تدعم timeline، لذا نسمح بـ semaphore ثنائي واحد للانتظار وآخر للإشارة
+    VkSemaphore binaryWait = VK_NULL_HANDLE;
+    VkPipelineStageFlags2 binaryWaitStageMask = VK_PIPELINE_STAGE_2_NONE;
+    VkSemaphore binarySignal = VK_NULL_HANDLE;
+};
+
+void createTimelineQueue(State *state, TimelineQueue *timeline, const char *name, uint32_t familyIndex,
+                         uint32_t queueIndex);
+void destroyTimelineQueue(State *state, TimelineQueue *timeline);
+
+// يرسل العمل ويعيد القيمة التي ستصلها الـ timeline عند اكتماله
+uint64_t timelineSubmit(TimelineQueue *timeline, const TimelineSubmit &submit);
+
+// فحص رخيص: لا يستدعي Vulkan إذا كانت القيمة المخزنة كافية
+bool timelineReached(State *state, TimelineQueue *timeline, uint64_t value);
+uint64_t timelinePoll(State *state, TimelineQueue *timeline);
+void timelineWait(State *state, TimelineQueue *timeline, uint64_t value);
@@ -0,0 +1,208 @@
+#include "texture.h"
+#include "cooked.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+static ImageUploadDesc uploadDesc(const TextureDesc &desc, VkImage image) {
+    return {
+        .image = image,
+        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .width = desc.width,
+        .height = desc.height,
+        .mipLevels = desc.mipLevels,
+        .bytesPerBlock = desc.bytesPerBlock,
+        .blockWidth = desc.blockWidth,
+        .blockHeight = desc.blockHeight,
+        .finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    };
+}
+
+static bool hostCopySupported(State *state, VkFormat format) {
+    if (!state->hostImageCopy) {
+        return false;
+    }
+    VkFormatProperties3 properties3{
+        .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3,
+    };
+    VkFormatProperties2 properties{
+        .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2,
+        .pNext = &properties3,
+    };
+    vkGetPhysicalDeviceFormatProperties2(state->physicalDevice, format, &properties);
+    return (properties3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT) != 0;
+}
+
+static Texture createTextureWithPath(State *state, const TextureDesc &desc, const void *data, TexturePath path) {
+    Texture texture{.path = path};
+    VkImageCreateInfo imageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = desc.format,
+        .extent = {desc.width, desc.height, 1},
+        .mipLevels = desc.mipLevels,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT | (path == TexturePath::HostCopy
+                                                   ? (VkImageUsageFlags) VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT
+                                                   : (VkImageUsageFlags) VK_IMAGE_USAGE_TRANSFER_DST_BIT),
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    texture.image = createImage(state, imageInfo, VK_IMAGE_ASPECT_COLOR_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    ImageUploadDesc upload = uploadDesc(desc, texture.image.image);
+
+    if (path == TexturePath::Staging) {
+        texture.ticket = uploadImage(state, upload, data);
+        return texture;
+    }
+
+    // المسار المباشر: انتقال التخطيط والنسخ يحدثان على الـ CPU دون أي إرسال للـ GPU
+    texture.layout = state->hostCopyDstLayout;
+    VkHostImageLayoutTransitionInfoEXT transition{
+        .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+        .image = texture.image.image,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = state->hostCopyDstLayout,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = desc.mipLevels,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+    EXPECT(state->vkTransitionImageLayoutEXT(state->device, 1, &transition) != VK_SUCCESS,
+           "Failed to transition image layout on host");
+
+    std::vector<VkMemoryToImageCopyEXT> regions(desc.mipLevels);
+    const uint8_t *src = static_cast<const uint8_t *>(data);
+    for (uint32_t mip = 0; mip < desc.mipLevels; mip++) {
+        uint32_t width = std::max(1u, desc.width >> mip);
+        uint32_t height = std::max(1u, desc.height >> mip);
+        regions[mip] = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+            .pHostPointer = src,
+            .memoryRowLength = 0,
+            .memoryImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = mip,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {width, height, 1},
+        };
+        uint32_t blocksX = (width + desc.blockWidth - 1) / desc.blockWidth;
+        uint32_t blocksY = (height + desc.blockHeight - 1) / desc.blockHeight;
+        src += (size_t) blocksX * blocksY * desc.bytesPerBlock;
+    }
+    VkCopyMemoryToImageInfoEXT copyInfo{
+        .sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+        .dstImage = texture.image.image,
+        .dstImageLayout = state->hostCopyDstLayout,
+        .regionCount = desc.mipLevels,
+        .pRegions = regions.data(),
+    };
+    EXPECT(state->vkCopyMemoryToImageEXT(state->device, &copyInfo) != VK_SUCCESS, "Failed to copy memory to image");
+    return texture;
+}
+
+Texture createTexture(State *state, const TextureDesc &desc, const void *data) {
+    TexturePath path = hostCopySupported(state, desc.format) ? TexturePath::HostCopy : TexturePath::Staging;
+    return createTextureWithPath(state, desc, data, path);
+}
+
+bool textureReady(State *state, const Texture &texture) {
+    return texture.ticket == 0 || uploadComplete(state, texture.ticket);
+}
+
+const uint8_t *cookedTextureDesc(const void *data, size_t size, TextureDesc *desc) {
+    if (size < sizeof(CookedTextureHeader)) {
+        return nullptr;
+    }
+    const CookedTextureHeader *header = static_cast<const CookedTextureHeader *>(data);
+    if (memcmp(header->magic, COOKED_TEXTURE_MAGIC, 4) != 0 || header->version != COOKED_VERSION ||
+        header->blockSize == 0 || sizeof(CookedTextureHeader) + header->dataSize > size) {
+        return nullptr;
+    }
+    static const VkFormat formats[] = {
+        VK_FORMAT_R8G8B8A8_SRGB,
+        VK_FORMAT_R8G8B8A8_UNORM,
+        VK_FORMAT_BC1_RGB_SRGB_BLOCK,
+        VK_FORMAT_BC1_RGB_UNORM_BLOCK,
+        VK_FORMAT_BC7_SRGB_BLOCK,
+        VK_FORMAT_BC7_UNORM_BLOCK,
+    };
+    if ((uint32_t) header->format >= sizeof(formats) / sizeof(formats[0])) {
+        return nullptr;
+    }
+    *desc = {
+        .width = header->width,
+        .height = header->height,
+        .mipLevels = header->mipLevels,
+        .format = formats[(uint32_t) header->format],
+        .bytesPerBlock = header->bytesPerBlock,
+        .blockWidth = header->blockSize,
+        .blockHeight = header->blockSize,
+    };
+    ImageUploadDesc upload = uploadDesc(*desc, VK_NULL_HANDLE);
+    if (imageUploadSize(upload) != header->dataSize) {
+        return nullptr;
+    }
+    return static_cast<const uint8_t *>(data) + sizeof(CookedTextureHeader);
+}
+
+void destroyTexture(State *state, Texture *texture) {
+    destroyImage(state, &texture->image);
+    *texture = {};
+}
+
+void runTextureBenchmark(State *state) {
+    constexpr uint32_t textureCount = 32;
+    constexpr uint32_t size = 1024;
+    TextureDesc desc{
+        .width = size,
+        .height = size,
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+    };
+    std::vector<uint8_t> pixels((size_t) size * size * 4);
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = (uint8_t) (i * 31);
+    }
+
+    TexturePath paths[2] = {TexturePath::Staging, TexturePath::HostCopy};
+    for (TexturePath path : paths) {
+        if (path == TexturePath::HostCopy && !hostCopySupported(state, desc.format)) {
+            printf("Texture benchmark: host image copy not supported, skipped\n");
+            continue;
+        }
+        std::vector<Texture> textures;
+        double worstMs = 0.0;
+        VkDeviceSize memory = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < textureCount; i++) {
+            auto uploadStart = std::chrono::steady_clock::now();
+            Texture texture = createTextureWithPath(state, desc, pixels.data(), path);
+            if (texture.ticket != 0) {
+                uploadWait(state, texture.ticket);
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+            worstMs = std::max(worstMs, ms);
+            memory += texture.image.memorySize;
+            textures.push_back(texture);
+        }
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        VkDeviceSize staging = path == TexturePath::Staging ? state->upload.staging.size : 0;
+        printf("Texture benchmark [%s]: %u x %ux%u, avg %.2f ms, worst %.2f ms, image memory %.1f MB, staging %.1f MB\n",
+               path == TexturePath::Staging ? "staging" : "host copy", textureCount, size, size,
+               totalMs / textureCount, worstMs, memory / (1024.0 * 1024.0), staging / (1024.0 * 1024.0));
+        for (Texture &texture : textures) {
+            destroyTexture(state, &texture);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstddef>
+#include <cstdint>
+
+#include "image.h"
+#include "upload.h"
+
+struct State;
+
+struct TextureDesc {
+    uint32_t width = 0, height = 0;
+    uint32_t mipLevels = 1;
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    uint32_t bytesPerBlock = 4;
+    uint32_t blockWidth = 1, blockHeight = 1;
+};
+
+enum class TexturePath {
+    Staging,        // حلقة الرفع ثم نسخ على طابور النقل
+    HostCopy,       // VK_EXT_host_image_copy: الـ CPU يكتب مباشرة في الصورة
+};
+
+struct Texture {
+    Image image;
+    TexturePath path = TexturePath::Staging;
+    UploadTicket ticket = 0;        // 0 للمسار المباشر لأنه يكتمل فوراً
+    VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;    // التخطيط الذي يُقرأ منه في الـ shaders
+};
+
+// البيانات مرصوصة: كل مستويات الـ mip بالتتابع بدون حشو بين الصفوف
+Texture createTexture(State *state, const TextureDesc &desc, const void *data);
+bool textureReady(State *state, const Texture &texture);
+// يقرأ رأس CookedTextureHeader ويعيد مؤشراً إلى مستويات الـ mip، أو nullptr إن لم تكن البيانات صالحة
+const uint8_t *cookedTextureDesc(const void *data, size_t size, TextureDesc *desc);
+void destroyTexture(State *state, Texture *texture);
+
+void runTextureBenchmark(State *state);
@@ -0,0 +1,157 @@
+#include "uniform_ring.h"
+#include "descriptors.h"
+#include "state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+static UniformRingChunk createChunk(State *state, VkDeviceSize size) {
+    UniformRing &ring = state->uniformRing;
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    if (state->bufferDeviceAddress) {
+        usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    }
+    // ذاكرة الجهاز المرئية للمضيف (ReBAR/UMA) تتجنب قراءة الـ GPU عبر PCIe لكل رسم
+    UniformRingChunk chunk{};
+    chunk.buffer = createBuffer(state, size + UNIFORM_RING_DYNAMIC_RANGE, usage,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (state->bufferDeviceAddress) {
+        VkBufferDeviceAddressInfo addressInfo{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .buffer = chunk.buffer.buffer,
+        };
+        chunk.address = vkGetBufferDeviceAddress(state->device, &addressInfo);
+    }
+    ring.chunkSize = size;
+    ring.head = 0;
+    return chunk;
+}
+
+// مجموعة الواصفات تأتي من مخصص الإطار، لذا تُعاد لكل قطعة في كل إطار
+static void allocateChunkDescriptor(State *state, UniformRingChunk &chunk) {
+    chunk.descriptorSet = allocateFrameDescriptorSet(state, state->uniformRing.dynamicLayout);
+    VkDescriptorBufferInfo bufferInfo{
+        .buffer = chunk.buffer.buffer,
+        .offset = 0,
+        .range = UNIFORM_RING_DYNAMIC_RANGE,
+    };
+    VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = chunk.descriptorSet,
+        .dstBinding = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+        .pBufferInfo = &bufferInfo,
+    };
+    vkUpdateDescriptorSets(state->device, 1, &write, 0, nullptr);
+}
+
+void createUniformRing(State *state) {
+    UniformRing &ring = state->uniformRing;
+    const VkPhysicalDeviceLimits &limits = state->physicalDeviceProperties.limits;
+    ring.alignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+
+    VkDescriptorSetLayoutBinding binding{
+        .binding = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_ALL,
+    };
+    ring.dynamicLayout = getDescriptorSetLayout(state, &binding, 1);
+
+    for (UniformRingFrame &frame : ring.frames) {
+        frame.chunks.push_back(createChunk(state, ring.capacity));
+    }
+    ring.frame = &ring.frames[0];
+    ring.chunkSize = ring.capacity;
+    ring.head = 0;
+}
+
+void destroyUniformRing(State *state) {
+    UniformRing &ring = state->uniformRing;
+    for (UniformRingFrame &frame : ring.frames) {
+        for (UniformRingChunk &chunk : frame.chunks) {
+            destroyBuffer(state, &chunk.buffer);
+        }
+    }
+    ring = {};
+}
+
+void resetUniformRing(State *state, uint32_t frameSlot) {
+    UniformRing &ring = state->uniformRing;
+    UniformRingFrame &frame = ring.frames[frameSlot];
+
+    // فاضت هذه الفتحة آخر مرة: حلقة واحدة بحجم يكفي كل ما استُخدم بدل سلسلة قطع
+    if (frame.chunks.size() > 1 || frame.chunks.front().buffer.size < ring.capacity + UNIFORM_RING_DYNAMIC_RANGE) {
+        if (frame.chunks.size() > 1) {
+            while (ring.capacity < frame.used) {
+                ring.capacity *= 2;
+            }
+            ring.overflowFrames++;
+            std::cout << "Uniform ring: overflowed " << frame.used << " bytes, growing to " << ring.capacity
+                      << std::endl;
+        }
+        for (UniformRingChunk &chunk : frame.chunks) {
+            destroyBuffer(state, &chunk.buffer);
+        }
+        frame.chunks.clear();
+        frame.chunks.push_back(createChunk(state, ring.capacity));
+    }
+
+    ring.frame = &frame;
+    ring.chunkSize = frame.chunks.front().buffer.size - UNIFORM_RING_DYNAMIC_RANGE;
+    ring.head = 0;
+    frame.used = 0;
+    allocateChunkDescriptor(state, frame.chunks.front());
+}
+
+UniformAllocation uniformRingAllocateSlow(State *state, VkDeviceSize size) {
+    UniformRing &ring = state->uniformRing;
+    EXPECT(size > ring.capacity, "Uniform allocation of %llu bytes exceeds ring capacity",
+           (unsigned long long) size);
+
+    // الفيضان لا يوقف الإطار: قطعة إضافية لهذا الإطار فقط، وتكبر الحلقة عند عودة الفتحة
+    UniformRingFrame &frame = *ring.frame;
+    frame.used += ring.head;
+    frame.chunks.push_back(createChunk(state, ring.capacity));
+    allocateChunkDescriptor(state, frame.chunks.back());
+    return uniformRingAllocate(state, ring, size);
+}
+
+void uniformRingFlush(State *state) {
+    UniformRing &ring = state->uniformRing;
+    UniformRingFrame &frame = *ring.frame;
+    for (size_t i = 0; i < frame.chunks.size(); i++) {
+        VkDeviceSize used = i + 1 == frame.chunks.size() ? ring.head : ring.chunkSize;
+        flushBuffer(state, frame.chunks[i].buffer, 0, used);
+    }
+    frame.used += ring.head;
+}
+
+void uniformRingBenchmarkFrame(State *state) {
+    constexpr uint32_t drawCount = 100000;
+    struct DrawConstants {
+        float transform[12];
+        uint32_t texture, sampler, padding[2];
+    } constants{};
+
+    UniformRing &ring = state->uniformRing;
+    auto start = std::chrono::steady_clock::now();
+    uint32_t checksum = 0;
+    for (uint32_t i = 0; i < drawCount; i++) {
+        constants.texture = i;
+        checksum += uniformRingPush(state, ring, constants).offset;
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    ring.benchmarkTime += elapsed;
+    ring.benchmarkDraws += drawCount;
+    if (state->frameNumber % 120 == 0) {
+        printf("Uniform ring: %.2f ns per draw, %u overflow frames (checksum %u)\n",
+               ring.benchmarkTime / (double) ring.benchmarkDraws, ring.overflowFrames, checksum);
+        ring.benchmarkTime = 0;
+        ring.benchmarkDraws = 0;
+    }
+}
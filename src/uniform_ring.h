@@ -0,0 +1,87 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "buffer.h"
+#include "frame.h"
+
+struct State;
+
+constexpr VkDeviceSize UNIFORM_RING_INITIAL_SIZE = 4ull << 20;
+// المدى الثابت لواصف UNIFORM_BUFFER_DYNAMIC؛ الإزاحة تتغير لكل رسم
+constexpr VkDeviceSize UNIFORM_RING_DYNAMIC_RANGE = 16ull << 10;
+
+struct UniformAllocation {
+    void *data = nullptr;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    uint32_t offset = 0;                // للاستخدام كإزاحة ديناميكية
+    VkDeviceAddress address = 0;        // 0 إذا لم تكن bufferDeviceAddress مفعلة
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;     // ربط 0 من نوع UNIFORM_BUFFER_DYNAMIC
+};
+
+struct UniformRingChunk {
+    Buffer buffer;
+    VkDeviceAddress address = 0;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;     // يُخصَّص عند أول استخدام في الإطار
+};
+
+// حلقة لكل فتحة إطار: القطعة الأولى دائمة، والقطع الإضافية تُنشأ فقط عند الفيضان
+struct UniformRingFrame {
+    std::vector<UniformRingChunk> chunks;
+    VkDeviceSize used = 0;              // مجموع ما استُخدم في كل القطع هذا الإطار
+};
+
+struct UniformRing {
+    UniformRingFrame frames[FRAMES_IN_FLIGHT];
+    UniformRingFrame *frame = nullptr;
+    VkDeviceSize capacity = UNIFORM_RING_INITIAL_SIZE;
+    VkDeviceSize alignment = 256;
+    VkDeviceSize head = 0;              // داخل القطعة الأخيرة
+    VkDeviceSize chunkSize = 0;
+    VkDescriptorSetLayout dynamicLayout = VK_NULL_HANDLE;
+    uint32_t overflowFrames = 0;
+
+    double benchmarkTime = 0;
+    uint64_t benchmarkDraws = 0;
+};
+
+void createUniformRing(State *state);
+void destroyUniformRing(State *state);
+
+// يُستدعى من beginFrame؛ يكبّر الحلقة إذا فاضت في آخر استخدام لهذه الفتحة
+void resetUniformRing(State *state, uint32_t frameSlot);
+// قبل إرسال الإطار، للذاكرة غير المتماسكة فقط
+void uniformRingFlush(State *state);
+
+// --bench uniforms: تكلفة الـ CPU لكل رسم
+void uniformRingBenchmarkFrame(State *state);
+
+UniformAllocation uniformRingAllocateSlow(State *state, VkDeviceSize size);
+
+// المسار السريع: زيادة مؤشر ثم memcpy
+inline UniformAllocation uniformRingAllocate(State *state, UniformRing &ring, VkDeviceSize size) {
+    VkDeviceSize offset = ring.head;
+    if (offset + size > ring.chunkSize) {
+        return uniformRingAllocateSlow(state, size);
+    }
+    ring.head = alignUp(offset + size, ring.alignment);
+    UniformRingChunk &chunk = ring.frame->chunks.back();
+    return {
+        .data = (uint8_t *) chunk.buffer.mapped + offset,
+        .buffer = chunk.buffer.buffer,
+        .offset = (uint32_t) offset,
+        .address = chunk.address ? chunk.address + offset : 0,
+        .descriptorSet = chunk.descriptorSet,
+    };
+}
+
+template<typename T>
+inline UniformAllocation uniformRingPush(State *state, UniformRing &ring, const T &value) {
+    UniformAllocation allocation = uniformRingAllocate(state, ring, sizeof(T));
+    memcpy(allocation.data, &value, sizeof(T));
+    return allocation;
+}
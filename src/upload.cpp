@@ -0,0 +1,368 @@
+#include "upload.h"
+#include "state.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+struct MipLayout {
+    uint32_t width, height;
+    uint32_t blocksX, blocksY;
+    VkDeviceSize rowPitch;
+};
+
+static MipLayout mipLayout(const ImageUploadDesc &desc, uint32_t mip) {
+    MipLayout layout{};
+    layout.width = std::max(1u, desc.width >> mip);
+    layout.height = std::max(1u, desc.height >> mip);
+    layout.blocksX = (layout.width + desc.blockWidth - 1) / desc.blockWidth;
+    layout.blocksY = (layout.height + desc.blockHeight - 1) / desc.blockHeight;
+    layout.rowPitch = (VkDeviceSize) layout.blocksX * desc.bytesPerBlock;
+    return layout;
+}
+
+VkDeviceSize imageUploadSize(const ImageUploadDesc &desc) {
+    VkDeviceSize size = 0;
+    for (uint32_t mip = 0; mip < desc.mipLevels; mip++) {
+        MipLayout layout = mipLayout(desc, mip);
+        size += layout.rowPitch * layout.blocksY;
+    }
+    return size;
+}
+
+void createUploadManager(State *state) {
+    UploadManager &upload = state->upload;
+    upload.timeline = state->transferTimeline.queue != VK_NULL_HANDLE ? &state->transferTimeline
+                                                                      : &state->graphicsTimeline;
+    upload.frameSize = UPLOAD_RING_FRAME_SIZE;
+    upload.staging = createBuffer(state, upload.frameSize * FRAMES_IN_FLIGHT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    for (UploadSlot &slot : upload.slots) {
+        VkCommandPoolCreateInfo poolInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = upload.timeline->familyIndex,
+        };
+        VkResult result = vkCreateCommandPool(state->device, &poolInfo, state->allocator, &slot.commandPool);
+        EXPECT(result != VK_SUCCESS, "Failed to create upload command pool");
+
+        VkCommandBufferAllocateInfo allocateInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = slot.commandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        result = vkAllocateCommandBuffers(state->device, &allocateInfo, &slot.commandBuffer);
+        EXPECT(result != VK_SUCCESS, "Failed to allocate upload command buffer");
+    }
+    upload.statsStart = std::chrono::steady_clock::now();
+    std::cout << "Upload ring: " << (upload.frameSize >> 20) << " MB per frame on " << upload.timeline->name
+              << " queue" << std::endl;
+}
+
+void destroyUploadManager(State *state) {
+    UploadManager &upload = state->upload;
+    for (UploadSlot &slot : upload.slots) {
+        deferDestroy(state, slot.commandPool);
+        slot = {};
+    }
+    destroyBuffer(state, &upload.staging);
+    destroyBuffer(state, &upload.benchmarkTarget);
+    upload.pending.clear();
+    upload.inFlight.clear();
+}
+
+static VkCommandBuffer slotCommandBuffer(UploadSlot &slot) {
+    if (!slot.recording) {
+        VkCommandBufferBeginInfo beginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        EXPECT(vkBeginCommandBuffer(slot.commandBuffer, &beginInfo) != VK_SUCCESS,
+               "Failed to begin upload command buffer");
+        slot.recording = true;
+    }
+    return slot.commandBuffer;
+}
+
+static void imageBarrier(VkCommandBuffer commandBuffer, const ImageUploadDesc &desc, VkImageLayout oldLayout,
+                         VkImageLayout newLayout, bool onGraphicsQueue) {
+    bool toTransfer = newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    VkImageMemoryBarrier2 barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = toTransfer ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_COPY_BIT,
+        .srcAccessMask = toTransfer ? VK_ACCESS_2_NONE : VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = toTransfer ? VK_PIPELINE_STAGE_2_COPY_BIT
+                                   : (onGraphicsQueue ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+                                                      : VK_PIPELINE_STAGE_2_NONE),
+        .dstAccessMask = toTransfer ? VK_ACCESS_2_TRANSFER_WRITE_BIT
+                                    : (onGraphicsQueue ? VK_ACCESS_2_MEMORY_READ_BIT : VK_ACCESS_2_NONE),
+        .oldLayout = oldLayout,
+        .newLayout = newLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = desc.image,
+        .subresourceRange = {
+            .aspectMask = desc.aspectMask,
+            .baseMipLevel = 0,
+            .levelCount = desc.mipLevels,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+    };
+    VkDependencyInfo dependencyInfo{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &barrier,
+    };
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+// ينسخ أكبر جزء ممكن من الطلب إلى فتحة الإطار الحالية؛ يعيد true عند اكتمال الطلب
+static bool recordRequest(State *state, UploadRequest &request, const uint8_t *src) {
+    UploadManager &upload = state->upload;
+    UploadSlot &slot = upload.slots[upload.slotIndex];
+    uint8_t *ring = static_cast<uint8_t *>(upload.staging.mapped);
+    VkDeviceSize slotBase = upload.slotIndex * upload.frameSize;
+    bool onGraphicsQueue = upload.timeline == &state->graphicsTimeline;
+
+    while (request.consumed < request.size) {
+        VkDeviceSize offset = alignUp(slot.head, UPLOAD_COPY_ALIGNMENT);
+        VkDeviceSize space = offset < upload.frameSize ? upload.frameSize - offset : 0;
+        VkDeviceSize chunk;
+
+        if (!request.isImage) {
+            chunk = std::min(request.size - request.consumed, space);
+            if (chunk == 0) {
+                return false;
+            }
+            memcpy(ring + slotBase + offset, src, chunk);
+            VkBufferCopy region{
+                .srcOffset = slotBase + offset,
+                .dstOffset = request.dstOffset + request.consumed,
+                .size = chunk,
+            };
+            vkCmdCopyBuffer(slotCommandBuffer(slot), upload.staging.buffer, request.dstBuffer, 1, &region);
+        } else {
+            const ImageUploadDesc &desc = request.image;
+            uint32_t mip = 0;
+            VkDeviceSize mipOffset = 0;
+            MipLayout layout = mipLayout(desc, mip);
+            while (request.consumed >= mipOffset + layout.rowPitch * layout.blocksY) {
+                mipOffset += layout.rowPitch * layout.blocksY;
+                layout = mipLayout(desc, ++mip);
+            }
+            uint32_t row = (uint32_t) ((request.consumed - mipOffset) / layout.rowPitch);
+            uint32_t rows = (uint32_t) std::min<VkDeviceSize>(space / layout.rowPitch, layout.blocksY - row);
+            if (rows == 0) {
+                EXPECT(slot.head == 0, "Image row of %llu bytes exceeds the upload ring",
+                       (unsigned long long) layout.rowPitch);
+                return false;
+            }
+            chunk = rows * layout.rowPitch;
+            memcpy(ring + slotBase + offset, src, chunk);
+
+            VkCommandBuffer commandBuffer = slotCommandBuffer(slot);
+            if (request.consumed == 0) {
+                imageBarrier(commandBuffer, desc, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             onGraphicsQueue);
+            }
+            uint32_t y = row * desc.blockHeight;
+            VkBufferImageCopy region{
+                .bufferOffset = slotBase + offset,
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource = {
+                    .aspectMask = desc.aspectMask,
+                    .mipLevel = mip,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+                .imageOffset = {0, (int32_t) y, 0},
+                .imageExtent = {layout.width, std::min(rows * desc.blockHeight, layout.height - y), 1},
+            };
+            vkCmdCopyBufferToImage(commandBuffer, upload.staging.buffer, desc.image,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        }
+
+        slot.head = offset + chunk;
+        slot.bytes += chunk;
+        request.consumed += chunk;
+        src += chunk;
+    }
+
+    if (request.isImage) {
+        imageBarrier(slotCommandBuffer(slot), request.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     request.image.finalLayout, onGraphicsQueue);
+    }
+    upload.recordedTicket = request.ticket;
+    return true;
+}
+
+static UploadTicket enqueue(State *state, UploadRequest &&request, const uint8_t *data) {
+    UploadManager &upload = state->upload;
+    EXPECT(request.size == 0, "Empty upload");
+    request.ticket = upload.nextTicket++;
+
+    // المسار السريع: النسخ مباشرة إلى الحلقة دون أي نسخة وسيطة
+    if (upload.pending.empty() && recordRequest(state, request, data)) {
+        return request.ticket;
+    }
+    request.ownedOffset = request.consumed;
+    request.owned.assign(data + request.consumed, data + request.size);
+    upload.pending.push_back(std::move(request));
+    return upload.pending.back().ticket;
+}
+
+UploadTicket uploadBuffer(State *state, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data,
+                          VkDeviceSize size) {
+    UploadRequest request;
+    request.dstBuffer = dstBuffer;
+    request.dstOffset = dstOffset;
+    request.size = size;
+    return enqueue(state, std::move(request), static_cast<const uint8_t *>(data));
+}
+
+UploadTicket uploadImage(State *state, const ImageUploadDesc &desc, const void *data) {
+    UploadRequest request;
+    request.isImage = true;
+    request.image = desc;
+    request.size = imageUploadSize(desc);
+    return enqueue(state, std::move(request), static_cast<const uint8_t *>(data));
+}
+
+static void retireUploads(State *state) {
+    UploadManager &upload = state->upload;
+    while (!upload.inFlight.empty() &&
+           timelineReached(state, upload.timeline, upload.inFlight.front().timelineValue)) {
+        upload.completedTicket = std::max(upload.completedTicket, upload.inFlight.front().lastTicket);
+        upload.statsBytes += upload.inFlight.front().bytes;
+        upload.inFlight.pop_front();
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - upload.statsStart).count();
+    if (seconds >= 1.0) {
+        upload.throughputMBps = (double) upload.statsBytes / (1024.0 * 1024.0) / seconds;
+        if (upload.statsBytes > 0 && state->benchmark && strcmp(state->benchmark, "upload") == 0) {
+            printf("Upload: %.1f MB/s in %u submissions, %zu pending\n", upload.throughputMBps,
+                   upload.statsSubmissions, upload.pending.size());
+        }
+        upload.statsStart = now;
+        upload.statsBytes = 0;
+        upload.statsSubmissions = 0;
+    }
+}
+
+void uploadFlush(State *state) {
+    UploadManager &upload = state->upload;
+    UploadSlot &slot = upload.slots[upload.slotIndex];
+
+    if (slot.recording) {
+        VkDeviceSize slotBase = upload.slotIndex * upload.frameSize;
+        flushBuffer(state, upload.staging, slotBase, slot.head);
+
+        if (upload.timeline == &state->graphicsTimeline) {
+            // على نفس الطابور: حاجز واحد يجعل كل النسخ مرئية للإرسالات اللاحقة
+            VkMemoryBarrier2 barrier{
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+                .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
+            };
+            VkDependencyInfo dependencyInfo{
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .memoryBarrierCount = 1,
+                .pMemoryBarriers = &barrier,
+            };
+            vkCmdPipelineBarrier2(slot.commandBuffer, &dependencyInfo);
+        }
+        EXPECT(vkEndCommandBuffer(slot.commandBuffer) != VK_SUCCESS, "Failed to end upload command buffer");
+        slot.recording = false;
+
+        TimelineSubmit submit{
+            .commandBuffers = &slot.commandBuffer,
+            .commandBufferCount = 1,
+        };
+        slot.timelineValue = timelineSubmit(upload.timeline, submit);
+        upload.inFlight.push_back({
+            .lastTicket = upload.recordedTicket,
+            .timelineValue = slot.timelineValue,
+            .bytes = slot.bytes,
+        });
+        upload.statsSubmissions++;
+        if (upload.timeline != &state->graphicsTimeline) {
+            frameWaitFor(state, upload.timeline, slot.timelineValue, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+        }
+
+        // الانتقال إلى الفتحة التالية؛ الانتظار هنا يحدث فقط إذا تجاوز معدل الرفع سعة الحلقة
+        upload.slotIndex = (upload.slotIndex + 1) % FRAMES_IN_FLIGHT;
+        UploadSlot &next = upload.slots[upload.slotIndex];
+        timelineWait(state, upload.timeline, next.timelineValue);
+        EXPECT(vkResetCommandPool(state->device, next.commandPool, 0) != VK_SUCCESS,
+               "Failed to reset upload command pool");
+        next.head = 0;
+        next.bytes = 0;
+    }
+
+    while (!upload.pending.empty()) {
+        UploadRequest &request = upload.pending.front();
+        const uint8_t *src = request.owned.data() + (request.consumed - request.ownedOffset);
+        if (!recordRequest(state, request, src)) {
+            break;
+        }
+        upload.pending.pop_front();
+    }
+    retireUploads(state);
+}
+
+bool uploadComplete(State *state, UploadTicket ticket) {
+    if (ticket <= state->upload.completedTicket) {
+        return true;
+    }
+    retireUploads(state);
+    return ticket <= state->upload.completedTicket;
+}
+
+void uploadWait(State *state, UploadTicket ticket) {
+    UploadManager &upload = state->upload;
+    while (!uploadComplete(state, ticket)) {
+        if (upload.inFlight.empty() || upload.inFlight.back().lastTicket < ticket) {
+            uploadFlush(state);
+            continue;
+        }
+        for (const UploadInFlight &submission : upload.inFlight) {
+            if (submission.lastTicket >= ticket) {
+                timelineWait(state, upload.timeline, submission.timelineValue);
+                break;
+            }
+        }
+    }
+}
+
+void uploadBenchmarkFrame(State *state) {
+    UploadManager &upload = state->upload;
+    constexpr VkDeviceSize chunkSize = 8ull << 20;
+    constexpr VkDeviceSize targetSize = 256ull << 20;
+    if (upload.benchmarkTarget.buffer == VK_NULL_HANDLE) {
+        upload.benchmarkTarget = createBuffer(state, targetSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        upload.benchmarkData.resize(chunkSize);
+        for (size_t i = 0; i < upload.benchmarkData.size(); i++) {
+            upload.benchmarkData[i] = (uint8_t) (i * 2654435761u >> 24);
+        }
+    }
+    // إبقاء الطابور ممتلئاً بما يكفي لإطارين كي نقيس المعدل المستمر لا زمن الاستجابة
+    VkDeviceSize queued = 0;
+    for (const UploadRequest &request : upload.pending) {
+        queued += request.size - request.consumed;
+    }
+    while (queued < upload.frameSize * 2) {
+        uploadBuffer(state, upload.benchmarkTarget.buffer, upload.benchmarkOffset, upload.benchmarkData.data(),
+                     chunkSize);
+        upload.benchmarkOffset = (upload.benchmarkOffset + chunkSize) % targetSize;
+        queued += chunkSize;
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include "GLFW/glfw3.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "buffer.h"
+#include "frame.h"
+
+struct State;
+struct TimelineQueue;
+
+// حجم الحلقة لكل إطار؛ الرفع الأكبر يُقسَّم على عدة إطارات
+constexpr VkDeviceSize UPLOAD_RING_FRAME_SIZE = 32ull << 20;
+constexpr VkDeviceSize UPLOAD_COPY_ALIGNMENT = 16;
+
+typedef uint64_t UploadTicket;
+
+// صورة كاملة بكل مستويات الـ mip مرصوصة بالتتابع في البيانات المصدر
+struct ImageUploadDesc {
+    VkImage image = VK_NULL_HANDLE;
+    VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    uint32_t width = 0, height = 0;
+    uint32_t mipLevels = 1;
+    uint32_t bytesPerBlock = 4;
+    uint32_t blockWidth = 1, blockHeight = 1;     // 4x4 للصيغ المضغوطة BC
+    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+};
+
+VkDeviceSize imageUploadSize(const ImageUploadDesc &desc);
+
+struct UploadRequest {
+    UploadTicket ticket = 0;
+    bool isImage = false;
+    VkBuffer dstBuffer = VK_NULL_HANDLE;
+    VkDeviceSize dstOffset = 0;
+    ImageUploadDesc image;
+    VkDeviceSize size = 0;
+    VkDeviceSize consumed = 0;          // البايتات التي نُسخت إلى الحلقة حتى الآن
+    std::vector<uint8_t> owned;         // بقية البيانات عندما لا يتسع لها الإطار الحالي
+    VkDeviceSize ownedOffset = 0;
+};
+
+struct UploadSlot {
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkDeviceSize head = 0;
+    bool recording = false;
+    UploadTicket lastTicket = 0;        // آخر طلب اكتمل نسخه في هذه الفتحة
+    uint64_t timelineValue = 0;
+    VkDeviceSize bytes = 0;
+};
+
+struct UploadInFlight {
+    UploadTicket lastTicket;
+    uint64_t timelineValue;
+    VkDeviceSize bytes;
+};
+
+struct UploadManager {
+    TimelineQueue *timeline = nullptr;  // طابور النقل إن وُجد، وإلا طابور الرسم
+    Buffer staging;                     // FRAMES_IN_FLIGHT * frameSize ومُعيَّن بشكل دائم
+    VkDeviceSize frameSize = 0;
+    UploadSlot slots[FRAMES_IN_FLIGHT];
+    uint32_t slotIndex = 0;
+
+    std::deque<UploadRequest> pending;
+    std::deque<UploadInFlight> inFlight;
+    UploadTicket nextTicket = 1;
+    UploadTicket recordedTicket = 0;
+    UploadTicket completedTicket = 0;
+
+    std::chrono::steady_clock::time_point statsStart;
+    VkDeviceSize statsBytes = 0;
+    uint32_t statsSubmissions = 0;
+    double throughputMBps = 0.0;
+
+    // --bench upload
+    Buffer benchmarkTarget;
+    std::vector<uint8_t> benchmarkData;
+    VkDeviceSize benchmarkOffset = 0;
+};
+
+void createUploadManager(State *state);
+void destroyUploadManager(State *state);
+
+UploadTicket uploadBuffer(State *state, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data,
+                          VkDeviceSize size);
+UploadTicket uploadImage(State *state, const ImageUploadDesc &desc, const void *data);
+
+// يُستدعى مرة في كل إطار قبل endFrame: يرسل كل ما جُمع في إرسال واحد
+void uploadFlush(State *state);
+bool uploadComplete(State *state, UploadTicket ticket);
+void uploadWait(State *state, UploadTicket ticket);
+
+void uploadBenchmarkFrame(State *state);
@@ -0,0 +1,212 @@
+#include "bc_encode.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// المحور الرئيسي لتوزيع الألوان بطريقة power iteration على مصفوفة التغاير
+static void principalAxis(const uint8_t pixels[64], int channels, float mean[4], float axis[4]) {
+    for (int c = 0; c < 4; c++) {
+        mean[c] = 0.0f;
+        axis[c] = 0.0f;
+    }
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < channels; c++) {
+            mean[c] += pixels[i * 4 + c] / 16.0f;
+        }
+    }
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++) {
+        float d[4];
+        for (int c = 0; c < channels; c++) {
+            d[c] = pixels[i * 4 + c] - mean[c];
+        }
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                covariance[a][b] += d[a] * d[b];
+            }
+        }
+    }
+    float v[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                next[a] += covariance[a][b] * v[b];
+            }
+        }
+        float length = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            length = std::max(length, std::fabs(next[c]));
+        }
+        if (length < 1e-6f) {
+            return;     // كتلة بلون واحد: المحور صفري
+        }
+        for (int c = 0; c < channels; c++) {
+            v[c] = next[c] / length;
+        }
+    }
+    for (int c = 0; c < channels; c++) {
+        axis[c] = v[c];
+    }
+}
+
+// النهايتان: إسقاط البكسلات على المحور وأخذ الطرفين
+static void endpoints(const uint8_t pixels[64], int channels, float low[4], float high[4]) {
+    float mean[4], axis[4];
+    principalAxis(pixels, channels, mean, axis);
+    float minT = 0.0f, maxT = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            t += (pixels[i * 4 + c] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    for (int c = 0; c < 4; c++) {
+        low[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        high[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+}
+
+static uint16_t packRgb565(const float color[4]) {
+    uint16_t r = (uint16_t) std::lround(color[0] * 31.0f / 255.0f);
+    uint16_t g = (uint16_t) std::lround(color[1] * 63.0f / 255.0f);
+    uint16_t b = (uint16_t) std::lround(color[2] * 31.0f / 255.0f);
+    return (uint16_t) (r << 11 | g << 5 | b);
+}
+
+static void unpackRgb565(uint16_t packed, int color[3]) {
+    int r = packed >> 11 & 31, g = packed >> 5 & 63, b = packed & 31;
+    color[0] = r << 3 | r >> 2;
+    color[1] = g << 2 | g >> 4;
+    color[2] = b << 3 | b >> 2;
+}
+
+void encodeBC1(const uint8_t pixels[64], uint8_t block[8]) {
+    float low[4], high[4];
+    endpoints(pixels, 3, low, high);
+    uint16_t color0 = packRgb565(high);
+    uint16_t color1 = packRgb565(low);
+    // نمط الألوان الأربعة يتطلب color0 > color1
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        unpackRgb565(color0, palette[0]);
+        unpackRgb565(color1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestError = INT32_MAX;
+            for (int p = 0; p < 4; p++) {
+                int error = 0;
+                for (int c = 0; c < 3; c++) {
+                    int d = pixels[i * 4 + c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint32_t) best << (i * 2);
+        }
+    }
+    memcpy(block, &color0, 2);
+    memcpy(block + 2, &color1, 2);
+    memcpy(block + 4, &indices, 4);
+}
+
+static const int BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BitWriter {
+    uint8_t *data;
+    uint32_t position = 0;
+
+    void write(uint32_t value, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++, position++) {
+            data[position >> 3] |= (uint8_t) ((value >> i & 1) << (position & 7));
+        }
+    }
+};
+
+// النهاية 7 بت لكل قناة مع p-bit مشترك: نختار p الذي يقلل الخطأ للنهاية كلها
+static void quantizeMode6(const float color[4], uint8_t quantized[4], uint32_t *pBit) {
+    float bestError = INFINITY;
+    for (uint32_t p = 0; p < 2; p++) {
+        float error = 0.0f;
+        uint8_t candidate[4];
+        for (int c = 0; c < 4; c++) {
+            int q = std::clamp((int) std::lround((color[c] - p) / 2.0f), 0, 127);
+            candidate[c] = (uint8_t) q;
+            float d = (float) (q << 1 | p) - color[c];
+            error += d * d;
+        }
+        if (error < bestError) {
+            bestError = error;
+            *pBit = p;
+            memcpy(quantized, candidate, 4);
+        }
+    }
+}
+
+void encodeBC7(const uint8_t pixels[64], uint8_t block[16]) {
+    float low[4], high[4];
+    endpoints(pixels, 4, low, high);
+    uint8_t q[2][4];
+    uint32_t p[2];
+    quantizeMode6(low, q[0], &p[0]);
+    quantizeMode6(high, q[1], &p[1]);
+
+    int palette[16][4];
+    for (int c = 0; c < 4; c++) {
+        int e0 = q[0][c] << 1 | p[0], e1 = q[1][c] << 1 | p[1];
+        for (int i = 0; i < 16; i++) {
+            palette[i][c] = ((64 - BC7_WEIGHTS4[i]) * e0 + BC7_WEIGHTS4[i] * e1 + 32) >> 6;
+        }
+    }
+    uint8_t indices[16];
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestError = INT32_MAX;
+        for (int w = 0; w < 16; w++) {
+            int error = 0;
+            for (int c = 0; c < 4; c++) {
+                int d = pixels[i * 4 + c] - palette[w][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = w;
+            }
+        }
+        indices[i] = (uint8_t) best;
+    }
+    // فهرس البكسل الأول يُخزَّن بـ 3 بتات فقط، فإذا تجاوز 7 نعكس النهايتين والفهارس
+    if (indices[0] > 7) {
+        std::swap(q[0], q[1]);
+        std::swap(p[0], p[1]);
+        for (uint8_t &index : indices) {
+            index = (uint8_t) (15 - index);
+        }
+    }
+
+    memset(block, 0, 16);
+    BitWriter writer{block};
+    writer.write(1u << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        writer.write(q[0][c], 7);
+        writer.write(q[1][c], 7);
+    }
+    writer.write(p[0], 1);
+    writer.write(p[1], 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; i++) {
+        writer.write(indices[i], 4);
+    }
+}
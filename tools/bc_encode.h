@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+// ضغط كتلة 4x4 من بكسلات RGBA8 (64 بايت، صفاً بصف)
+void encodeBC1(const uint8_t pixels[64], uint8_t block[8]);
+// BC7 بالنمط 6 فقط: مجموعة واحدة بنهايتين RGBA وفهارس 4 بت، كافٍ لمعظم الصور وسريع
+void encodeBC7(const uint8_t pixels[64], uint8_t block[16]);
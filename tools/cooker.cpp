@@ -0,0 +1,625 @@
+// cooker [--bc1 | --bc7] [--linear] [--no-mips] [--cache <dir>] <input-dir> <output-dir>
+// يحوّل الصور (.ppm, .tga) إلى .tex والمجسمات (.obj) إلى .mesh بصيغ cooked.h، وينسخ بقية الملفات كما هي.
+// الناتج يُحزم بعدها بأداة packer
+#include "../src/cooked.h"
+#include "bc_encode.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+enum class Compression {
+    None,
+    BC1,
+    BC7,
+};
+
+struct CookOptions {
+    Compression compression = Compression::None;
+    bool linear = false;
+    bool mips = true;
+    fs::path cache;
+};
+
+struct Image {
+    uint32_t width = 0, height = 0;
+    std::vector<uint8_t> pixels;    // RGBA8
+};
+
+static bool readFile(const fs::path &path, std::vector<uint8_t> *data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    data->resize((size_t) file.tellg());
+    file.seekg(0);
+    return (bool) file.read(reinterpret_cast<char *>(data->data()), (std::streamsize) data->size());
+}
+
+// تُستدعى من خيوط العمل، فالأخطاء قيمة معادة لا استثناءات تنهي البرنامج
+static bool writeFile(const fs::path &path, const std::vector<uint8_t> &data) {
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    if (error) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(data.data()), (std::streamsize) data.size());
+    return (bool) file;
+}
+
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// ---------------------------------------------------------------- الصور
+
+static bool decodePpm(const std::vector<uint8_t> &bytes, Image *image) {
+    size_t position = 2;
+    auto token = [&](uint32_t *value) {
+        while (position < bytes.size() && (isspace(bytes[position]) || bytes[position] == '#')) {
+            if (bytes[position] == '#') {
+                while (position < bytes.size() && bytes[position] != '\n') {
+                    position++;
+                }
+            } else {
+                position++;
+            }
+        }
+        if (position >= bytes.size() || !isdigit(bytes[position])) {
+            return false;
+        }
+        *value = 0;
+        while (position < bytes.size() && isdigit(bytes[position]) && *value < 65536) {
+            *value = *value * 10 + (bytes[position++] - '0');
+        }
+        return true;
+    };
+    uint32_t maxValue;
+    if (bytes.size() < 2 || bytes[0] != 'P' || bytes[1] != '6' || !token(&image->width) ||
+        !token(&image->height) || !token(&maxValue) || maxValue != 255 || image->width == 0 || image->height == 0) {
+        return false;
+    }
+    position++;
+    size_t pixelCount = (size_t) image->width * image->height;
+    if (bytes.size() < position + pixelCount * 3) {
+        return false;
+    }
+    image->pixels.resize(pixelCount * 4);
+    for (size_t i = 0; i < pixelCount; i++) {
+        memcpy(&image->pixels[i * 4], &bytes[position + i * 3], 3);
+        image->pixels[i * 4 + 3] = 255;
+    }
+    return true;
+}
+
+// TGA بألوان حقيقية 24 أو 32 بت، غير مضغوطة (2) أو RLE (10)
+static bool decodeTga(const std::vector<uint8_t> &bytes, Image *image) {
+    if (bytes.size() < 18) {
+        return false;
+    }
+    uint8_t idLength = bytes[0], colorMapType = bytes[1], type = bytes[2];
+    uint32_t width = bytes[12] | bytes[13] << 8, height = bytes[14] | bytes[15] << 8;
+    uint32_t bytesPerPixel = bytes[16] / 8;
+    bool topLeft = bytes[17] & 0x20;
+    if (colorMapType != 0 || (type != 2 && type != 10) || (bytesPerPixel != 3 && bytesPerPixel != 4) ||
+        width == 0 || height == 0) {
+        return false;
+    }
+
+    image->width = width;
+    image->height = height;
+    image->pixels.resize((size_t) width * height * 4);
+    size_t position = 18 + idLength;
+    size_t pixelCount = (size_t) width * height;
+    auto store = [&](size_t index, const uint8_t *bgra) {
+        size_t x = index % width, y = index / width;
+        uint8_t *dst = &image->pixels[((topLeft ? y : height - 1 - y) * width + x) * 4];
+        dst[0] = bgra[2];
+        dst[1] = bgra[1];
+        dst[2] = bgra[0];
+        dst[3] = bytesPerPixel == 4 ? bgra[3] : 255;
+    };
+    for (size_t index = 0; index < pixelCount;) {
+        uint32_t run = 1;
+        bool repeat = false;
+        if (type == 10) {
+            if (position >= bytes.size()) {
+                return false;
+            }
+            uint8_t packet = bytes[position++];
+            run = (packet & 0x7f) + 1u;
+            repeat = packet & 0x80;
+        }
+        for (uint32_t i = 0; i < run && index < pixelCount; i++, index++) {
+            if (position + bytesPerPixel > bytes.size()) {
+                return false;
+            }
+            store(index, &bytes[position]);
+            if (!repeat) {
+                position += bytesPerPixel;
+            }
+        }
+        if (repeat) {
+            position += bytesPerPixel;
+        }
+    }
+    return true;
+}
+
+static float srgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linearToSrgb(float value) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// صندوق 2x2؛ قنوات الألوان تُمزج في الفضاء الخطي للصور sRGB حتى لا تُعتم المستويات الصغيرة
+static Image downsample(const Image &source, bool linear) {
+    static float toLinear[256];
+    static bool tableReady = [] {
+        for (int i = 0; i < 256; i++) {
+            toLinear[i] = srgbToLinear(i / 255.0f);
+        }
+        return true;
+    }();
+    (void) tableReady;
+
+    Image result;
+    result.width = std::max(1u, source.width / 2);
+    result.height = std::max(1u, source.height / 2);
+    result.pixels.resize((size_t) result.width * result.height * 4);
+    for (uint32_t y = 0; y < result.height; y++) {
+        for (uint32_t x = 0; x < result.width; x++) {
+            uint32_t x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+            uint32_t y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+            const uint8_t *taps[4] = {
+                &source.pixels[((size_t) y0 * source.width + x0) * 4],
+                &source.pixels[((size_t) y0 * source.width + x1) * 4],
+                &source.pixels[((size_t) y1 * source.width + x0) * 4],
+                &source.pixels[((size_t) y1 * source.width + x1) * 4],
+            };
+            uint8_t *dst = &result.pixels[((size_t) y * result.width + x) * 4];
+            for (int c = 0; c < 4; c++) {
+                float sum = 0.0f;
+                for (const uint8_t *tap : taps) {
+                    sum += linear || c == 3 ? tap[c] / 255.0f : toLinear[tap[c]];
+                }
+                float value = sum / 4.0f;
+                value = linear || c == 3 ? value : linearToSrgb(value);
+                dst[c] = (uint8_t) std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+            }
+        }
+    }
+    return result;
+}
+
+// الكتل عند الحواف تُكمل بتكرار آخر صف وعمود
+static void compressLevel(const Image &image, Compression compression, std::vector<uint8_t> *output) {
+    uint32_t blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+    size_t blockBytes = compression == Compression::BC1 ? 8 : 16;
+    size_t start = output->size();
+    output->resize(start + (size_t) blocksX * blocksY * blockBytes);
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            uint8_t pixels[64];
+            for (uint32_t i = 0; i < 16; i++) {
+                uint32_t x = std::min(bx * 4 + i % 4, image.width - 1);
+                uint32_t y = std::min(by * 4 + i / 4, image.height - 1);
+                memcpy(&pixels[i * 4], &image.pixels[((size_t) y * image.width + x) * 4], 4);
+            }
+            uint8_t *block = &(*output)[start + ((size_t) by * blocksX + bx) * blockBytes];
+            if (compression == Compression::BC1) {
+                encodeBC1(pixels, block);
+            } else {
+                encodeBC7(pixels, block);
+            }
+        }
+    }
+}
+
+static bool cookTexture(const fs::path &path, const std::vector<uint8_t> &bytes, const CookOptions &options,
+                        std::vector<uint8_t> *output) {
+    Image image;
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    bool decoded = extension == ".tga" ? decodeTga(bytes, &image) : decodePpm(bytes, &image);
+    if (!decoded) {
+        return false;
+    }
+
+    CookedTextureHeader header{};
+    memcpy(header.magic, COOKED_TEXTURE_MAGIC, sizeof(header.magic));
+    header.version = COOKED_VERSION;
+    header.width = image.width;
+    header.height = image.height;
+    header.mipLevels = options.mips ? 1 + (uint32_t) std::log2(std::max(image.width, image.height)) : 1;
+    switch (options.compression) {
+        case Compression::None:
+            header.format = options.linear ? CookedFormat::RGBA8Unorm : CookedFormat::RGBA8Srgb;
+            header.bytesPerBlock = 4;
+            header.blockSize = 1;
+            break;
+        case Compression::BC1:
+            header.format = options.linear ? CookedFormat::BC1Unorm : CookedFormat::BC1Srgb;
+            header.bytesPerBlock = 8;
+            header.blockSize = 4;
+            break;
+        case Compression::BC7:
+            header.format = options.linear ? CookedFormat::BC7Unorm : CookedFormat::BC7Srgb;
+            header.bytesPerBlock = 16;
+            header.blockSize = 4;
+            break;
+    }
+
+    output->assign(sizeof(header), 0);
+    for (uint32_t mip = 0; mip < header.mipLevels; mip++) {
+        if (mip > 0) {
+            image = downsample(image, options.linear);
+        }
+        if (options.compression == Compression::None) {
+            output->insert(output->end(), image.pixels.begin(), image.pixels.end());
+        } else {
+            compressLevel(image, options.compression, output);
+        }
+    }
+    header.dataSize = output->size() - sizeof(header);
+    memcpy(output->data(), &header, sizeof(header));
+    return true;
+}
+
+// ---------------------------------------------------------------- المجسمات
+
+static uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    uint32_t sign = bits >> 16 & 0x8000;
+    int32_t exponent = (int32_t) (bits >> 23 & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (exponent <= 0) {
+        return (uint16_t) sign;     // القيم الأصغر من أصغر half طبيعي تصبح صفراً
+    }
+    if (exponent >= 31) {
+        return (uint16_t) (sign | 0x7c00);
+    }
+    // تقريب لأقرب قيمة
+    uint32_t half = sign | (uint32_t) exponent << 10 | mantissa >> 13;
+    return (uint16_t) (half + (mantissa >> 12 & 1));
+}
+
+struct ObjIndex {
+    int position, uv, normal;
+
+    bool operator==(const ObjIndex &other) const {
+        return position == other.position && uv == other.uv && normal == other.normal;
+    }
+};
+
+struct ObjIndexHash {
+    size_t operator()(const ObjIndex &index) const {
+        return hashBytes(14695981039346656037ull, &index, sizeof(index));
+    }
+};
+
+static bool cookMesh(const std::vector<uint8_t> &bytes, std::vector<uint8_t> *output) {
+    std::vector<float> positions, uvs, normals;
+    std::vector<ObjIndex> corners;
+    std::istringstream stream(std::string(bytes.begin(), bytes.end()));
+    std::string text;
+    while (std::getline(stream, text)) {
+        const char *line = text.c_str();
+        float x = 0, y = 0, z = 0;
+        if (strncmp(line, "v ", 2) == 0 && sscanf(line + 2, "%f %f %f", &x, &y, &z) == 3) {
+            positions.insert(positions.end(), {x, y, z});
+        } else if (strncmp(line, "vt ", 3) == 0 && sscanf(line + 3, "%f %f", &x, &y) == 2) {
+            uvs.insert(uvs.end(), {x, y});
+        } else if (strncmp(line, "vn ", 3) == 0 && sscanf(line + 3, "%f %f %f", &x, &y, &z) == 3) {
+            normals.insert(normals.end(), {x, y, z});
+        } else if (strncmp(line, "f ", 2) == 0) {
+            // الوجوه تُقسَّم إلى مثلثات على شكل مروحة
+            std::vector<ObjIndex> face;
+            const char *cursor = line + 2;
+            while (*cursor) {
+                while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') {
+                    cursor++;
+                }
+                if (!*cursor) {
+                    break;
+                }
+                ObjIndex index{0, 0, 0};
+                int *fields[3] = {&index.position, &index.uv, &index.normal};
+                for (int field = 0; field < 3 && *cursor && *cursor != ' '; field++) {
+                    char *end;
+                    long value = strtol(cursor, &end, 10);
+                    *fields[field] = (int) value;
+                    cursor = end;
+                    if (*cursor != '/') {
+                        break;
+                    }
+                    cursor++;
+                }
+                while (*cursor && *cursor != ' ' && *cursor != '\t') {
+                    cursor++;
+                }
+                // الفهارس السالبة نسبية إلى آخر عنصر
+                int counts[3] = {(int) positions.size() / 3, (int) uvs.size() / 2, (int) normals.size() / 3};
+                for (int field = 0; field < 3; field++) {
+                    int &value = *fields[field];
+                    value = value < 0 ? counts[field] + value : value - 1;
+                    if (value >= counts[field]) {
+                        return false;
+                    }
+                }
+                if (index.position < 0) {
+                    return false;
+                }
+                face.push_back(index);
+            }
+            for (size_t i = 2; i < face.size(); i++) {
+                corners.insert(corners.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+    }
+    if (corners.empty()) {
+        return false;
+    }
+
+    std::unordered_map<ObjIndex, uint32_t, ObjIndexHash> unique;
+    std::vector<ObjIndex> vertices;
+    std::vector<uint32_t> indices;
+    indices.reserve(corners.size());
+    for (const ObjIndex &corner : corners) {
+        auto [it, inserted] = unique.emplace(corner, (uint32_t) vertices.size());
+        if (inserted) {
+            vertices.push_back(corner);
+        }
+        indices.push_back(it->second);
+    }
+
+    // العموديات المفقودة تُحسب من متوسط عموديات الوجوه المجاورة
+    std::vector<float> vertexNormals(vertices.size() * 3, 0.0f);
+    auto position = [&](uint32_t vertex, int axis) {
+        return positions[vertices[vertex].position * 3 + axis];
+    };
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        float e1[3], e2[3];
+        for (int axis = 0; axis < 3; axis++) {
+            e1[axis] = position(indices[i + 1], axis) - position(indices[i], axis);
+            e2[axis] = position(indices[i + 2], axis) - position(indices[i], axis);
+        }
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        for (int corner = 0; corner < 3; corner++) {
+            for (int axis = 0; axis < 3; axis++) {
+                vertexNormals[indices[i + corner] * 3 + axis] += n[axis];
+            }
+        }
+    }
+
+    CookedMeshHeader header{};
+    memcpy(header.magic, COOKED_MESH_MAGIC, sizeof(header.magic));
+    header.version = COOKED_VERSION;
+    header.vertexCount = (uint32_t) vertices.size();
+    header.indexCount = (uint32_t) indices.size();
+    header.indexSize = vertices.size() <= UINT16_MAX ? 2 : 4;
+    float minimum[3] = {INFINITY, INFINITY, INFINITY}, maximum[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (uint32_t v = 0; v < header.vertexCount; v++) {
+        for (int axis = 0; axis < 3; axis++) {
+            minimum[axis] = std::min(minimum[axis], position(v, axis));
+            maximum[axis] = std::max(maximum[axis], position(v, axis));
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        header.positionOffset[axis] = minimum[axis];
+        header.positionScale[axis] = (maximum[axis] - minimum[axis]) / 65535.0f;
+        header.boundsCenter[axis] = (minimum[axis] + maximum[axis]) * 0.5f;
+    }
+    for (uint32_t v = 0; v < header.vertexCount; v++) {
+        float distance = 0.0f;
+        for (int axis = 0; axis < 3; axis++) {
+            float d = position(v, axis) - header.boundsCenter[axis];
+            distance += d * d;
+        }
+        header.boundsRadius = std::max(header.boundsRadius, std::sqrt(distance));
+    }
+
+    output->assign(sizeof(header), 0);
+    memcpy(output->data(), &header, sizeof(header));
+    for (uint32_t v = 0; v < header.vertexCount; v++) {
+        const ObjIndex &source = vertices[v];
+        CookedVertex vertex{};
+        float n[3];
+        for (int axis = 0; axis < 3; axis++) {
+            float scale = header.positionScale[axis];
+            float unorm = scale > 0.0f ? (position(v, axis) - header.positionOffset[axis]) / scale : 0.0f;
+            vertex.position[axis] = (uint16_t) std::lround(std::clamp(unorm, 0.0f, 65535.0f));
+            n[axis] = source.normal >= 0 ? normals[source.normal * 3 + axis] : vertexNormals[v * 3 + axis];
+        }
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int axis = 0; axis < 3; axis++) {
+            vertex.normal[axis] = (int8_t) std::lround(length > 0.0f ? n[axis] / length * 127.0f : 0.0f);
+        }
+        // OBJ يضع أصل الـ UV في الأسفل و Vulkan في الأعلى
+        if (source.uv >= 0) {
+            vertex.uv[0] = floatToHalf(uvs[source.uv * 2]);
+            vertex.uv[1] = floatToHalf(1.0f - uvs[source.uv * 2 + 1]);
+        }
+        const uint8_t *raw = reinterpret_cast<const uint8_t *>(&vertex);
+        output->insert(output->end(), raw, raw + sizeof(vertex));
+    }
+    for (uint32_t index : indices) {
+        const uint8_t *raw = reinterpret_cast<const uint8_t *>(&index);
+        output->insert(output->end(), raw, raw + header.indexSize);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- الطبخ
+
+enum class CookKind {
+    Copy,
+    Texture,
+    Mesh,
+};
+
+static CookKind cookKind(const fs::path &path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".ppm" || extension == ".tga") {
+        return CookKind::Texture;
+    }
+    return extension == ".obj" ? CookKind::Mesh : CookKind::Copy;
+}
+
+int main(int argc, char **argv) {
+    CookOptions options;
+    std::vector<const char *> positional;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bc1") == 0) {
+            options.compression = Compression::BC1;
+        } else if (strcmp(argv[i], "--bc7") == 0) {
+            options.compression = Compression::BC7;
+        } else if (strcmp(argv[i], "--linear") == 0) {
+            options.linear = true;
+        } else if (strcmp(argv[i], "--no-mips") == 0) {
+            options.mips = false;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            options.cache = argv[++i];
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+    if (positional.size() != 2) {
+        std::cerr << "Usage: cooker [--bc1 | --bc7] [--linear] [--no-mips] [--cache <dir>] <input-dir> <output-dir>"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    fs::path inputRoot = positional[0], outputRoot = positional[1];
+    if (!fs::is_directory(inputRoot)) {
+        std::cerr << "Input directory " << inputRoot << " not found" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!options.cache.empty()) {
+        fs::create_directories(options.cache);
+    }
+
+    std::vector<fs::path> inputs;
+    for (const auto &item : fs::recursive_directory_iterator(inputRoot)) {
+        if (item.is_regular_file()) {
+            inputs.push_back(item.path());
+        }
+    }
+
+    // مفتاح الـ cache يشمل المحتوى والخيارات وإصدار الصيغة، فأي تغيير في أحدها يعيد الطبخ
+    char optionKey[64];
+    snprintf(optionKey, sizeof(optionKey), "v%u c%d l%d m%d", COOKED_VERSION, (int) options.compression,
+             options.linear, options.mips);
+
+    std::atomic<size_t> next{0};
+    std::atomic<uint32_t> cooked{0}, cacheHits{0}, copied{0}, failures{0};
+    std::mutex logMutex;
+    auto fail = [&](const char *action, const fs::path &path) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cerr << "Failed to " << action << " " << path << std::endl;
+        failures++;
+    };
+    auto worker = [&] {
+        for (size_t i = next++; i < inputs.size(); i = next++) {
+            const fs::path &input = inputs[i];
+            CookKind kind = cookKind(input);
+            fs::path output = outputRoot / input.lexically_relative(inputRoot);
+            if (kind != CookKind::Copy) {
+                output.replace_extension(kind == CookKind::Texture ? ".tex" : ".mesh");
+            }
+            std::vector<uint8_t> bytes;
+            if (!readFile(input, &bytes)) {
+                fail("read", input);
+                continue;
+            }
+            if (kind == CookKind::Copy) {
+                if (!writeFile(output, bytes)) {
+                    fail("write", output);
+                    continue;
+                }
+                copied++;
+                continue;
+            }
+
+            uint64_t hash = hashBytes(14695981039346656037ull, bytes.data(), bytes.size());
+            hash = hashBytes(hash, optionKey, strlen(optionKey));
+            hash = hashBytes(hash, &kind, sizeof(kind));
+            char hashName[17];
+            snprintf(hashName, sizeof(hashName), "%016llx", (unsigned long long) hash);
+            fs::path cachePath = options.cache.empty() ? fs::path() : options.cache / hashName;
+
+            std::vector<uint8_t> result;
+            if (!cachePath.empty() && readFile(cachePath, &result)) {
+                if (!writeFile(output, result)) {
+                    fail("write", output);
+                    continue;
+                }
+                cacheHits++;
+                continue;
+            }
+            bool success = kind == CookKind::Texture ? cookTexture(input, bytes, options, &result)
+                                                     : cookMesh(bytes, &result);
+            if (!success) {
+                fail("cook", input);
+                continue;
+            }
+            if (!writeFile(output, result)) {
+                fail("write", output);
+                continue;
+            }
+            if (!cachePath.empty()) {
+                // كتابة ذرية: ملف مؤقت ثم إعادة تسمية، حتى لا يُقرأ ملف ناقص في تشغيل لاحق
+                fs::path temporary = cachePath;
+                temporary += "." + std::to_string(i) + ".tmp";
+                std::error_code error;
+                bool written = writeFile(temporary, result);
+                if (written) {
+                    fs::rename(temporary, cachePath, error);
+                }
+                if (!written || error) {
+                    fs::remove(temporary, error);
+                    fail("cache", cachePath);
+                    continue;
+                }
+            }
+            cooked++;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Cooked %u, cache hits %u, copied %u, failed %u in %.2f ms\n", cooked.load(), cacheHits.load(),
+           copied.load(), failures.load(), seconds * 1000.0);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
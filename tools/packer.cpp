@@ -0,0 +1,150 @@
+// packer <output.bka> <input-dir>
+// يجمع كل ملفات المجلد في أرشيف واحد بصيغة archive.h
+#include "../src/archive.h"
+#include "../src/lz4.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// المدخل يُخزَّن بدون ضغط (ويُقرأ zero-copy) إن لم يوفر الضغط هذه النسبة على الأقل
+constexpr double MIN_COMPRESSION_SAVING = 0.1;
+
+struct PackedFile {
+    std::string path;
+    ArchiveEntry entry{};
+    std::vector<uint8_t> data;          // البيانات الخام أو الكتل المضغوطة متتالية
+    std::vector<ArchiveBlock> blocks;   // offset نسبي داخل data
+};
+
+static bool readFile(const fs::path &path, std::vector<uint8_t> *data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    data->resize((size_t) file.tellg());
+    file.seekg(0);
+    return (bool) file.read(reinterpret_cast<char *>(data->data()), (std::streamsize) data->size());
+}
+
+static void packFile(PackedFile *file, std::vector<uint8_t> raw) {
+    file->entry.size = raw.size();
+    std::vector<uint8_t> compressed;
+    std::vector<ArchiveBlock> blocks;
+    std::vector<uint8_t> scratch(lz4CompressBound(ARCHIVE_BLOCK_SIZE));
+    for (size_t offset = 0; offset < raw.size(); offset += ARCHIVE_BLOCK_SIZE) {
+        uint32_t size = (uint32_t) std::min<size_t>(ARCHIVE_BLOCK_SIZE, raw.size() - offset);
+        // الكتلة التي لا تصغر تُخزَّن خاماً
+        size_t packed = lz4Compress(raw.data() + offset, size, scratch.data(), scratch.size());
+        packed = packed < size ? packed : 0;
+        const uint8_t *source = packed ? scratch.data() : raw.data() + offset;
+        uint32_t storedSize = packed ? (uint32_t) packed : size;
+        blocks.push_back({compressed.size(), storedSize, size});
+        compressed.insert(compressed.end(), source, source + storedSize);
+    }
+
+    if (!raw.empty() && (double) compressed.size() <= (double) raw.size() * (1.0 - MIN_COMPRESSION_SAVING)) {
+        file->entry.flags = ARCHIVE_ENTRY_COMPRESSED;
+        file->entry.blockCount = (uint32_t) blocks.size();
+        file->data = std::move(compressed);
+        file->blocks = std::move(blocks);
+    } else {
+        file->data = std::move(raw);
+    }
+}
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: packer <output> <input-dir>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    fs::path root = argv[2];
+    std::vector<PackedFile> files;
+    std::unordered_map<uint64_t, std::string> ids;
+    for (const auto &item : fs::recursive_directory_iterator(root)) {
+        if (!item.is_regular_file()) {
+            continue;
+        }
+        PackedFile file;
+        file.path = item.path().lexically_relative(root).generic_string();
+        file.entry.id = archiveHash(file.path.c_str());
+        auto [existing, inserted] = ids.emplace(file.entry.id, file.path);
+        if (!inserted) {
+            std::cerr << "Hash collision between " << existing->second << " and " << file.path << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::vector<uint8_t> raw;
+        if (!readFile(item.path(), &raw)) {
+            std::cerr << "Failed to read " << item.path() << std::endl;
+            return EXIT_FAILURE;
+        }
+        packFile(&file, std::move(raw));
+        files.push_back(std::move(file));
+    }
+    std::sort(files.begin(), files.end(), [](const PackedFile &a, const PackedFile &b) {
+        return a.entry.id < b.entry.id;
+    });
+
+    // حساب المواضع: الرأس ثم الجدولان ثم البيانات، وكل مدخل على محاذاة ARCHIVE_DATA_ALIGNMENT
+    ArchiveHeader header{};
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.entryCount = (uint32_t) files.size();
+    header.entriesOffset = sizeof(ArchiveHeader);
+    header.blocksOffset = header.entriesOffset + files.size() * sizeof(ArchiveEntry);
+    std::vector<ArchiveEntry> entries;
+    std::vector<ArchiveBlock> blocks;
+    for (PackedFile &file : files) {
+        header.blockCount += (uint32_t) file.blocks.size();
+    }
+    uint64_t offset = header.blocksOffset + (uint64_t) header.blockCount * sizeof(ArchiveBlock);
+    uint64_t rawSize = 0;
+    uint32_t compressedCount = 0;
+    for (PackedFile &file : files) {
+        offset = alignUp(offset, ARCHIVE_DATA_ALIGNMENT);
+        file.entry.offset = offset;
+        if (file.entry.flags & ARCHIVE_ENTRY_COMPRESSED) {
+            file.entry.firstBlock = (uint32_t) blocks.size();
+            for (ArchiveBlock block : file.blocks) {
+                block.offset += offset;
+                blocks.push_back(block);
+            }
+            compressedCount++;
+        }
+        entries.push_back(file.entry);
+        offset += file.data.size();
+        rawSize += file.entry.size;
+    }
+
+    std::ofstream output(argv[1], std::ios::binary);
+    if (!output) {
+        std::cerr << "Failed to create " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char *>(entries.data()), (std::streamsize) (entries.size() * sizeof(ArchiveEntry)));
+    output.write(reinterpret_cast<const char *>(blocks.data()), (std::streamsize) (blocks.size() * sizeof(ArchiveBlock)));
+    for (const PackedFile &file : files) {
+        static const char padding[ARCHIVE_DATA_ALIGNMENT] = {};
+        output.write(padding, (std::streamsize) (file.entry.offset - (uint64_t) output.tellp()));
+        output.write(reinterpret_cast<const char *>(file.data.data()), (std::streamsize) file.data.size());
+    }
+    if (!output) {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    printf("Packed %zu files (%u compressed, %u blocks): %.1f KB -> %.1f KB\n", files.size(), compressedCount,
+           header.blockCount, (double) rawSize / 1024.0, (double) offset / 1024.0);
+    return EXIT_SUCCESS;
+}